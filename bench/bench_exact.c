@@ -0,0 +1,146 @@
+/*
+ * Cost of tokenizing into an exact allocation. For each language, a sample is repeated to fill a buffer of
+ * about 16MB, which is lexed in four ways:
+ *
+ *     lex:    `lxl_lexer_next_token()` until the end, storing nothing.
+ *     count:  `lxl_lexer_count_tokens()`, the first pass of `lxl_lexer_tokenize_exact()`.
+ *     exact:  `lxl_lexer_tokenize_exact()` into a region.
+ *     grow:   `lxl_lexer_tokenize_columns()` into columns which are doubled with realloc() when full, then
+ *             copied into columns of exactly the right size allocated from the region.
+ *
+ * The region is touched before timing, so that neither way pays for faulting in its pages.
+ *
+ * Build with optimisations enabled, e.g. `gcc bench_exact.c -O2 -o bench_exact`.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define LEXEL_IMPLEMENTATION
+#include "../lexel.h"
+
+#define BUFFER_SIZE (16 << 20)
+#define REGION_SIZE ((size_t)256 << 20)
+
+struct sample {
+    enum lxl_language language;
+    const char *name;
+    const char *source;
+};
+
+static const struct sample samples[] = {
+    {
+        LXL_LANG_C, "C",
+        "static int parse_header(const struct buffer *buf, size_t *out_length) {\n"
+        "    if (buf->length < HEADER_SIZE) return -1;  // Too short.\n"
+        "    unsigned long value = 0x1Fu;\n"
+        "    for (size_t i = 0; i < buf->length && i != 42; ++i) {\n"
+        "        value = (value << 8) | (unsigned char)buf->data[i];\n"
+        "    }\n"
+        "    *out_length = value * 1.5e3f;\n"
+        "    printf(\"length: %lu\\n\", value);\n"
+        "    return 0;\n"
+        "}\n",
+    },
+    {
+        LXL_LANG_JSON, "JSON",
+        "{\"id\": 12345, \"name\": \"example item\", \"price\": 19.99, \"tags\": [\"a\", \"b\", \"c\"],\n"
+        " \"active\": true, \"parent\": null, \"ratio\": -2.5e-3, \"nested\": {\"x\": 1, \"y\": [1, 2, 3]}},\n",
+    },
+};
+
+#define SAMPLE_COUNT (sizeof samples / sizeof samples[0])
+
+static double seconds_since(clock_t start) {
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+// Lex the input into growing columns, then copy them into columns of the exact size from `region`. Return
+// the number of tokens, or 0 if memory ran out.
+static size_t grow_and_copy(struct lxl_lexer *lexer, struct lxl_region *region) {
+    struct lxl_token_columns grown = {0};
+    size_t count = 0;
+    for (;;) {
+        if (grown.count == grown.capacity) {
+            size_t capacity = (grown.capacity == 0) ? 1024 : 2 * grown.capacity;
+            const char **starts = realloc(grown.starts, capacity * sizeof *starts);
+            if (starts != NULL) grown.starts = starts;
+            const char **ends = realloc(grown.ends, capacity * sizeof *ends);
+            if (ends != NULL) grown.ends = ends;
+            int *token_types = realloc(grown.token_types, capacity * sizeof *token_types);
+            if (token_types != NULL) grown.token_types = token_types;
+            if (starts == NULL || ends == NULL || token_types == NULL) goto done;
+            grown.capacity = capacity;
+        }
+        if (lxl_lexer_tokenize_columns(lexer, &grown) == 0) break;
+    }
+    struct lxl_token_columns columns;
+    if (lxl_token_columns_init(&columns, grown.count, false, region)) {
+        memcpy(columns.starts, grown.starts, grown.count * sizeof *grown.starts);
+        memcpy(columns.ends, grown.ends, grown.count * sizeof *grown.ends);
+        memcpy(columns.token_types, grown.token_types, grown.count * sizeof *grown.token_types);
+        count = grown.count;
+    }
+done:
+    free(grown.starts);
+    free(grown.ends);
+    free(grown.token_types);
+    return count;
+}
+
+int main(void) {
+    char *buffer = malloc(BUFFER_SIZE);
+    char *region_data = malloc(REGION_SIZE);
+    if (buffer == NULL || region_data == NULL) return 1;
+    memset(region_data, 0, REGION_SIZE);
+    for (size_t i = 0; i < SAMPLE_COUNT; ++i) {
+        size_t sample_length = strlen(samples[i].source);
+        size_t size = 0;
+        while (size + sample_length <= BUFFER_SIZE) {
+            memcpy(buffer + size, samples[i].source, sample_length);
+            size += sample_length;
+        }
+        struct lxl_lexer config = lxl_lexer_preset(samples[i].language, buffer, buffer + size);
+
+        struct lxl_lexer lexer = config;
+        size_t token_count = 0;
+        clock_t start = clock();
+        for (;;) {
+            struct lxl_token token = lxl_lexer_next_token(&lexer);
+            if (LXL_TOKEN_IS_END(token)) break;
+            ++token_count;
+        }
+        double lex_seconds = seconds_since(start);
+
+        lexer = config;
+        start = clock();
+        size_t counted = lxl_lexer_count_tokens(&lexer, NULL, NULL);
+        double count_seconds = seconds_since(start);
+
+        lexer = config;
+        struct lxl_region region = {.capacity = REGION_SIZE, .alloc_count = 0, .data = region_data};
+        struct lxl_token_columns columns = {0};
+        start = clock();
+        lxl_lexer_tokenize_exact(&lexer, &columns, false, &region);
+        double exact_seconds = seconds_since(start);
+
+        lexer = config;
+        region.alloc_count = 0;
+        start = clock();
+        size_t grown = grow_and_copy(&lexer, &region);
+        double grow_seconds = seconds_since(start);
+
+        if (counted != token_count || columns.count != token_count || grown != token_count) {
+            printf("%-5s token counts differ: %zu, %zu, %zu and %zu\n", samples[i].name, token_count, counted,
+                   columns.count, grown);
+            return 1;
+        }
+        printf("%-5s lex %5.1f, count %5.1f, exact %5.1f, grow %5.1f ns per token (%zu tokens)\n",
+               samples[i].name, lex_seconds * 1e9 / token_count, count_seconds * 1e9 / token_count,
+               exact_seconds * 1e9 / token_count, grow_seconds * 1e9 / token_count, token_count);
+    }
+    free(region_data);
+    free(buffer);
+    return 0;
+}
@@ -0,0 +1,108 @@
+/*
+ * Throughput of the presets. For each language, a sample is repeated to fill a buffer of about 16MB, which
+ * is lexed with the preset and then with the same configuration without its rule index (as a lexer built by
+ * hand would be).
+ *
+ * Build with optimisations enabled, e.g. `gcc bench_presets.c -O2 -o bench_presets`.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define LEXEL_IMPLEMENTATION
+#include "../lexel.h"
+
+#define BUFFER_SIZE (16 << 20)
+
+struct sample {
+    enum lxl_language language;
+    const char *name;
+    const char *source;
+};
+
+static const struct sample samples[] = {
+    {
+        LXL_LANG_C, "C",
+        "static int parse_header(const struct buffer *buf, size_t *out_length) {\n"
+        "    if (buf->length < HEADER_SIZE) return -1;  // Too short.\n"
+        "    unsigned long value = 0x1Fu;\n"
+        "    for (size_t i = 0; i < buf->length && i != 42; ++i) {\n"
+        "        value = (value << 8) | (unsigned char)buf->data[i];\n"
+        "    }\n"
+        "    *out_length = value * 1.5e3f;\n"
+        "    printf(\"length: %lu\\n\", value);\n"
+        "    return 0;\n"
+        "}\n",
+    },
+    {
+        LXL_LANG_JSON, "JSON",
+        "{\"id\": 12345, \"name\": \"example item\", \"price\": 19.99, \"tags\": [\"a\", \"b\", \"c\"],\n"
+        " \"active\": true, \"parent\": null, \"ratio\": -2.5e-3, \"nested\": {\"x\": 1, \"y\": [1, 2, 3]}},\n",
+    },
+    {
+        LXL_LANG_SQL, "SQL",
+        "SELECT u.id, u.name, COUNT(o.id) AS order_count -- per user\n"
+        "FROM users u LEFT JOIN orders o ON o.user_id = u.id\n"
+        "WHERE u.created_at >= '2024-01-01' AND u.status <> 'deleted'\n"
+        "GROUP BY u.id, u.name HAVING COUNT(o.id) > 5 ORDER BY order_count DESC LIMIT 100;\n",
+    },
+    {
+        LXL_LANG_INI, "INI",
+        "[server]\n"
+        "host = \"example.com\"  # The public name.\n"
+        "port = 8_080\n"
+        "timeout = 2.5\n"
+        "enabled = true\n"
+        "allowed = [\"a\", \"b\"]\n",
+    },
+    {
+        LXL_LANG_SHELL, "Shell",
+        "for f in \"$@\"; do\n"
+        "    if [ -f \"$f\" ]; then grep -n 'pattern' \"$f\" 2>/dev/null | sort -u >> out.txt; fi\n"
+        "    case $f in *.c) echo \"C source\" ;; *) : ;; esac  # Classify.\n"
+        "done\n",
+    },
+};
+
+#define SAMPLE_COUNT (sizeof samples / sizeof samples[0])
+
+// Lex the whole input, returning the number of tokens and setting `OUT_seconds` to the time taken.
+static size_t time_lexing(struct lxl_lexer lexer, double *OUT_seconds) {
+    size_t count = 0;
+    clock_t start = clock();
+    for (;;) {
+        struct lxl_token token = lxl_lexer_next_token(&lexer);
+        if (LXL_TOKEN_IS_END(token)) break;
+        ++count;
+    }
+    *OUT_seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    return count;
+}
+
+int main(void) {
+    char *buffer = malloc(BUFFER_SIZE);
+    if (buffer == NULL) return 1;
+    for (size_t i = 0; i < SAMPLE_COUNT; ++i) {
+        size_t sample_length = strlen(samples[i].source);
+        size_t size = 0;
+        while (size + sample_length <= BUFFER_SIZE) {
+            memcpy(buffer + size, samples[i].source, sample_length);
+            size += sample_length;
+        }
+        struct lxl_lexer lexer = lxl_lexer_preset(samples[i].language, buffer, buffer + size);
+        struct lxl_lexer unindexed = lexer;
+        unindexed.rule_index = NULL;
+
+        double seconds = 0.0;
+        double unindexed_seconds = 0.0;
+        size_t token_count = time_lexing(lexer, &seconds);
+        time_lexing(unindexed, &unindexed_seconds);
+        double megabytes = (double)size / (1 << 20);
+        printf("%-6s %7.1f MB/s, %5.1f ns per token (without the rule index: %7.1f MB/s, %5.1f ns per token)\n",
+               samples[i].name, megabytes / seconds, seconds * 1e9 / token_count,
+               megabytes / unindexed_seconds, unindexed_seconds * 1e9 / token_count);
+    }
+    free(buffer);
+    return 0;
+}
@@ -0,0 +1,127 @@
+/*
+ * Latency of reusing a configured lexer for tiny inputs. Each input is lexed from a fresh lexer made in one
+ * of three ways:
+ *
+ *     new:     `lxl_lexer_new()` followed by assigning the configuration fields again.
+ *     config:  `lxl_lexer_from_config()` with a template lexer.
+ *     rebind:  `lxl_lexer_rebind()` on a single lexer.
+ *
+ * Each way is timed twice: setting up the lexer and lexing the input, then setting up the lexer alone
+ * (the lexer is passed through a volatile function pointer so the setup cannot be optimised away).
+ *
+ * Build with optimisations enabled, e.g. `gcc bench_rebind.c -O2 -o bench_rebind`.
+ */
+
+#include <stdio.h>
+#include <time.h>
+
+#define LEXEL_IMPLEMENTATION
+#include "../lexel.h"
+
+#define ITERATIONS 2000000
+
+enum token_type {
+    T_INT, T_FLOAT, T_STRING, T_WORD,
+    T_LPAREN, T_RPAREN, T_COMMA, T_SEMICOLON, T_ASSIGN, T_PLUS, T_MINUS,
+    T_IF, T_RETURN,
+};
+
+static const char *const line_comments[] = {"//", NULL};
+static const struct lxl_delim_pair strings[] = {{"\"", "\""}, {NULL, NULL}};
+static const int string_types[] = {T_STRING};
+static const char *const puncts[] = {"(", ")", ",", ";", "=", "+", "-", NULL};
+static const int punct_types[] = {T_LPAREN, T_RPAREN, T_COMMA, T_SEMICOLON, T_ASSIGN, T_PLUS, T_MINUS};
+static const char *const keywords[] = {"if", "return", NULL};
+static const int keyword_types[] = {T_IF, T_RETURN};
+
+static const char *const inputs[] = {
+    "x = 1;", "f(a, b)", "return 0;", "if (y) z = \"s\";", "// note", "a + b - 2.5", "", "count",
+};
+#define INPUT_COUNT (sizeof inputs / sizeof inputs[0])
+
+static void configure(struct lxl_lexer *lexer) {
+    lexer->line_comment_openers = line_comments;
+    lexer->line_string_delims = strings;
+    lexer->line_string_types = string_types;
+    lexer->string_escape_chars = "\\";
+    lexer->default_int_base = 10;
+    lexer->default_int_type = T_INT;
+    lexer->default_float_base = 10;
+    lexer->default_float_type = T_FLOAT;
+    lexer->puncts = puncts;
+    lexer->punct_types = punct_types;
+    lexer->keywords = keywords;
+    lexer->keyword_types = keyword_types;
+    lexer->default_word_type = T_WORD;
+    lexer->word_lexing_rule = LXL_LEX_WORD;
+}
+
+// Read a couple of fields of the lexer, for timing its setup alone.
+static size_t inspect(struct lxl_lexer *lexer) {
+    return (size_t)(lexer->end - lexer->current) + (size_t)lexer->default_word_type;
+}
+
+// Either `drain()` or `inspect()`.
+static size_t (*volatile consume)(struct lxl_lexer *lexer);
+
+static size_t drain(struct lxl_lexer *lexer) {
+    size_t count = 0;
+    for (;;) {
+        struct lxl_token token = lxl_lexer_next_token(lexer);
+        if (LXL_TOKEN_IS_END(token)) break;
+        ++count;
+    }
+    return count;
+}
+
+// Print the time per input since `start`. `total` is only printed so that the work is not optimised away.
+static void report(const char *name, clock_t start, size_t total) {
+    double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("    %-7s %6.1f ns per input (checksum %zu)\n", name, seconds * 1e9 / ITERATIONS, total);
+}
+
+int main(void) {
+    size_t lengths[INPUT_COUNT];
+    for (size_t i = 0; i < INPUT_COUNT; ++i) {
+        lengths[i] = strlen(inputs[i]);
+    }
+    struct lxl_lexer config = lxl_lexer_new("", NULL);
+    configure(&config);
+
+    static const char *const headings[] = {"Setup and lexing:", "Setup only:"};
+    size_t (*const consumers[])(struct lxl_lexer *) = {drain, inspect};
+    for (int pass = 0; pass < 2; ++pass) {
+        printf("%s\n", headings[pass]);
+        consume = consumers[pass];
+
+        size_t total = 0;
+        clock_t start = clock();
+        for (size_t i = 0; i < ITERATIONS; ++i) {
+            const char *input = inputs[i % INPUT_COUNT];
+            struct lxl_lexer lexer = lxl_lexer_new(input, input + lengths[i % INPUT_COUNT]);
+            configure(&lexer);
+            total += consume(&lexer);
+        }
+        report("new", start, total);
+
+        total = 0;
+        start = clock();
+        for (size_t i = 0; i < ITERATIONS; ++i) {
+            const char *input = inputs[i % INPUT_COUNT];
+            struct lxl_lexer lexer = lxl_lexer_from_config(&config, input, input + lengths[i % INPUT_COUNT]);
+            total += consume(&lexer);
+        }
+        report("config", start, total);
+
+        struct lxl_lexer lexer = config;
+        total = 0;
+        start = clock();
+        for (size_t i = 0; i < ITERATIONS; ++i) {
+            const char *input = inputs[i % INPUT_COUNT];
+            lxl_lexer_rebind(&lexer, input, input + lengths[i % INPUT_COUNT]);
+            total += consume(&lexer);
+        }
+        report("rebind", start, total);
+    }
+    return 0;
+}
@@ -0,0 +1,115 @@
+/*
+ * Throughput of record batches. About a million short log lines are lexed:
+ *
+ *     lines:   `lxl_lexer_from_config()` for each line, then `lxl_lexer_next_token()` into a token array.
+ *     rebind:  `lxl_lexer_rebind()` on a single lexer for each line, then `lxl_lexer_tokenize()`.
+ *     batch:   `lxl_lexer_tokenize_lines()` into a batch, emptied whenever it is full.
+ *
+ * Build with optimisations enabled, e.g. `gcc bench_records.c -O2 -o bench_records`.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define LEXEL_IMPLEMENTATION
+#include "../lexel.h"
+
+#define LINE_COUNT (1 << 20)
+#define TOKEN_CAPACITY 4096
+#define RECORD_CAPACITY 256
+
+static const char *const lines[] = {
+    "2024-05-01 12:00:01 INFO server started on port 8080",
+    "2024-05-01 12:00:02 WARN retrying request id=42 after 1.5 s",
+    "2024-05-01 12:00:03 ERROR failed to open \"/var/log/app.log\": permission denied",
+    "2024-05-01 12:00:04 DEBUG cache hit ratio 0.97 (hits=1033, misses=31)",
+};
+#define SAMPLE_LINE_COUNT (sizeof lines / sizeof lines[0])
+
+static const struct lxl_delim_pair strings[] = {{"\"", "\""}, {NULL, NULL}};
+static const int string_types[] = {2};
+static const char *const puncts[] = {"-", ":", "=", "(", ")", ",", "/", NULL};
+static const int punct_types[] = {10, 11, 12, 13, 14, 15, 16};
+
+static struct lxl_token tokens[TOKEN_CAPACITY];
+static struct lxl_record_range records[RECORD_CAPACITY];
+
+// Print the time per line since `start`. `total` is only printed so that the work is not optimised away.
+static void report(const char *name, clock_t start, size_t total) {
+    double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("%-7s %6.1f ns per line, %5.2f s (checksum %zu)\n",
+           name, seconds * 1e9 / LINE_COUNT, seconds, total);
+}
+
+int main(void) {
+    size_t size = 0;
+    for (size_t i = 0; i < LINE_COUNT; ++i) size += strlen(lines[i % SAMPLE_LINE_COUNT]) + 1;
+    char *buffer = malloc(size);
+    if (buffer == NULL) return 1;
+    char *p = buffer;
+    for (size_t i = 0; i < LINE_COUNT; ++i) {
+        size_t length = strlen(lines[i % SAMPLE_LINE_COUNT]);
+        memcpy(p, lines[i % SAMPLE_LINE_COUNT], length);
+        p[length] = '\n';
+        p += length + 1;
+    }
+    const char *end = buffer + size;
+
+    struct lxl_lexer config = lxl_lexer_new("", NULL);
+    config.line_string_delims = strings;
+    config.line_string_types = string_types;
+    config.string_escape_chars = "\\";
+    config.default_int_base = 10;
+    config.default_int_type = 0;
+    config.default_float_base = 10;
+    config.default_float_type = 1;
+    config.puncts = puncts;
+    config.punct_types = punct_types;
+    config.default_word_type = 3;
+    config.word_lexing_rule = LXL_LEX_WORD;
+
+    size_t total = 0;
+    clock_t start = clock();
+    for (const char *line = buffer; line < end;) {
+        const char *line_end = memchr(line, '\n', end - line);
+        struct lxl_lexer lexer = lxl_lexer_from_config(&config, line, line_end);
+        size_t count = 0;
+        for (;;) {
+            struct lxl_token token = lxl_lexer_next_token(&lexer);
+            if (LXL_TOKEN_IS_END(token)) break;
+            tokens[count++] = token;
+        }
+        total += count;
+        line = line_end + 1;
+    }
+    report("lines", start, total);
+
+    total = 0;
+    start = clock();
+    struct lxl_lexer lexer = config;
+    for (const char *line = buffer; line < end;) {
+        const char *line_end = memchr(line, '\n', end - line);
+        lxl_lexer_rebind(&lexer, line, line_end);
+        total += lxl_lexer_tokenize(&lexer, tokens, TOKEN_CAPACITY);
+        line = line_end + 1;
+    }
+    report("rebind", start, total);
+
+    total = 0;
+    start = clock();
+    struct lxl_record_batch batch = {
+        .tokens = tokens, .token_capacity = TOKEN_CAPACITY,
+        .records = records, .record_capacity = RECORD_CAPACITY,
+    };
+    for (const char *line = buffer; line < end;) {
+        batch.token_count = 0;
+        batch.record_count = 0;
+        line = lxl_lexer_tokenize_lines(&config, line, end, &batch);
+        total += batch.token_count;
+    }
+    report("batch", start, total);
+
+    free(buffer);
+    return 0;
+}
@@ -0,0 +1,105 @@
+/*
+ * Throughput of lexing with a structural index. For each sample, the sample is repeated to fill a buffer of
+ * about 16MB, which is lexed with the preset, then indexed and lexed again with the index attached. The
+ * time to build the index is reported separately and included in the indexed throughput.
+ *
+ * The JSON sample has long strings, which the index skips to their closing quote. The C sample has two
+ * kinds of string, so only its whitespace is indexed.
+ *
+ * Build with optimisations enabled, e.g. `gcc bench_structural_index.c -O2 -o bench_structural_index`.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define LEXEL_IMPLEMENTATION
+#include "../lexel.h"
+
+#define BUFFER_SIZE (16 << 20)
+
+struct sample {
+    enum lxl_language language;
+    const char *name;
+    const char *source;
+};
+
+static const struct sample samples[] = {
+    {
+        LXL_LANG_JSON, "JSON",
+        "{\"id\": 12345, \"description\": \"An example item with a description of about eighty bytes.....\",\n"
+        " \"path\": \"/usr/share/example/items/12345/description/long/enough/to/matter.json\", \"n\": 1},\n",
+    },
+    {
+        LXL_LANG_C, "C",
+        "static int parse_header(const struct buffer *buf, size_t *out_length) {\n"
+        "    if (buf->length < HEADER_SIZE) return -1;  // Too short.\n"
+        "    unsigned long value = 0x1Fu;\n"
+        "    for (size_t i = 0; i < buf->length && i != 42; ++i) {\n"
+        "        value = (value << 8) | (unsigned char)buf->data[i];\n"
+        "    }\n"
+        "    *out_length = value * 1.5e3f;\n"
+        "    printf(\"length: %lu\\n\", value);\n"
+        "    return 0;\n"
+        "}\n",
+    },
+};
+
+#define SAMPLE_COUNT (sizeof samples / sizeof samples[0])
+
+static double seconds_since(clock_t start) {
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+// Lex the whole input, returning the number of tokens.
+static size_t lex_all(struct lxl_lexer lexer) {
+    size_t count = 0;
+    for (;;) {
+        struct lxl_token token = lxl_lexer_next_token(&lexer);
+        if (LXL_TOKEN_IS_END(token)) break;
+        ++count;
+    }
+    return count;
+}
+
+int main(void) {
+    char *buffer = malloc(BUFFER_SIZE);
+    // Three masks of a bit per byte, with a spare word each.
+    size_t region_size = 3 * (BUFFER_SIZE / 8 + 64);
+    char *region_data = malloc(region_size);
+    if (buffer == NULL || region_data == NULL) return 1;
+    for (size_t i = 0; i < SAMPLE_COUNT; ++i) {
+        size_t sample_length = strlen(samples[i].source);
+        size_t size = 0;
+        while (size + sample_length <= BUFFER_SIZE) {
+            memcpy(buffer + size, samples[i].source, sample_length);
+            size += sample_length;
+        }
+        struct lxl_lexer lexer = lxl_lexer_preset(samples[i].language, buffer, buffer + size);
+
+        clock_t start = clock();
+        size_t token_count = lex_all(lexer);
+        double plain_seconds = seconds_since(start);
+
+        struct lxl_region region = {.capacity = region_size, .alloc_count = 0, .data = region_data};
+        struct lxl_structural_index index;
+        start = clock();
+        if (!lxl_structural_index_build(&index, &lexer, &region)) return 1;
+        double build_seconds = seconds_since(start);
+        start = clock();
+        size_t indexed_count = lex_all(lexer);
+        double indexed_seconds = build_seconds + seconds_since(start);
+
+        if (indexed_count != token_count) {
+            printf("%-5s token counts differ: %zu and %zu\n", samples[i].name, token_count, indexed_count);
+            return 1;
+        }
+        double megabytes = (double)size / (1 << 20);
+        printf("%-5s without the index %7.1f MB/s, with it %7.1f MB/s (of which building %.3f s)%s\n",
+               samples[i].name, megabytes / plain_seconds, megabytes / indexed_seconds, build_seconds,
+               (index.quotes != NULL) ? "" : ", strings not indexed");
+    }
+    free(region_data);
+    free(buffer);
+    return 0;
+}
@@ -0,0 +1,98 @@
+/*
+ * Throughput of validation. For each language, a sample is repeated to fill a buffer of about 16MB, which
+ * is checked for errors in two ways:
+ *
+ *     drain:     `lxl_lexer_next_token()` until the end, counting the error tokens.
+ *     validate:  `lxl_lexer_validate()`.
+ *
+ * Build with optimisations enabled, e.g. `gcc bench_validate.c -O2 -o bench_validate`.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define LEXEL_IMPLEMENTATION
+#include "../lexel.h"
+
+#define BUFFER_SIZE (16 << 20)
+
+struct sample {
+    enum lxl_language language;
+    const char *name;
+    const char *source;
+};
+
+static const struct sample samples[] = {
+    {
+        LXL_LANG_C, "C",
+        "static int parse_header(const struct buffer *buf, size_t *out_length) {\n"
+        "    if (buf->length < HEADER_SIZE) return -1;  // Too short.\n"
+        "    unsigned long value = 0x1Fu;\n"
+        "    for (size_t i = 0; i < buf->length && i != 42; ++i) {\n"
+        "        value = (value << 8) | (unsigned char)buf->data[i];\n"
+        "    }\n"
+        "    *out_length = value * 1.5e3f;\n"
+        "    printf(\"length: %lu\\n\", value);\n"
+        "    return 0;\n"
+        "}\n",
+    },
+    {
+        LXL_LANG_JSON, "JSON",
+        "{\"id\": 12345, \"name\": \"example item\", \"price\": 19.99, \"tags\": [\"a\", \"b\", \"c\"],\n"
+        " \"active\": true, \"parent\": null, \"ratio\": -2.5e-3, \"nested\": {\"x\": 1, \"y\": [1, 2, 3]}},\n",
+    },
+    {
+        LXL_LANG_SQL, "SQL",
+        "SELECT u.id, u.name, COUNT(o.id) AS order_count -- per user\n"
+        "FROM users u LEFT JOIN orders o ON o.user_id = u.id\n"
+        "WHERE u.created_at >= '2024-01-01' AND u.status <> 'deleted'\n"
+        "GROUP BY u.id, u.name HAVING COUNT(o.id) > 5 ORDER BY order_count DESC LIMIT 100;\n",
+    },
+};
+
+#define SAMPLE_COUNT (sizeof samples / sizeof samples[0])
+
+static double seconds_since(clock_t start) {
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main(void) {
+    char *buffer = malloc(BUFFER_SIZE);
+    if (buffer == NULL) return 1;
+    for (size_t i = 0; i < SAMPLE_COUNT; ++i) {
+        size_t sample_length = strlen(samples[i].source);
+        size_t size = 0;
+        while (size + sample_length <= BUFFER_SIZE) {
+            memcpy(buffer + size, samples[i].source, sample_length);
+            size += sample_length;
+        }
+        struct lxl_lexer config = lxl_lexer_preset(samples[i].language, buffer, buffer + size);
+
+        struct lxl_lexer lexer = config;
+        size_t error_count = 0;
+        clock_t start = clock();
+        for (;;) {
+            struct lxl_token token = lxl_lexer_next_token(&lexer);
+            if (LXL_TOKEN_IS_END(token)) break;
+            error_count += LXL_TOKEN_IS_ERROR(token);
+        }
+        double drain_seconds = seconds_since(start);
+
+        lexer = config;
+        start = clock();
+        struct lxl_validation validation = lxl_lexer_validate(&lexer, false);
+        double validate_seconds = seconds_since(start);
+
+        if (validation.error_count != error_count) {
+            printf("%-5s error counts differ: %zu and %zu\n", samples[i].name, error_count,
+                   validation.error_count);
+            return 1;
+        }
+        double megabytes = (double)size / (1 << 20);
+        printf("%-5s drain %7.1f MB/s, validate %7.1f MB/s (%.1fx)\n", samples[i].name,
+               megabytes / drain_seconds, megabytes / validate_seconds, drain_seconds / validate_seconds);
+    }
+    free(buffer);
+    return 0;
+}
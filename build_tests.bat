@@ -1,4 +1,6 @@
 set curdir=%cd%
 cd .\test
 for %%# in (*.c) do gcc "%%#" -o "%%~n#.exe" -Wall -Werror -Wextra -pedantic -g -std=c11
+gcc -x c ..\lexel.h -c -o lexel.o -DLEXEL_IMPLEMENTATION -Wall -Werror -Wextra -pedantic -g -std=c11
+for %%# in (*.cpp) do g++ "%%#" lexel.o -o "%%~n#.exe" -Wall -Werror -Wextra -pedantic -g -std=c++20
 cd %curdir%
@@ -43,6 +43,7 @@
 #include <stdbool.h>     // bool, false, true -- requires C99
 #include <stddef.h>      // size_t, ptrdiff_t, max_align_t
 #include <stdint.h>      // intptr_t
+#include <string.h>      // memcmp()
 
 // CUSTOMISATION OPTIONS.
 
@@ -70,6 +71,38 @@
 
 static_assert(((LXL_REGION_ALIGN) & ((LXL_REGION_ALIGN)-1)) == 0, "Alignment must be a power of 2");
 
+// This option controls how far ahead of a token the lexer may need to look to decide where it ends
+// (e.g. the length of the longest punct, delimiter, prefix or suffix). It is used by budgeted lexing
+// to decide whether a token lexed against a partial input is complete.
+#ifndef LXL_BUDGET_LOOKAHEAD
+# define LXL_BUDGET_LOOKAHEAD 64
+#endif
+
+// This option controls the default number of bytes lexed between deadline checks in budgeted lexing.
+#ifndef LXL_BUDGET_POLL_BYTES
+# define LXL_BUDGET_POLL_BYTES 4096
+#endif
+
+// This option selects which rule families are compiled into the lexer, as a bitmask of the feature flags
+// below. Families left out are removed from `lxl_lexer_next_token()` entirely and the corresponding
+// configuration fields are ignored. For example, a lexer with no floats or block comments can use:
+//     #define LXL_FEATURES (LXL_FEATURE_ALL & ~(LXL_FEATURE_FLOATS | LXL_FEATURE_BLOCK_COMMENTS))
+#define LXL_FEATURE_LINE_STRINGS      0x001
+#define LXL_FEATURE_MULTILINE_STRINGS 0x002
+#define LXL_FEATURE_INTEGERS          0x004
+#define LXL_FEATURE_FLOATS            0x008
+#define LXL_FEATURE_NUMBER_SIGNS      0x010
+#define LXL_FEATURE_PUNCTS            0x020
+#define LXL_FEATURE_KEYWORDS          0x040
+#define LXL_FEATURE_LINE_COMMENTS     0x080
+#define LXL_FEATURE_BLOCK_COMMENTS    0x100
+#define LXL_FEATURE_OFFSIDE_RULE      0x200
+#define LXL_FEATURE_ALL               0x3FF
+
+#ifndef LXL_FEATURES
+# define LXL_FEATURES LXL_FEATURE_ALL
+#endif
+
 // END CUSTOMISATION OPTIONS.
 
 // META-DEFINITIONS.
@@ -88,8 +121,23 @@ static_assert(((LXL_REGION_ALIGN) & ((LXL_REGION_ALIGN)-1)) == 0, "Alignment mus
 // If the assertion fires, it suggests a bug in lexel itself.
 #define LXL_UNREACHABLE() LXL_ASSERT(0 && "Unreachable. This may be a bug in lexel.")
 
+// Hint that the memory at `addr` will be read soon. This is purely a performance hint.
+#ifdef __GNUC__
+# define LXL__PREFETCH(addr) __builtin_prefetch(addr)
+#else
+# define LXL__PREFETCH(addr) ((void)(addr))
+#endif
+
+// Evaluate to whether the given feature (see LXL_FEATURES) is compiled in. This is a constant expression,
+// so code guarded by it is removed when the feature is disabled.
+#define LXL_HAS_FEATURE(feature) (((LXL_FEATURES) & (feature)) != 0)
+
 // END META-DEFINITIONS.
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 // LEXEL CORE.
 
 // These are the core definitions for lexel -- the lexer and token.
@@ -108,6 +156,9 @@ enum lxl_lex_error {
     LXL_LERR_UNCLOSED_STRING = -19,   // A string-like literal had no closing delimiter before the end.
     LXL_LERR_INVALID_INTEGER = -20,   // An integer literal was invalid (e.g. had a prefix but no payload).
     LXL_LERR_INVALID_FLOAT = -21,     // A floating-point literal was invalid.
+    LXL_LERR_INCONSISTENT_DEDENT = -22, // A dedent did not match any outer indentation level.
+    LXL_LERR_INDENT_OVERFLOW = -23,   // The indentation was nested too deeply for the indent stack.
+    LXL_LERR_TAB_INDENT = -24,        // A tab was used in indentation when forbidden by the tab policy.
 };
 
 // Lexer status.
@@ -118,6 +169,17 @@ enum lxl_lexer_status {
     LXL_LSTS_FINISHED_ABNORMAL,  // Reached the end of tokens abnormally.
 };
 
+// How tabs are measured in indentation when using the offside rule.
+enum lxl_tab_policy {
+    LXL_TABS_EXPAND,  // Tabs advance to the next multiple of the lexer's tab width.
+    LXL_TABS_SINGLE,  // Tabs count as a single column, like spaces.
+    LXL_TABS_REJECT,  // Tabs are not allowed in indentation.
+};
+
+// Values of a lexer's `.line_indent` other than a width.
+#define LXL_INDENT_NONE (-1)      // The next token does not start a line.
+#define LXL_INDENT_REJECTED (-2)  // The line is indented with a tab rejected by LXL_TABS_REJECT.
+
 enum lxl_word_lexing_rule {
     LXL_LEX_SYMBOLIC,  // Lex all symbolic characters (any non-whitespace).
     LXL_LEX_WORD,      // Lex only word characters (any non-reserved symbolic).
@@ -150,6 +212,17 @@ struct lxl_token {
     int token_type;           // The type of the lexical token. Negative values have special meanings.
 };
 
+// The state of a block comment or string scan paused by budgeted lexing (see `.scan_pause`).
+struct lxl_paused_scan {
+    const struct lxl_delim_pair *delims;  // The delimiters of the comment or string (NULL if none is paused).
+    int depth;                            // The nesting depth of a comment (0 for a string).
+    bool nestable;                        // Can the comment be nested?
+    enum lxl_string_type string_type;     // Whether the string is a line or multiline string.
+    int token_type;                       // The type of the string's token.
+    size_t token_offset;                  // The offset of the string's token from the start of the input.
+    struct lxl_location token_loc;        // The location of the string's token.
+};
+
 // The main lexer object.
 struct lxl_lexer {
     const char *start;        // The start of the lexer's source code.
@@ -181,6 +254,7 @@ struct lxl_lexer {
     int default_float_type;               // Default token type for float literals.
     int default_float_base;               // Default base for (unprefixed) float literals.
     const char *default_exponent_marker; // Default exponent marker for float literals (default: "e").
+    bool extended_floats;        // Lex "1e5" as a float and match float suffixes? (default: false)
     const char *const *puncts;   // List of (non-word) punctaution token values (e.g., "+", "==", ";", etc.).
     const int *punct_types;      // List of token types corresponding to each punctuation token above.
     const char *const *keywords; // List of keywords (word tokens with unique types).
@@ -196,6 +270,25 @@ struct lxl_lexer {
     enum lxl_lexer_status status; // Current status of the lexer.
     bool emit_line_endings;       // Should line endings have their own tokens? (default: false)
     bool collect_line_endings;    // Should consecutive line ending tokens be combined? (default: true)
+    bool offside_rule;            // Should indentation changes emit indent/dedent tokens? (default: false)
+    int indent_type;              // The type to use for indent tokens (default: LXL_TOKEN_INDENT).
+    int dedent_type;              // The type to use for dedent tokens (default: LXL_TOKEN_DEDENT).
+    enum lxl_tab_policy tab_policy;  // How tabs are measured in indentation (default: expand).
+    int tab_width;                // The tab stop width used by LXL_TABS_EXPAND (default: 8).
+    const struct lxl_delim_pair *bracket_delims;  // List of paired bracket puncts (e.g. "(" and ")").
+    int *indent_stack;            // Caller-allocated stack of indentation widths (for the offside rule).
+    int indent_capacity;          // The capacity of the indent stack.
+    int indent_depth;             // The number of indentation levels on the indent stack.
+    int pending_dedents;          // The number of dedent tokens still to be emitted.
+    int bracket_depth;            // The current bracket nesting depth (see `.bracket_delims`).
+    int line_indent;              // The indentation of the line the next token starts (or LXL_INDENT_*).
+    bool padded_input;            // Is the input followed by LXL_INPUT_PADDING NUL bytes? (default: false)
+    struct lxl_rule_profile *rule_profile;  // Adaptive punct and keyword ordering (default: NULL).
+    const struct lxl_structural_index *structural_index;  // Bitmasks of the input's bytes (default: NULL).
+    const struct lxl_rule_index *rule_index;  // Precomputed rule lookup tables (default: NULL).
+    const char *scan_pause;       // Where long comment and string scans pause (set by budgeted lexing).
+    struct lxl_paused_scan paused_scan;  // The state of a comment or string scan paused at `.scan_pause`.
+    size_t budget_slice;          // The slice budgeted lexing resumes with (0 for its default).
 };
 
 // END LEXEL CORE.
@@ -232,6 +325,8 @@ enum lxl__token_mvs {
     LXL_TOKENS_END_ABNORMAL = -3,  // Special token type signifying an abnormal end of the token stream.
     LXL_TOKEN_LINE_ENDING = -4,    // Special token type signifying the end of a line.
     LXL_TOKEN_NO_TOKEN = -5,       // Special token type for a non-existant token.
+    LXL_TOKEN_INDENT = -6,         // Special token type signifying an increase in indentation.
+    LXL_TOKEN_DEDENT = -7,         // Special token type signifying a decrease in indentation.
     // See enum lxl_lex_error for token error types.
 };
 
@@ -251,6 +346,9 @@ enum lxl__token_mvs {
 // A string containing the digits 0--9 in order.
 #define LXL_DIGITS "0123456789"
 
+// The number of NUL bytes which must follow the input of a lexer with `.padded_input` set.
+#define LXL_INPUT_PADDING 64
+
 // END LEXEL MAGIC VALUES.
 
 
@@ -325,6 +423,21 @@ struct lxl_lexer lxl_lexer_new(const char *start, const char *end);
 // Create a new `lxl_lexer` object from a string view.
 struct lxl_lexer lxl_lexer_from_sv(struct lxl_string_view sv);
 
+// Create a new `lxl_lexer` object for input which is followed by at least LXL_INPUT_PADDING NUL bytes
+// (i.e. `end[0]` to `end[LXL_INPUT_PADDING - 1]` are readable and '\0'). The NUL bytes act as a sentinel,
+// allowing the lexer to skip bounds checks in its inner loops. `end` must not be NULL.
+struct lxl_lexer lxl_lexer_new_padded(const char *start, const char *end);
+
+// Create a new `lxl_lexer` object using the configuration of an existing lexer, `config`.
+// Only the configuration (comment/string delimiters, number rules, puncts, keywords, hooks, etc.)
+// is copied; the cursor state is initialised as in `lxl_lexer_new()`. `config` can be a lexer which
+// is only ever used as a configuration template (its own input is ignored).
+// `.padded_input` is cleared, as nothing is known about the padding of the new input; set it again if the
+// new input is padded. `.rule_profile`, `.indent_stack` and `.indent_capacity` are cleared too, as they are
+// updated while lexing and so belong to a single lexer: with the offside rule, give the new lexer its own
+// indent stack.
+struct lxl_lexer lxl_lexer_from_config(const struct lxl_lexer *config, const char *start, const char *end);
+
 // Get the next token from the lexer. A token of type LXL_TOKENS_END is returned when
 // the token stream is exhausted.
 struct lxl_token lxl_lexer_next_token(struct lxl_lexer *lexer);
@@ -333,9 +446,21 @@ struct lxl_token lxl_lexer_next_token(struct lxl_lexer *lexer);
 // (i.e. there are no more tokens in the source code).
 bool lxl_lexer_is_finished(struct lxl_lexer *lexer);
 
-// Reset the lexer to the start of its input.
+// Reset the lexer to the start of its input. The structural index is kept, so if the bytes of the input have
+// changed, rebuild it (or clear `.structural_index`) first.
 void lxl_lexer_reset(struct lxl_lexer *lexer);
 
+// Point the lexer at a new input, resetting all cursor state (position, status, error, previous token type,
+// indentation and bracket depth) as in `lxl_lexer_from_config()` but keeping the configuration in place.
+// `end` may be NULL as for `lxl_lexer_new()`. The structural index (which describes the old input) is
+// cleared; if `.padded_input` is set, the new input must be padded too.
+void lxl_lexer_rebind(struct lxl_lexer *lexer, const char *start, const char *end);
+
+// Lex up to `capacity` tokens into the `tokens` array and return the number of tokens written. The end
+// token is not written; once it is reached, the lexer is finished (see `lxl_lexer_is_finished()`).
+// To tokenize the whole input in batches, call repeatedly until the lexer is finished.
+size_t lxl_lexer_tokenize(struct lxl_lexer *lexer, struct lxl_token *tokens, size_t capacity);
+
 // Construct a zero-terminated array to use for setting lexer fields calling for lists.
 // Requires at least one element.
 #define LXL_LIST(type, ...) ((type[]) {__VA_ARGS__, 0})
@@ -403,6 +528,9 @@ void lxl_lexer__recalc_column(struct lxl_lexer *lexer);
 // Return whether the lexer can emit a line ending token when it sees an LF.
 bool lxl_lexer__can_emit_line_ending(struct lxl_lexer *lexer);
 
+// Return the current character without consuming it, or '\0' if the lexer is at the end of its input.
+char lxl_lexer__peek(struct lxl_lexer *lexer);
+
 // Return non-NULL if the current current matches any of those passed but do not consume it, otherwise,
 // return NULL. On success, the return value is the pointer to the matching character, i.e., into the
 // null-terminated string `chars`.
@@ -515,11 +643,17 @@ const char *const *lxl_lexer__match_punct(struct lxl_lexer *lexer);
 
 // Advance the lexer past any whitespace characters and return the number of characters consumed.
 int lxl_lexer__skip_whitespace(struct lxl_lexer *lexer);
+// Advance the lexer past a run of whitespace using the lexer's structural index (if any applies).
+void lxl_lexer__skip_indexed_whitespace(struct lxl_lexer *lexer, bool lf_is_whitespace);
+// Advance the lexer past the rest of a string (opener already consumed) using the lexer's structural index,
+// if it applies and agrees with the lexer. Return whether it did; if not, the lexer is unchanged.
+bool lxl_lexer__skip_indexed_string(struct lxl_lexer *lexer, const char *closer);
 // Advance the lexer past the rest of the current line and return the number of characters consumed.
 int lxl_lexer__skip_line(struct lxl_lexer *lexer);
-// Advance the lexer past the current (possibly nestable) block comment (opener already consumed)
-// and return the number of characters consumed.
-int lxl_lexer__skip_block_comment(struct lxl_lexer *lexer, struct lxl_delim_pair delims, bool nested);
+// Advance the lexer past the current (possibly nestable) block comment (opener already consumed), from
+// nesting depth `depth`, and return the number of characters consumed. The scan may pause at `.scan_pause`.
+int lxl_lexer__skip_block_comment(struct lxl_lexer *lexer, const struct lxl_delim_pair *delims, bool nested,
+                                  int depth);
 
 // Create an unitialised token starting at the lexer's current position.
 struct lxl_token lxl_lexer__start_token(struct lxl_lexer *lexer);
@@ -537,19 +671,140 @@ struct lxl_token lxl_lexer__create_error_token(struct lxl_lexer *lexer);
 int lxl_lexer__lex_symbolic(struct lxl_lexer *lexer);
 // Consume a word token (non-reserved symbolic) and return the number of characters read.
 int lxl_lexer__lex_word(struct lxl_lexer *lexer);
-// Consume a string-like token delimited by `delim` and return the number of characters read.
-int lxl_lexer__lex_string(struct lxl_lexer *lexer, const char *closer, enum lxl_string_type string_type);
+// Consume the rest of a string-like token delimited by `delims` and return the number of characters read.
+// The scan may pause at `.scan_pause`.
+int lxl_lexer__lex_string(struct lxl_lexer *lexer, const struct lxl_delim_pair *delims,
+                          enum lxl_string_type string_type);
 // Consume the digits of an integer literal in the given base (2--36).
 int lxl_lexer__lex_integer(struct lxl_lexer *lexer, int base);
+// Consume a run of digits (and digit separators) with the given base and return the number of digits.
+// Unlike `lxl_lexer__lex_integer()`, nothing is un-lexed if no digits are found.
+int lxl_lexer__lex_digits(struct lxl_lexer *lexer, int base);
 // Consume the digits of a floating-point literal with the given base and exponent marker.
 int lxl_lexer__lex_float(struct lxl_lexer *lexer, int index, const char *exponent_marker);
 
 // Get the token type corresponding to the word specified.
 int lxl_lexer__get_word_type(struct lxl_lexer *lexer, const char *word_start);
 
+// Update the bracket depth if `punct` is one of the lexer's bracket delimiters.
+void lxl_lexer__update_bracket_depth(struct lxl_lexer *lexer, const char *punct);
+// Return the width of the indentation before the current position on the current line, whose start must be
+// in the input, measured according to the lexer's tab policy. Return LXL_INDENT_REJECTED if the indentation
+// contains a tab forbidden by the policy.
+int lxl_lexer__measure_indentation(struct lxl_lexer *lexer);
+// Apply the offside rule at the start of the next token. If an indent, dedent or error token should be
+// emitted before it, write it to OUT_token and return true. The rule only applies to the first token after
+// whitespace skipping reached the start of a line (see `.line_indent`), outside of brackets; blank lines, LF
+// tokens and lines started inside a token or comment do not affect it.
+bool lxl_lexer__lex_offside(struct lxl_lexer *lexer, struct lxl_token *OUT_token);
+
 // END LEXER INTERNAL INTERFACE.
 
 
+// LEXEL CURSOR.
+
+// A by-value copy of the lexer's scanning state. The built-in scanners load a cursor at the start of a
+// scan loop, advance it in local variables and store it back once at the end, so the compiler can keep
+// the position in registers rather than reading and writing the lexer on every character.
+// The `lxl_lexer__*` functions above remain the interface for custom lexers and hooks.
+// These functions are defined here (rather than in the implementation) so they can be inlined.
+
+struct lxl_cursor {
+    const char *current;      // Pointer to the current character.
+    const char *end;          // The end of the source code.
+    struct lxl_location pos;  // The current position (line, column) in the source.
+};
+
+// Load a cursor from the lexer's current state.
+static inline struct lxl_cursor lxl_cursor__load(const struct lxl_lexer *lexer) {
+    struct lxl_cursor cursor;
+    cursor.current = lexer->current;
+    cursor.end = lexer->end;
+    cursor.pos = lexer->pos;
+    return cursor;
+}
+
+// Write the cursor's position back to the lexer.
+static inline void lxl_cursor__store(struct lxl_lexer *lexer, struct lxl_cursor cursor) {
+    lexer->current = cursor.current;
+    lexer->pos = cursor.pos;
+}
+
+// Return whether the cursor is at the end of its input.
+static inline bool lxl_cursor__is_at_end(struct lxl_cursor cursor) {
+    return cursor.current >= cursor.end;
+}
+
+// Return the current character, or '\0' at the end of the input.
+static inline char lxl_cursor__peek(struct lxl_cursor cursor) {
+    return (cursor.current < cursor.end) ? *cursor.current : '\0';
+}
+
+// Return the current character and advance the cursor to the next character. Return '\0' at the end.
+static inline char lxl_cursor__advance(struct lxl_cursor *cursor) {
+    if (cursor->current >= cursor->end) return '\0';
+    char c = *cursor->current++;
+    if (c != '\n') {
+        ++cursor->pos.column;
+    }
+    else {
+        cursor->pos.column = 0;
+        ++cursor->pos.line;
+    }
+    return c;
+}
+
+// Advance the cursor by `n` characters. Return false if the end was reached first.
+static inline bool lxl_cursor__advance_by(struct lxl_cursor *cursor, size_t n) {
+    while (n-- > 0) {
+        if (!lxl_cursor__advance(cursor)) return false;
+    }
+    return true;
+}
+
+// Return a pointer to the first character in `chars` matching the current character, or NULL.
+static inline const char *lxl_cursor__check_chars(struct lxl_cursor cursor, const char *chars) {
+    if (chars == NULL) return NULL;
+    char c = lxl_cursor__peek(cursor);
+    if (c == '\0') return NULL;  // `chars` cannot contain '\0'.
+    for (; *chars != '\0'; ++chars) {
+        if (c == *chars) return chars;
+    }
+    return NULL;
+}
+
+// Return whether the current character is non-LF whitespace.
+static inline bool lxl_cursor__check_blank(struct lxl_cursor cursor) {
+    if (cursor.current >= cursor.end) return false;
+    char c = *cursor.current;
+    return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+}
+
+// Return whether the next `n` characters are equal to `s`.
+static inline bool lxl_cursor__check_string_n(struct lxl_cursor cursor, const char *s, size_t n) {
+    if (n > (size_t)(cursor.end - cursor.current)) return false;
+    return memcmp(cursor.current, s, n) == 0;
+}
+
+// Return whether the next `n` characters are equal to `s`, and consume them if so.
+static inline bool lxl_cursor__match_string_n(struct lxl_cursor *cursor, const char *s, size_t n) {
+    if (!lxl_cursor__check_string_n(*cursor, s, n)) return false;
+    return lxl_cursor__advance_by(cursor, n);
+}
+
+// Return whether the current character is a digit in the given base (2-26).
+static inline bool lxl_cursor__check_digit(struct lxl_cursor cursor, int base) {
+    if (base == 0) return false;
+    char c = lxl_cursor__peek(cursor);
+    if ('0' <= c && c <= '9') return c - '0' < base;
+    // Letters are case-insensitive, so 'A'/'a' is 10, 'B'/'b' is 11, etc.
+    c |= 0x20;
+    return 'a' <= c && c <= 'z' && 10 + (c - 'a') < base;
+}
+
+// END LEXEL CURSOR.
+
+
 // LEXEL STRING VIEW.
 
 // Functions and macros for working with string views.
@@ -594,6 +849,936 @@ bool lxl_region__align(struct lxl_region *region);
 // END LEXEL REGION.
 
 
+// LEXEL CONFIG PUBLICATION.
+
+// These definitions allow a lexer configuration to be replaced at runtime while other threads are lexing.
+// A configuration is a lexer object used as a template for `lxl_lexer_from_config()`. Readers take a
+// reference to the currently published configuration, create a lexer from it, and release the reference
+// once that lexer (and any tokens pointing into configuration data) is no longer needed. A writer
+// publishes a new configuration atomically, then waits for a grace period before reclaiming the old one.
+// Readers never take a lock; lexers created from a configuration do not touch the slot at all. They do
+// not share the configuration's rule profile or indent stack either (see `lxl_lexer_from_config()`).
+// NOTE: this interface requires C11 atomics. It is unavailable if LXL_NO_CONFIG_PUBLICATION is defined,
+// when compiling as C++, or when the implementation does not support atomics.
+
+#if !defined(LXL_NO_CONFIG_PUBLICATION) && !defined(__cplusplus) && !defined(__STDC_NO_ATOMICS__)
+# define LXL_HAS_CONFIG_PUBLICATION 1
+
+#include <stdatomic.h>   // _Atomic, atomic_load() et al.
+
+// A slot holding the currently published configuration.
+// Writers must be serialised by the caller (e.g. a single configuration thread).
+struct lxl_config_slot {
+    _Atomic(const struct lxl_lexer *) config;  // The currently published configuration.
+    atomic_uint epoch;                        // Grace period counter. Its parity selects the reader count.
+    atomic_uint reader_counts[2];             // Active readers for each epoch parity.
+};
+
+// A reader's reference to a published configuration.
+struct lxl_config_ref {
+    const struct lxl_lexer *config;  // The configuration to use.
+    unsigned parity;                 // The epoch parity the reader registered under.
+};
+
+// Initialise a slot with its first configuration.
+void lxl_config_slot_init(struct lxl_config_slot *slot, const struct lxl_lexer *config);
+
+// Take a reference to the current configuration. The configuration will not be reclaimed until
+// the reference is released.
+struct lxl_config_ref lxl_config_acquire(struct lxl_config_slot *slot);
+// Release a reference taken by `lxl_config_acquire()`.
+void lxl_config_release(struct lxl_config_slot *slot, struct lxl_config_ref ref);
+
+// Publish a new configuration and return the previous one. New readers will see `config` immediately.
+// The returned configuration must not be reclaimed until `lxl_config_synchronize()` returns or
+// `lxl_config_is_quiescent()` returns true.
+// NOTE: there may be at most one publication per grace period: the writer must wait for the previous
+// publication to become quiescent before publishing again. Otherwise readers of both replaced
+// configurations would share a reader count and one could be reclaimed while still in use. This is
+// asserted.
+const struct lxl_lexer *lxl_config_publish(struct lxl_config_slot *slot, const struct lxl_lexer *config);
+// Return whether all readers which could still hold the configuration replaced by the most recent
+// publication have released it. This function does not block.
+bool lxl_config_is_quiescent(struct lxl_config_slot *slot);
+// Wait (by spinning) until `lxl_config_is_quiescent()` is true.
+void lxl_config_synchronize(struct lxl_config_slot *slot);
+
+#endif  // Config publication supported.
+
+// END LEXEL CONFIG PUBLICATION.
+
+
+// LEXEL TOKEN STREAMS.
+
+// A compact binary format for storing the token stream of a source file, e.g. in a build cache.
+// A stream consists of a header (see `struct lxl_token_stream_header`) followed by one fixed-size record
+// per token. Each record holds the token type and the offset and length of its value in the source, and
+// optionally its location. All fields are stored in native byte order, so the stream can be used
+// directly from a memory-mapped file without any parsing. A stream is only valid for the exact source
+// it was created from; `lxl_source_hash()` can be used to key a cache and check the source is unchanged.
+
+// The magic bytes at the start of every token stream.
+#define LXL_TOKEN_STREAM_MAGIC "LXLT"
+// The current version of the token stream format.
+#define LXL_TOKEN_STREAM_VERSION 1
+// The value written to `byte_order` in the header, used to detect streams written on other platforms.
+#define LXL_TOKEN_STREAM_BYTE_ORDER 0x01020304u
+
+// Token stream flags.
+enum lxl_token_stream_flags {
+    LXL_TSF_NONE = 0,
+    LXL_TSF_LOCATIONS = 1 << 0,  // Each record also stores the token's location (line, column).
+    LXL_TSF_ALL = LXL_TSF_LOCATIONS,  // All the flags known to this version.
+};
+
+// The header of a token stream.
+struct lxl_token_stream_header {
+    char magic[4];           // LXL_TOKEN_STREAM_MAGIC (without the null terminator).
+    uint16_t version;        // LXL_TOKEN_STREAM_VERSION.
+    uint16_t flags;          // Bitwise OR of `enum lxl_token_stream_flags`.
+    uint32_t byte_order;     // LXL_TOKEN_STREAM_BYTE_ORDER in native byte order.
+    uint32_t token_count;    // The number of token records following the header.
+    uint64_t source_length;  // The length of the source the tokens were lexed from.
+    uint64_t source_hash;    // The hash of the source (see `lxl_source_hash()`).
+};
+
+// A writer which appends token records to a caller-allocated buffer.
+struct lxl_token_stream_writer {
+    char *data;                // The output buffer.
+    size_t capacity;           // The capacity of the output buffer.
+    size_t size;               // The number of bytes written so far.
+    const char *source_start;  // The start of the source the tokens point into.
+    const char *source_end;    // The end of the source the tokens point into.
+    uint32_t token_count;      // The number of tokens written so far.
+    unsigned flags;            // Bitwise OR of `enum lxl_token_stream_flags`.
+    bool overflowed;           // Was a write unsuccessful (buffer full or source too large)?
+};
+
+// A reader over a complete token stream.
+struct lxl_token_stream_reader {
+    const char *records;       // Pointer to the first record.
+    size_t record_size;        // The size of each record in bytes.
+    uint32_t token_count;      // The number of records in the stream.
+    uint32_t index;            // The index of the next record to read.
+    const char *source_start;  // The start of the source the stream was lexed from.
+    const char *source_end;    // The end of the source the stream was lexed from.
+    unsigned flags;            // Bitwise OR of `enum lxl_token_stream_flags`.
+};
+
+// Return a 64-bit (non-cryptographic) hash of the source text.
+uint64_t lxl_source_hash(struct lxl_string_view source);
+
+// Return the size of a single token record with the given flags.
+size_t lxl_token_stream_record_size(unsigned flags);
+
+// Create a writer for tokens lexed from `source`. The header is written immediately.
+struct lxl_token_stream_writer lxl_token_stream_writer_new(void *buffer, size_t capacity,
+                                                           struct lxl_string_view source, unsigned flags);
+// Append a token record to the stream and return whether it could be written.
+bool lxl_token_stream_write_token(struct lxl_token_stream_writer *writer, struct lxl_token token);
+// Lex the remaining tokens from the lexer into the stream (including the final end token) and return
+// the number of tokens written. The lexer's input must lie within the writer's source. If the stream
+// becomes full, the lexer is left just after the last token written, so no token is lost.
+size_t lxl_token_stream_write_lexer(struct lxl_token_stream_writer *writer, struct lxl_lexer *lexer);
+// Finalise the header and return the total size of the stream in bytes, or 0 if any write failed.
+size_t lxl_token_stream_finish(struct lxl_token_stream_writer *writer);
+
+// Initialise a reader over the stream `data` of `size` bytes for the given source. Return false if the
+// stream is malformed, has an unsupported version, byte order or flags, was lexed from a source of a
+// different length, or has a record whose value lies outside the source. Every record is checked, so the
+// tokens read can always be used safely. The hash is not checked here (see `lxl_source_hash()`).
+bool lxl_token_stream_reader_init(struct lxl_token_stream_reader *reader, const void *data, size_t size,
+                                  struct lxl_string_view source);
+// Get the next token from the stream. A token of type LXL_TOKENS_END is returned when the stream is
+// exhausted. Without LXL_TSF_LOCATIONS, token locations are set to {-1, -1}.
+struct lxl_token lxl_token_stream_reader_next_token(struct lxl_token_stream_reader *reader);
+// Return whether the reader has read every record in the stream.
+bool lxl_token_stream_reader_is_finished(struct lxl_token_stream_reader *reader);
+// Reset the reader to the start of the stream.
+void lxl_token_stream_reader_reset(struct lxl_token_stream_reader *reader);
+// Get the token at the specified index in the stream.
+struct lxl_token lxl_token_stream_reader_token_at(struct lxl_token_stream_reader *reader, uint32_t index);
+
+// END LEXEL TOKEN STREAMS.
+
+
+// LEXEL FINGERPRINTS.
+
+// Fingerprints are hashes of a token stream which ignore trivia (whitespace, comments and line endings).
+// Two sources with the same fingerprint lex to the same sequence of token types and values, so
+// e.g. a build tool can skip reprocessing a file whose fingerprint hasn't changed. A fingerprint can
+// also be computed separately for each top-level block (e.g. each function body) in the source.
+// NOTE: hashes are computed in native byte order and so may differ between platforms.
+
+// A 128-bit hash value.
+struct lxl_hash128 {
+    uint64_t low, high;
+};
+
+// Streaming state for a fast, non-cryptographic 128-bit hash (MurmurHash3, x64 128-bit variant).
+struct lxl_hasher {
+    uint64_t h1, h2;               // Hash state.
+    unsigned char buffer[16];      // Bytes not yet forming a complete block.
+    size_t buffer_length;          // Number of bytes in the buffer.
+    uint64_t total_length;         // Total number of bytes hashed.
+};
+
+// The fingerprint of a top-level block.
+struct lxl_block_fingerprint {
+    const char *start;         // The start of the first token in the block.
+    const char *end;           // The end of the last token in the block.
+    struct lxl_hash128 hash;   // The fingerprint of the tokens in the block.
+};
+
+// Streaming fingerprint state.
+struct lxl_fingerprinter {
+    struct lxl_hasher hasher;        // Hash of the whole token stream.
+    struct lxl_hasher block_hasher;  // Hash of the current block.
+    int trivia_type;                 // Token type to ignore (default: LXL_TOKEN_LINE_ENDING).
+    int block_open_type;             // Token type which opens a block (e.g. for "{").
+    int block_close_type;            // Token type which closes a block (e.g. for "}").
+    int depth;                       // Current block nesting depth.
+    const char *block_start;         // The start of the current block (NULL if no tokens yet).
+    const char *block_end;           // The end of the most recent token of the current block.
+    struct lxl_block_fingerprint *blocks;  // Caller-allocated array of block fingerprints (may be NULL).
+    size_t block_capacity;           // The capacity of the `blocks` array.
+    size_t block_count;              // The number of blocks found (may exceed `block_capacity`).
+};
+
+// Initialise a hasher with the given seed.
+void lxl_hasher_init(struct lxl_hasher *hasher, uint64_t seed);
+// Feed `length` bytes into the hasher.
+void lxl_hasher_update(struct lxl_hasher *hasher, const void *data, size_t length);
+// Return the hash of all data fed to the hasher so far. The hasher can still be updated afterwards.
+struct lxl_hash128 lxl_hasher_final(const struct lxl_hasher *hasher);
+// Return whether two hashes are equal.
+bool lxl_hash128_equal(struct lxl_hash128 a, struct lxl_hash128 b);
+
+// Create a new fingerprinter with block fingerprints disabled.
+struct lxl_fingerprinter lxl_fingerprinter_new(void);
+// Enable block fingerprints. A block runs from the token after the previous block up to and including
+// the `close_type` token which closes the top-level `open_type` token. Block fingerprints are written to
+// `blocks` (at most `capacity` of them, but all blocks are counted in `.block_count`).
+void lxl_fingerprinter_set_blocks(struct lxl_fingerprinter *fingerprinter, int open_type, int close_type,
+                                  struct lxl_block_fingerprint *blocks, size_t capacity);
+// Add a token to the fingerprint. Trivia and end tokens are ignored.
+void lxl_fingerprinter_add_token(struct lxl_fingerprinter *fingerprinter, struct lxl_token token);
+// Return the fingerprint of all tokens added so far. Any trailing tokens after the last top-level block
+// are recorded as a final block.
+struct lxl_hash128 lxl_fingerprinter_finish(struct lxl_fingerprinter *fingerprinter);
+
+// Lex the remaining tokens of the lexer and return their fingerprint. The lexer's line ending type
+// is treated as trivia.
+struct lxl_hash128 lxl_lexer_fingerprint(struct lxl_lexer *lexer, struct lxl_fingerprinter *fingerprinter);
+
+// END LEXEL FINGERPRINTS.
+
+
+// LEXEL PACKED TOKENS.
+
+// A compressed in-memory container for tokens. Each token is encoded as a sequence of variable-length
+// integers (varints): its type, the gap between the end of the previous token and its start, its length,
+// the number of lines since the previous token and a column correction (usually zero). Typical tokens take
+// 4--5 bytes instead of `sizeof(struct lxl_token)`. Every `skip_interval` tokens, the decoder state is
+// recorded in a skip index to allow random access without decoding from the start. Locations are stored
+// exactly, including unknown locations ({-1, -1}, e.g. from a token stream without locations) and lines
+// which go backwards.
+// Both the byte buffer and the skip index are allocated by the caller.
+
+// Decoder state recorded at regular intervals in the token stream.
+struct lxl_packed_skip {
+    size_t byte_offset;           // The offset into the data buffer of the token.
+    size_t prev_start;            // The source offset of the start of the previous token.
+    size_t prev_end;              // The source offset of the end of the previous token.
+    struct lxl_location prev_loc; // The location of the previous token.
+};
+
+// The packed token container.
+struct lxl_packed_tokens {
+    unsigned char *data;             // The encoded tokens.
+    size_t capacity;                 // The capacity of the `data` buffer.
+    size_t size;                     // The number of bytes used in the `data` buffer.
+    struct lxl_packed_skip *skips;   // The skip index (may be NULL).
+    size_t skip_capacity;            // The capacity of the skip index.
+    size_t skip_interval;            // The number of tokens between skip entries.
+    size_t token_count;              // The number of tokens in the container.
+    const char *source_start;        // The start of the source the tokens point into.
+    struct lxl_packed_skip state;    // Encoder state after the last token.
+    bool overflowed;                 // Was a push unsuccessful (data or skip index full)?
+};
+
+// Sequential decoder over a packed token container.
+struct lxl_packed_cursor {
+    const struct lxl_packed_tokens *tokens;  // The container being decoded.
+    size_t index;                            // The index of the next token.
+    struct lxl_packed_skip state;            // Decoder state before the next token.
+};
+
+// Create an empty packed token container for tokens pointing into the source starting at `source_start`.
+// `skips` may be NULL to disable the skip index (random access then decodes from the start).
+struct lxl_packed_tokens lxl_packed_tokens_new(const char *source_start, void *data, size_t capacity,
+                                               struct lxl_packed_skip *skips, size_t skip_capacity,
+                                               size_t skip_interval);
+// Append a token to the container and return whether it could be added. Tokens must be added in source
+// order (i.e. in the order the lexer emits them).
+bool lxl_packed_tokens_push(struct lxl_packed_tokens *tokens, struct lxl_token token);
+// Lex the remaining tokens of the lexer into the container (including the final end token) and return
+// the number of tokens added. If the container becomes full, the lexer is left just after the last token
+// added.
+size_t lxl_packed_tokens_push_lexer(struct lxl_packed_tokens *tokens, struct lxl_lexer *lexer);
+
+// Create a cursor positioned at the first token.
+struct lxl_packed_cursor lxl_packed_cursor_new(const struct lxl_packed_tokens *tokens);
+// Create a cursor positioned at the token with the given index, using the skip index.
+struct lxl_packed_cursor lxl_packed_cursor_at(const struct lxl_packed_tokens *tokens, size_t index);
+// Decode the next token into OUT_token and return true, or return false if there are no more tokens.
+bool lxl_packed_cursor_next(struct lxl_packed_cursor *cursor, struct lxl_token *OUT_token);
+
+// END LEXEL PACKED TOKENS.
+
+
+// LEXEL CHECKPOINTS.
+
+// A checkpoint captures the state of a lexer between two tokens. Restoring a checkpoint (to the same lexer
+// or another lexer with the same configuration and input) makes the lexer produce exactly the tokens it
+// would have produced after that point. A checkpoint table records checkpoints at regular intervals
+// during a full pass over the input, so that lexing can later start from near any offset without
+// landing in the middle of a comment or string. Checkpoints contain no pointers, so tables can be
+// persisted alongside the input.
+// With `.offside_rule` enabled, a checkpoint holds the depth of the indent stack and the pending dedents
+// but not the stack itself: restoring it is only exact if the lexer's indent stack still holds the widths
+// it held when the checkpoint was saved (as it does if it has not lexed since, or the depth was 0).
+// Checkpoint tables only record checkpoints where the indent stack is empty, so theirs are always exact.
+
+// The state of a lexer between two tokens.
+struct lxl_checkpoint {
+    size_t offset;                 // The offset of the lexer's cursor from the start of its input.
+    struct lxl_location pos;       // The position (line, column) of the cursor.
+    int previous_token_type;       // The type of the most recently lexed token.
+    enum lxl_lexer_status status;  // The status of the lexer.
+    int bracket_depth;             // The bracket nesting depth.
+    int line_indent;               // The indentation of the line the next token starts (or LXL_INDENT_*).
+    int indent_depth;              // The number of indentation levels on the indent stack.
+    int pending_dedents;           // The number of dedent tokens still to be emitted.
+};
+
+// A table of checkpoints ordered by offset.
+struct lxl_checkpoint_table {
+    struct lxl_checkpoint *checkpoints;  // Caller-allocated array of checkpoints.
+    size_t capacity;                     // The capacity of the `checkpoints` array.
+    size_t count;                        // The number of checkpoints recorded.
+    size_t interval;                     // The minimum number of bytes between checkpoints.
+};
+
+// Save the state of the lexer. The lexer should be between tokens (i.e. not in a hook).
+struct lxl_checkpoint lxl_lexer_save_checkpoint(struct lxl_lexer *lexer);
+// Restore the lexer to a previously saved state.
+void lxl_lexer_restore_checkpoint(struct lxl_lexer *lexer, struct lxl_checkpoint checkpoint);
+
+// Create an empty checkpoint table which records a checkpoint at least every `interval` bytes.
+struct lxl_checkpoint_table lxl_checkpoint_table_new(struct lxl_checkpoint *checkpoints, size_t capacity,
+                                                     size_t interval);
+// Record a checkpoint for the lexer if it has advanced at least `interval` bytes since the last checkpoint
+// (or if the table is empty) and its indent stack is empty. Return false if the table is full.
+bool lxl_checkpoint_table_record(struct lxl_checkpoint_table *table, struct lxl_lexer *lexer);
+// Lex all the remaining tokens, recording checkpoints along the way, and return the number of tokens lexed
+// (including the end token). Return 0 if the table filled up before the end of the input.
+size_t lxl_lexer_build_checkpoints(struct lxl_lexer *lexer, struct lxl_checkpoint_table *table);
+// Return the last checkpoint at or before `offset`, or NULL if there is none.
+const struct lxl_checkpoint *lxl_checkpoint_table_find(const struct lxl_checkpoint_table *table, size_t offset);
+
+// END LEXEL CHECKPOINTS.
+
+
+// LEXEL SEMANTIC TOKENS.
+
+// An encoder for the Language Server Protocol (LSP) `semanticTokens` format. Each token is encoded as five
+// unsigned integers: line delta, start character delta, length, token type and token modifiers, with
+// characters counted in UTF-16 code units (the LSP default). Columns are computed incrementally while
+// scanning the source between tokens, so each byte is visited once. Tokens spanning multiple lines are
+// split into one entry per line. The source is assumed to be valid UTF-8.
+
+// The semantic token encoder.
+struct lxl_semantic_encoder {
+    uint32_t *data;                   // Caller-allocated output array.
+    size_t capacity;                  // The capacity of the output array (in uint32_t elements).
+    size_t size;                      // The number of elements written.
+    const int *legend_types;          // Map from lexel token types to legend indices (-1 to skip the token).
+    int legend_type_count;            // The length of the `legend_types` map.
+    const uint32_t *legend_modifiers; // Map from lexel token types to modifier bitsets (may be NULL).
+    const char *scan;                 // The point up to which the source has been scanned.
+    uint32_t scan_line;               // The line at `scan`.
+    uint32_t scan_column;             // The UTF-16 column at `scan`.
+    uint32_t prev_line;               // The line of the previously encoded token.
+    uint32_t prev_column;             // The UTF-16 column of the previously encoded token.
+    bool overflowed;                  // Was an encoding unsuccessful (output full)?
+};
+
+// Create an encoder for tokens lexed from the source starting at `source_start`. Tokens whose types are
+// negative, not less than `legend_type_count`, or mapped to -1 are not encoded.
+struct lxl_semantic_encoder lxl_semantic_encoder_new(const char *source_start, uint32_t *data, size_t capacity,
+                                                     const int *legend_types, int legend_type_count,
+                                                     const uint32_t *legend_modifiers);
+// Encode the token and return whether it could be written. Tokens must be added in source order.
+bool lxl_semantic_encoder_add_token(struct lxl_semantic_encoder *encoder, struct lxl_token token);
+// Lex the remaining tokens from the lexer into the encoder and return the number of elements written,
+// or 0 if the output overflowed.
+size_t lxl_semantic_encoder_encode_lexer(struct lxl_semantic_encoder *encoder, struct lxl_lexer *lexer);
+
+// END LEXEL SEMANTIC TOKENS.
+
+
+// LEXEL TOKEN INDEX.
+
+// An index over an array of tokens (in source order) which answers "which token covers byte offset X?"
+// in O(log n). The token start offsets are stored in Eytzinger (breadth-first) order, so the first few
+// levels of each search share the same cache lines and the search loop is branch-free.
+// NOTE: offsets are stored as 32-bit integers, so sources are limited to 4 GiB.
+
+// Value returned by token index lookups when no token covers the offset.
+#define LXL_NO_TOKEN_INDEX ((ptrdiff_t)-1)
+
+// The token index.
+struct lxl_token_index {
+    const struct lxl_token *tokens;  // The indexed tokens.
+    size_t count;                    // The number of indexed tokens.
+    const char *source_start;        // The start of the source the tokens point into.
+    uint32_t *keys;                  // Token start offsets in Eytzinger order (1-based; keys[0] unused).
+    uint32_t *ranks;                 // The index into `tokens` of each key.
+};
+
+// Build an index over `count` tokens in a single pass. The index arrays are allocated in the region.
+// Return false if the region has insufficient space.
+bool lxl_token_index_build(struct lxl_token_index *index, const struct lxl_token *tokens, size_t count,
+                           const char *source_start, struct lxl_region *region);
+// Return the index of the token covering `offset` or LXL_NO_TOKEN_INDEX if it lies between tokens.
+ptrdiff_t lxl_token_index_find(const struct lxl_token_index *index, size_t offset);
+// Look up many offsets at once, writing the results to OUT_indices. This interleaves the searches to hide
+// memory latency and is faster than repeated calls to `lxl_token_index_find()` for large batches.
+void lxl_token_index_find_batch(const struct lxl_token_index *index, const size_t *offsets, size_t count,
+                                ptrdiff_t *OUT_indices);
+
+// END LEXEL TOKEN INDEX.
+
+
+// LEXEL BUDGETED LEXING.
+
+// Budgeted lexing stops cleanly after a given number of bytes or tokens, or when a deadline passes, even in
+// the middle of a long comment or string. The input is lexed in slices: each token is lexed as if the input
+// ended at the end of the current slice, and a token which reaches too close to the end of the slice is
+// un-lexed and retried with a larger slice. Block comments and strings are not retried: their scan pauses
+// near the end of the slice (see `.scan_pause`), and the next slice resumes it. The deadline is checked
+// whenever lexing moves on to another slice, whether or not a token has been produced.
+// When the budget runs out, the lexer is left at the start of the next token, or in a paused comment or
+// string, so lexing can be resumed by another call (or by `lxl_lexer_next_token()`). The lexer also keeps
+// the size of a slice which was too small for its next token (`.budget_slice`), so that resumed calls do
+// not start that token over with a small slice.
+// Tokens are lexed speculatively without hooks or rule profile updates; if the lexer has any, a token
+// which is kept is lexed again with them, so each hook runs once per token produced.
+// NOTE: the deadline is not a hard bound. Other tokens cannot be interrupted, so a long one (e.g. a word)
+// can overrun the deadline by up to about the time already spent lexing it.
+
+// Why budgeted lexing stopped.
+enum lxl_budget_status {
+    LXL_BUDGET_FINISHED,   // The lexer reached the end of its input.
+    LXL_BUDGET_FULL,       // The output array is full.
+    LXL_BUDGET_EXHAUSTED,  // The byte or token budget was used up.
+    LXL_BUDGET_EXPIRED,    // The deadline passed.
+};
+
+// Limits for budgeted lexing.
+struct lxl_budget {
+    size_t max_bytes;                   // The maximum number of bytes to consume (0 for no limit).
+    size_t max_tokens;                  // The maximum number of tokens to produce (0 for no limit).
+    bool (*expired)(void *user_data);   // Deadline check, called periodically (may be NULL).
+    void *user_data;                    // Argument passed to `expired()`.
+    size_t poll_bytes;                  // Bytes lexed between deadline checks (0 for LXL_BUDGET_POLL_BYTES).
+};
+
+// The outcome of budgeted lexing.
+struct lxl_budget_result {
+    size_t token_count;              // The number of tokens written.
+    size_t byte_count;               // The number of bytes consumed.
+    enum lxl_budget_status status;   // Why lexing stopped.
+};
+
+// Lex tokens into the `tokens` array as with `lxl_lexer_tokenize()`, stopping when the budget runs out.
+struct lxl_budget_result lxl_lexer_tokenize_budgeted(struct lxl_lexer *lexer, struct lxl_token *tokens,
+                                                     size_t capacity, struct lxl_budget budget);
+
+// END LEXEL BUDGETED LEXING.
+
+
+// LEXEL RULE PROFILES.
+
+// A rule profile adapts the order in which the lexer tries its puncts and keywords to the input. The
+// candidates are grouped by their first byte, so only those starting with the current byte are tried, and
+// each group is periodically re-ordered so that the most frequently matched candidates are tried first.
+// Puncts where one is a prefix of the other keep their relative order (as do duplicate keywords), so the
+// lexer produces exactly the same tokens as without the profile.
+// The hit counts can be exported after a training run and imported at startup.
+// NOTE: the profile is updated while lexing, so it must not be shared between lexers on different threads.
+// It must be rebuilt if the lexer's puncts or keywords change.
+
+// The profile for a lexer's puncts and keywords.
+struct lxl_rule_profile {
+    const char *const *puncts;    // The profiled puncts (the lexer's `.puncts`).
+    const char *const *keywords;  // The profiled keywords (the lexer's `.keywords`).
+    uint16_t punct_count;
+    uint16_t keyword_count;
+    uint32_t *punct_hits;         // The number of matches of each punct (since the counts were last aged).
+    uint32_t *keyword_hits;       // The number of matches of each keyword.
+    uint16_t *punct_order;        // Punct indices, grouped by first byte, in the order they are tried.
+    uint16_t *keyword_order;      // Keyword indices, grouped by first byte, in the order they are tried.
+    uint16_t punct_groups[257];   // `punct_order[punct_groups[c]..punct_groups[c+1]]` start with byte c.
+    uint16_t keyword_groups[257]; // As above, for keywords.
+    uint32_t interval;            // The number of tokens between re-orderings (0 to never re-order).
+    uint32_t countdown;           // The number of tokens until the next re-ordering.
+};
+
+// Build a profile for the lexer's puncts and keywords (in their declared order, with all counts zero) and
+// attach it to the lexer. The profile re-orders itself every `interval` tokens. The arrays are allocated in
+// the region. Return false if the region has insufficient space or there are more than UINT16_MAX puncts
+// or keywords.
+bool lxl_rule_profile_init(struct lxl_rule_profile *profile, struct lxl_lexer *lexer, uint32_t interval,
+                           struct lxl_region *region);
+// Re-order each group by hit count, then halve the counts so that recent matches weigh more.
+void lxl_rule_profile_reorder(struct lxl_rule_profile *profile);
+// Return the number of counts in an exported profile.
+size_t lxl_rule_profile_size(const struct lxl_rule_profile *profile);
+// Write the hit counts (puncts, then keywords) to OUT_counts, which must hold `lxl_rule_profile_size()`
+// counts.
+void lxl_rule_profile_export(const struct lxl_rule_profile *profile, uint32_t *OUT_counts);
+// Load hit counts written by `lxl_rule_profile_export()` and re-order. Return false (leaving the profile
+// unchanged) if `count` does not match the profile's size.
+bool lxl_rule_profile_import(struct lxl_rule_profile *profile, const uint32_t *counts, size_t count);
+
+// END LEXEL RULE PROFILES.
+
+
+// LEXEL RULE INDEX.
+
+// A rule index holds lookup tables computed from a lexer's configuration (or given as static data, as by the
+// presets), so that the lexer need not try each of its rules in turn. Words (LXL_LEX_WORD) are scanned
+// without checking the rules at bytes which cannot start whitespace, a comment, a string or a punct, and
+// puncts and keywords are only tried if they start with the current byte.
+// The puncts and keywords must be sorted by their first byte (keeping each punct before any puncts which are
+// its prefixes). The index is never modified, so it can be shared between lexers on different threads, but
+// it must be rebuilt if the lexer's configuration changes. A rule profile takes precedence over the index
+// for puncts and keywords.
+
+// Rule lookup tables for a lexer's configuration.
+struct lxl_rule_index {
+    uint64_t reserved_bytes[4];    // Bit c is set if byte c may start anything other than a word.
+    uint16_t punct_groups[257];    // `puncts[punct_groups[c]..punct_groups[c+1]]` start with byte c.
+    uint16_t keyword_groups[257];  // As above, for keywords.
+};
+
+// Build an index for the lexer's configuration. Return false if its puncts or keywords are not sorted by
+// their first byte, include an empty string or number more than UINT16_MAX.
+bool lxl_rule_index_init(struct lxl_rule_index *index, const struct lxl_lexer *lexer);
+
+// END LEXEL RULE INDEX.
+
+
+// LEXEL STRUCTURAL INDEX.
+
+// A structural index is built by a first pass over the whole input, 64 bytes at a time (using SSE2 where
+// available). It records bitmasks with one bit per byte, where bit i of `mask[b]` is byte `64*b + i`.
+// A lexer with the index attached (`.structural_index`) skips runs of whitespace a word at a time, counting
+// lines with the LF mask, instead of examining each byte. Quotes are indexed if the lexer has a single
+// string delimiter whose opener and closer are the same character (e.g. JSON): the mask holds the quotes
+// not escaped by an odd run of escape characters, so the lexer finds the end of a string at the next quote
+// bit. Strings the index cannot describe as the lexer would lex them (with an escaped opener, or an LF or
+// NUL before the closer) are lexed byte by byte, so the index does not change the tokens produced.
+// That is all the index is used for: it does not record where tokens start, and tokens are still found
+// byte by byte. It pays off for input with long strings (JSON with strings of about 80 bytes lexes about
+// 1.5 times as fast, counting the build), but not for code, whose whitespace runs are short; the
+// bench/bench_structural_index.c program measures both.
+// The index describes the bytes of the input when it was built, and a lexer only checks that it is for the
+// same `start`: rebuild it whenever the input is modified.
+
+// The number of bytes per block (one mask word).
+#define LXL_STRUCTURAL_BLOCK 64
+
+// The structural index of an input.
+struct lxl_structural_index {
+    const char *start;   // The start of the indexed input.
+    size_t length;       // The length of the indexed input.
+    size_t block_count;  // The number of words in each mask.
+    uint64_t *blank;     // Non-LF whitespace bytes.
+    uint64_t *lf;        // LF bytes.
+    uint64_t *quotes;    // Unescaped quote bytes (NULL if strings are not indexed).
+};
+
+// Index the lexer's input (from `lexer->start` to `lexer->end`) and attach the index to the lexer. The masks
+// are allocated in the region. Return false if the region has insufficient space.
+// Build it again after modifying the input.
+bool lxl_structural_index_build(struct lxl_structural_index *index, struct lxl_lexer *lexer,
+                                struct lxl_region *region);
+
+// END LEXEL STRUCTURAL INDEX.
+
+
+// LEXEL BRACKET PAIRS.
+
+// Bracket pairing computes the partner of every bracket token in a token array, so that e.g. a parser can
+// skip a function body in O(1). Brackets are punct tokens whose value is the opener or closer of one of
+// a list of bracket pairs (such as the lexer's `.bracket_delims`). Pairing uses a single explicit stack of
+// open brackets, allocated in a region. A closer which does not match the innermost open bracket closes
+// the nearest enclosing open bracket of its kind (flagging the brackets left open inside it), or is flagged
+// itself if there is none. The number of open brackets of each kind is kept, so that such a closer is found
+// to be unbalanced without searching the stack, and pairing takes amortized constant time per token.
+
+// Partner value for tokens which are not brackets.
+#define LXL_BRACKET_NONE ((ptrdiff_t)-1)
+// Partner value for unbalanced brackets.
+#define LXL_BRACKET_UNMATCHED ((ptrdiff_t)-2)
+
+// An entry on the stack of open brackets.
+struct lxl_open_bracket {
+    size_t token_index;  // The index of the opener token.
+    size_t pair_index;   // The index of its pair in the bracket list.
+};
+
+// An incremental bracket pairer, which is fed tokens in order (e.g. while lexing).
+struct lxl_bracket_pairer {
+    const struct lxl_delim_pair *brackets;  // The bracket pairs (terminated by {NULL, NULL}).
+    ptrdiff_t *partners;      // The partner of each token (a token index or one of the values above).
+    size_t capacity;          // The capacity of `partners` (and the stack).
+    size_t token_count;       // The number of tokens added so far.
+    struct lxl_open_bracket *stack;  // The open brackets, innermost last.
+    size_t depth;             // The number of open brackets.
+    size_t *open_counts;      // The number of open brackets of each pair.
+    size_t unmatched_count;   // The number of unbalanced brackets found so far.
+};
+
+// Create a pairer for up to `capacity` tokens, writing partners to `partners`. The stack and open counts are
+// allocated in the region. Return false (leaving the region unchanged) if the region has insufficient space.
+bool lxl_bracket_pairer_init(struct lxl_bracket_pairer *pairer, const struct lxl_delim_pair *brackets,
+                             ptrdiff_t *partners, size_t capacity, struct lxl_region *region);
+// Add the next token. Return false if the pairer is full.
+bool lxl_bracket_pairer_add(struct lxl_bracket_pairer *pairer, struct lxl_token token);
+// Flag the brackets which are still open and return the total number of unbalanced brackets.
+size_t lxl_bracket_pairer_finish(struct lxl_bracket_pairer *pairer);
+
+// Pair the brackets in an array of tokens, writing the partner of each token to OUT_partners and the number
+// of unbalanced brackets to OUT_unmatched_count. Return false if the region has insufficient space.
+bool lxl_tokens_pair_brackets(const struct lxl_token *tokens, size_t count,
+                              const struct lxl_delim_pair *brackets, ptrdiff_t *OUT_partners,
+                              size_t *OUT_unmatched_count, struct lxl_region *region);
+// Lex up to `capacity` tokens into `tokens` as with `lxl_lexer_tokenize()`, pairing brackets as they are
+// lexed. Lexing also stops when the pairer is full. Call `lxl_bracket_pairer_finish()` once the input is
+// exhausted.
+size_t lxl_lexer_tokenize_paired(struct lxl_lexer *lexer, struct lxl_token *tokens, size_t capacity,
+                                 struct lxl_bracket_pairer *pairer);
+
+// END LEXEL BRACKET PAIRS.
+
+
+// LEXEL BALANCED SKIPPING.
+
+// Skip to the end of a bracketed block without lexing its tokens, e.g. to parse function bodies lazily.
+// The lexer should be just after the block's opener. The input is scanned 16 bytes at a time (using SSE2
+// where available) for the first bytes of the opener, closer, comment openers and string openers; only
+// these candidates are examined. Comments and strings are skipped as by the lexer, so brackets inside them
+// are ignored. Lines are counted along the way. On success, the lexer is left just after the matching
+// closer and true is returned. If the input ends first (or inside a comment or string), the lexer is left
+// unchanged and false is returned.
+// NOTE: as with LXL_LEX_WORD, strings and comments are recognised wherever they start, even mid-word.
+bool lxl_lexer_skip_balanced(struct lxl_lexer *lexer, const char *open, const char *close);
+
+// END LEXEL BALANCED SKIPPING.
+
+
+// LEXEL VALIDATION.
+
+// Validation checks whether the input lexes without errors, without producing tokens. It applies the same
+// rules as `lxl_lexer_next_token()` but skips token construction, keyword lookup and hooks, and only tracks
+// the previous token type when line endings are emitted (where it affects lexing). As when counting tokens,
+// words, puncts and unprefixed numbers, which cannot be errors, are skipped from their first byte without
+// telling integers from floats; comments, strings, prefixed numbers and anything else which may be an
+// error are lexed in full. bench/bench_validate.c compares validation with lexing every token.
+
+// The outcome of validation.
+struct lxl_validation {
+    size_t error_count;                   // The number of errors found.
+    enum lxl_lex_error first_error;       // The first error found (LXL_LERR_OK if there were none).
+    struct lxl_location first_error_loc;  // The location of the first error (as for its error token).
+};
+
+// Lex the rest of the input, counting errors. If `stop_at_first_error` is true, stop after the first
+// error, leaving the lexer just after it (so validation can be resumed); otherwise, the lexer is finished.
+struct lxl_validation lxl_lexer_validate(struct lxl_lexer *lexer, bool stop_at_first_error);
+
+// END LEXEL VALIDATION.
+
+
+// LEXEL TOKEN COUNTING.
+
+// Counting finds where the rest of the input's tokens end without storing them or working out their types,
+// so that a token buffer of exactly the right size can be allocated before lexing the tokens in a second
+// pass. Words, puncts and unprefixed numbers are found from their first byte, without keyword lookup or
+// telling integers from floats, and the location is only kept up to date for the comments, strings and
+// other tokens which need the full rules. Without the offside rule (which needs the location of every
+// token), counting takes about a third of the time of lexing. Even so, the second pass costs as much as
+// lexing into a growing buffer and copying it, so tokenizing exactly is slower than that: it is for
+// callers which need exact allocation (e.g. from a fixed region), not for speed. bench/bench_exact.c
+// measures each of these.
+
+// Tokens stored as parallel arrays, so that e.g. scanning the token types does not load their values.
+struct lxl_token_columns {
+    const char **starts;         // The start of each token.
+    const char **ends;           // The end of each token.
+    struct lxl_location *locs;   // The location of each token (may be NULL to not store locations).
+    int *token_types;            // The type of each token.
+    size_t count;                // The number of tokens stored.
+    size_t capacity;             // The number of tokens which can be stored.
+};
+
+// Count the tokens `lxl_lexer_tokenize()` would produce from the rest of the input (not including the end
+// token) and leave the lexer finished. If non-NULL, `OUT_trivia_count` is set to the number of these which
+// are line endings and `OUT_error_count` to the number which are errors. As hooks are not run, the count
+// may differ if the lexer's hooks change the tokens lexed.
+size_t lxl_lexer_count_tokens(struct lxl_lexer *lexer, size_t *OUT_trivia_count, size_t *OUT_error_count);
+
+// Allocate columns for `capacity` tokens from `region`, with locations only if `with_locations` is true.
+// Return false (leaving the region unchanged) if the region is too small.
+bool lxl_token_columns_init(struct lxl_token_columns *columns, size_t capacity, bool with_locations,
+                            struct lxl_region *region);
+// Lex tokens into `columns` after those already stored until it is full or the lexer is finished.
+// Return the number of tokens added.
+size_t lxl_lexer_tokenize_columns(struct lxl_lexer *lexer, struct lxl_token_columns *columns);
+// Count the rest of the input's tokens, allocate columns of exactly that size from `region` and lex the
+// tokens into them. Return false (leaving the lexer and region unchanged) if the region is too small.
+// With the offside rule, counting uses a temporary copy of the indent stack allocated from `region`.
+bool lxl_lexer_tokenize_exact(struct lxl_lexer *lexer, struct lxl_token_columns *OUT_columns,
+                              bool with_locations, struct lxl_region *region);
+
+// END LEXEL TOKEN COUNTING.
+
+
+// LEXEL RECORD BATCHES.
+
+// Record batches lex many short records (e.g. log lines) with the same configuration in one call, into one
+// flat token array. Each record is lexed as a separate input, so token locations, indentation and bracket
+// depth start afresh for each record, but the lexer is only copied once per call. The bytes which may end a
+// word are also found once per call, so that words are scanned with a table lookup per byte instead of
+// checking every rule (as with the rule index of a preset); bench/bench_records.c measures the difference.
+
+// The tokens of a record, as indices into the token array of a batch.
+struct lxl_record_range {
+    size_t begin;    // The index of the record's first token.
+    size_t end;      // One past the index of the record's last token.
+    bool truncated;  // Did the record have more tokens than the batch can hold?
+};
+
+// Caller-allocated output arrays for batch lexing. Records and tokens are added after those already stored.
+struct lxl_record_batch {
+    struct lxl_token *tokens;          // The tokens of all records (without their end tokens).
+    size_t token_count;                // The number of tokens stored.
+    size_t token_capacity;             // The number of tokens which can be stored.
+    struct lxl_record_range *records;  // The token range of each record.
+    size_t record_count;               // The number of records stored.
+    size_t record_capacity;            // The number of records which can be stored.
+};
+
+// Lex the newline-delimited records in [start, end) into `batch` using the configuration of `config`
+// (as for `lxl_lexer_from_config()`). Line feeds are not part of the records, and the last record need not
+// end with one. Lexing stops before a record whose tokens do not fit in the batch, so that the caller can
+// empty it and resume; a record which could never fit (the batch holds no tokens) is stored cut off at
+// `token_capacity` tokens with its range marked as truncated instead. Hooks only run for records which are
+// stored, up to the last token stored. With the offside rule, the indent stack of `config` is used, so
+// concurrent calls need configurations with separate stacks. Return a pointer to the start of the first record not lexed (`end`
+// if all were lexed).
+const char *lxl_lexer_tokenize_lines(const struct lxl_lexer *config, const char *start, const char *end,
+                                     struct lxl_record_batch *batch);
+// Lex `record_count` records stored one after another from `data`, where `lengths` gives the length of each,
+// into `batch` as for `lxl_lexer_tokenize_lines()`. Return the number of records lexed.
+size_t lxl_lexer_tokenize_records(const struct lxl_lexer *config, const char *data, const size_t *lengths,
+                                  size_t record_count, struct lxl_record_batch *batch);
+
+// END LEXEL RECORD BATCHES.
+
+
+// LEXEL PRESETS.
+
+// Presets are lexers configured for common languages, with their tables (including a rule index) as static
+// data. Words use LXL_LEX_WORD and the token types below. Each punct and keyword has a type of its own:
+// the punct of type t is `lexer.puncts[t - LXL_PRESET_PUNCT]` and the keyword of type t is
+// `lexer.keywords[t - LXL_PRESET_KEYWORD]`. The configuration can be changed after creating the lexer,
+// but the rule index (`.rule_index`) must then be rebuilt or set to NULL. Presets with number literals set
+// `.extended_floats`, so that an unprefixed integer with an exponent (e.g. "1e5") is a float and float
+// suffixes are matched.
+//
+// LXL_LANG_C: C (and C-family) source. Comments are skipped; "..." is a string and '...' a character
+//     literal; integers may have a 0x or 0b prefix and integer or float suffixes (e.g. 10UL, 1.5f).
+//     Preprocessor lines are lexed as ordinary tokens, and string prefixes (e.g. L"...") are words. Floats
+//     must start with a digit (".5" lexes as "." and 5), and there are no hexadecimal floats.
+// LXL_LANG_JSON: JSON. Numbers may start with '-'. Exponents must use a lowercase 'e'.
+// LXL_LANG_SQL: SQL. '...' is a string and "..." a quoted name (both may span lines); a doubled quote
+//     lexes as two adjacent strings. Keywords are recognised in upper or lower case (e.g. SELECT, select)
+//     and both spellings have the same type.
+// LXL_LANG_INI: INI and TOML-like configuration files. Comments start with '#' or ';'. Line endings are
+//     emitted. Strings use '...' or "..." (triple-quoted strings lex as three strings). Numbers may have a
+//     sign, a 0x, 0o or 0b prefix and '_' separators.
+// LXL_LANG_SHELL: POSIX shell words, operators and reserved words. Line endings are emitted. Quoted strings
+//     ('...', "..." and `...`) may span lines. There are no number tokens. A '#' starts a comment even
+//     within a word.
+
+// The languages with presets.
+enum lxl_language {
+    LXL_LANG_C,
+    LXL_LANG_JSON,
+    LXL_LANG_SQL,
+    LXL_LANG_INI,
+    LXL_LANG_SHELL,
+};
+
+// Token types used by the presets.
+enum lxl_preset_token_type {
+    LXL_PRESET_WORD,           // Identifiers and other words.
+    LXL_PRESET_INT,            // Integer literals.
+    LXL_PRESET_FLOAT,          // Floating-point literals.
+    LXL_PRESET_STRING,         // String literals.
+    LXL_PRESET_CHAR,           // Character literals (C).
+    LXL_PRESET_QUOTED_NAME,    // Quoted identifiers (SQL).
+    LXL_PRESET_PUNCT = 64,     // The type of the first punct.
+    LXL_PRESET_KEYWORD = 128,  // The type of the first keyword.
+};
+
+// Create a lexer for the given input configured for `language`. `end` may be NULL as for `lxl_lexer_new()`.
+struct lxl_lexer lxl_lexer_preset(enum lxl_language language, const char *start, const char *end);
+
+// END LEXEL PRESETS.
+
+
+// LEXEL TOKEN SETS.
+
+// A token set is a bitset of token types, for testing whether a token is one of several types (e.g. in
+// a parser) with a single lookup instead of a chain of comparisons. Only the types 0 to
+// LXL_TOKEN_SET_SIZE-1 can be members; negative types (errors, end tokens, line endings and
+// LXL_TOKEN_UNINIT) and larger types are never members and are ignored when adding or removing.
+// Sets are plain structures, so they can be copied, compared with memcmp() and initialised statically:
+//     static const struct lxl_token_set statement_ends = LXL_TOKEN_SET(T_SEMICOLON, T_RBRACE);
+
+// The number of token types a set can hold (enough for the preset types).
+#define LXL_TOKEN_SET_SIZE 256
+
+struct lxl_token_set {
+    uint64_t bits[LXL_TOKEN_SET_SIZE / 64];  // Bit t % 64 of bits[t / 64] is set if type t is a member.
+};
+
+// An initialiser (a constant expression) for the set of up to 32 token types given as arguments, e.g.
+// `LXL_TOKEN_SET(T_PLUS, T_MINUS)`. Passing more than 32 types is a compile error.
+#define LXL_TOKEN_SET(...) {{ \
+        LXL__TOKEN_SET_WORD(0, __VA_ARGS__, LXL__TOKEN_SET_PADDING), \
+        LXL__TOKEN_SET_WORD(1, __VA_ARGS__, LXL__TOKEN_SET_PADDING), \
+        LXL__TOKEN_SET_WORD(2, __VA_ARGS__, LXL__TOKEN_SET_PADDING), \
+        LXL__TOKEN_SET_WORD(3, __VA_ARGS__, LXL__TOKEN_SET_PADDING), \
+    }}
+// An initialiser for the empty set.
+#define LXL_TOKEN_SET_EMPTY {{0, 0, 0, 0}}
+
+// The bit for type t within word w of a set (0 if t is not in that word or is out of range).
+#define LXL__TOKEN_SET_BIT(w, t) ((uint64_t)((unsigned)(t) / 64 == (w)) << ((unsigned)(t) % 64))
+#define LXL__TOKEN_SET_PADDING \
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, \
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+// Word w of a set of up to 32 types, followed by padding. The padding is expanded before the arguments are
+// split. `overflow` is the first padding value unless too many types were given, in which case the array
+// size is negative.
+#define LXL__TOKEN_SET_WORD(...) LXL__TOKEN_SET_WORD_N(__VA_ARGS__)
+#define LXL__TOKEN_SET_WORD_N(w, t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13, t14, t15, \
+                              t16, t17, t18, t19, t20, t21, t22, t23, t24, t25, t26, t27, t28, t29, t30, \
+                              t31, overflow, ...) ( \
+    LXL__TOKEN_SET_BIT(w, t0) | LXL__TOKEN_SET_BIT(w, t1) | LXL__TOKEN_SET_BIT(w, t2) \
+    | LXL__TOKEN_SET_BIT(w, t3) | LXL__TOKEN_SET_BIT(w, t4) | LXL__TOKEN_SET_BIT(w, t5) \
+    | LXL__TOKEN_SET_BIT(w, t6) | LXL__TOKEN_SET_BIT(w, t7) | LXL__TOKEN_SET_BIT(w, t8) \
+    | LXL__TOKEN_SET_BIT(w, t9) | LXL__TOKEN_SET_BIT(w, t10) | LXL__TOKEN_SET_BIT(w, t11) \
+    | LXL__TOKEN_SET_BIT(w, t12) | LXL__TOKEN_SET_BIT(w, t13) | LXL__TOKEN_SET_BIT(w, t14) \
+    | LXL__TOKEN_SET_BIT(w, t15) | LXL__TOKEN_SET_BIT(w, t16) | LXL__TOKEN_SET_BIT(w, t17) \
+    | LXL__TOKEN_SET_BIT(w, t18) | LXL__TOKEN_SET_BIT(w, t19) | LXL__TOKEN_SET_BIT(w, t20) \
+    | LXL__TOKEN_SET_BIT(w, t21) | LXL__TOKEN_SET_BIT(w, t22) | LXL__TOKEN_SET_BIT(w, t23) \
+    | LXL__TOKEN_SET_BIT(w, t24) | LXL__TOKEN_SET_BIT(w, t25) | LXL__TOKEN_SET_BIT(w, t26) \
+    | LXL__TOKEN_SET_BIT(w, t27) | LXL__TOKEN_SET_BIT(w, t28) | LXL__TOKEN_SET_BIT(w, t29) \
+    | LXL__TOKEN_SET_BIT(w, t30) | LXL__TOKEN_SET_BIT(w, t31) \
+    | (uint64_t)0 * sizeof(char[(overflow) == -1 ? 1 : -1]))
+
+// Return whether `token_type` is a member of the set, without branching.
+static inline bool lxl_token_set_contains(const struct lxl_token_set *set, int token_type) {
+    unsigned t = (unsigned)token_type;
+    uint64_t in_range = t < LXL_TOKEN_SET_SIZE;
+    // The index is masked so that out-of-range types read a valid word (and in_range clears the result).
+    uint64_t word = set->bits[(t / 64) % (LXL_TOKEN_SET_SIZE / 64)];
+    return (word >> (t % 64)) & in_range;
+}
+
+// Add `token_type` to the set (if it is in range).
+static inline void lxl_token_set_add(struct lxl_token_set *set, int token_type) {
+    unsigned t = (unsigned)token_type;
+    uint64_t in_range = t < LXL_TOKEN_SET_SIZE;
+    set->bits[(t / 64) % (LXL_TOKEN_SET_SIZE / 64)] |= in_range << (t % 64);
+}
+
+// Remove `token_type` from the set (if it is in range).
+static inline void lxl_token_set_remove(struct lxl_token_set *set, int token_type) {
+    unsigned t = (unsigned)token_type;
+    uint64_t in_range = t < LXL_TOKEN_SET_SIZE;
+    set->bits[(t / 64) % (LXL_TOKEN_SET_SIZE / 64)] &= ~(in_range << (t % 64));
+}
+
+// Return the union of two sets.
+static inline struct lxl_token_set lxl_token_set_union(struct lxl_token_set a, struct lxl_token_set b) {
+    for (int i = 0; i < LXL_TOKEN_SET_SIZE / 64; ++i) {
+        a.bits[i] |= b.bits[i];
+    }
+    return a;
+}
+
+// Return the intersection of two sets.
+static inline struct lxl_token_set lxl_token_set_intersection(struct lxl_token_set a,
+                                                              struct lxl_token_set b) {
+    for (int i = 0; i < LXL_TOKEN_SET_SIZE / 64; ++i) {
+        a.bits[i] &= b.bits[i];
+    }
+    return a;
+}
+
+// Return the types in `a` which are not in `b`.
+static inline struct lxl_token_set lxl_token_set_difference(struct lxl_token_set a, struct lxl_token_set b) {
+    for (int i = 0; i < LXL_TOKEN_SET_SIZE / 64; ++i) {
+        a.bits[i] &= ~b.bits[i];
+    }
+    return a;
+}
+
+// Return whether the set has no members.
+static inline bool lxl_token_set_is_empty(const struct lxl_token_set *set) {
+    uint64_t any = 0;
+    for (int i = 0; i < LXL_TOKEN_SET_SIZE / 64; ++i) {
+        any |= set->bits[i];
+    }
+    return any == 0;
+}
+
+// Lex the next token whose type is not in `skipped` (e.g. to drop tokens a parser has no use for). End and
+// error tokens are always returned, as their types are never members. Nor are line endings, indents and
+// dedents, so to drop them give them a non-negative type first, e.g. with `.line_ending_type`.
+struct lxl_token lxl_lexer_next_token_not_in(struct lxl_lexer *lexer, const struct lxl_token_set *skipped);
+// Skip tokens (including errors) until one whose type is in `targets` and return it, or return the end
+// token if the input ends first. This is for error recovery in parsers, e.g. skipping to the next ';' or '}'
+// after a syntax error. If non-NULL, OUT_skipped_count is set to the number of tokens skipped.
+struct lxl_token lxl_lexer_sync_to(struct lxl_lexer *lexer, const struct lxl_token_set *targets,
+                                   size_t *OUT_skipped_count);
+
+// END LEXEL TOKEN SETS.
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+
 // Implementation.
 
 #ifdef LEXEL_IMPLEMENTATION
@@ -615,6 +1800,9 @@ const char *lxl_error_message(enum lxl_lex_error error) {
     case LXL_LERR_UNCLOSED_STRING: return "Unclosed string-like literal";
     case LXL_LERR_INVALID_INTEGER: return "Inavlid integer";
     case LXL_LERR_INVALID_FLOAT: return "Invalid floating-point literal";
+    case LXL_LERR_INCONSISTENT_DEDENT: return "Dedent does not match any outer indentation level";
+    case LXL_LERR_INDENT_OVERFLOW: return "Indentation nested too deeply";
+    case LXL_LERR_TAB_INDENT: return "Tab in indentation";
     }
     LXL_UNREACHABLE();
     return NULL;  // Unreachable.
@@ -719,6 +1907,7 @@ struct lxl_lexer lxl_lexer_new(const char *start, const char *end) {
         .default_float_type = LXL_LERR_GENERIC,
         .default_float_base = 0,
         .default_exponent_marker = "e",
+        .extended_floats = false,
         .puncts = NULL,
         .punct_types = NULL,
         .keywords = NULL,
@@ -731,6 +1920,25 @@ struct lxl_lexer lxl_lexer_new(const char *start, const char *end) {
         .status = LXL_LSTS_READY,
         .emit_line_endings = false,
         .collect_line_endings = true,
+        .offside_rule = false,
+        .indent_type = LXL_TOKEN_INDENT,
+        .dedent_type = LXL_TOKEN_DEDENT,
+        .tab_policy = LXL_TABS_EXPAND,
+        .tab_width = 8,
+        .bracket_delims = NULL,
+        .indent_stack = NULL,
+        .indent_capacity = 0,
+        .indent_depth = 0,
+        .pending_dedents = 0,
+        .bracket_depth = 0,
+        .line_indent = LXL_INDENT_NONE,
+        .padded_input = false,
+        .rule_profile = NULL,
+        .structural_index = NULL,
+        .rule_index = NULL,
+        .scan_pause = NULL,
+        .paused_scan = {.delims = NULL},
+        .budget_slice = 0,
     };
 }
 
@@ -738,18 +1946,110 @@ struct lxl_lexer lxl_lexer_from_sv(struct lxl_string_view sv) {
     return lxl_lexer_new(sv.start, LXL_SV_END(sv));
 }
 
-struct lxl_token lxl_lexer_next_token(struct lxl_lexer *lexer) {
-    if (lxl_lexer_is_finished(lexer)) {
-        return lxl_lexer__create_end_token(lexer);
+struct lxl_lexer lxl_lexer_new_padded(const char *start, const char *end) {
+    LXL_ASSERT(end != NULL);
+    struct lxl_lexer lexer = lxl_lexer_new(start, end);
+    lexer.padded_input = true;
+    return lexer;
+}
+
+struct lxl_lexer lxl_lexer_from_config(const struct lxl_lexer *config, const char *start, const char *end) {
+    LXL_ASSERT(config != NULL);
+    LXL_ASSERT(start != NULL);
+    struct lxl_lexer lexer = *config;
+    lexer.padded_input = false;
+    lexer.rule_profile = NULL;
+    lexer.indent_stack = NULL;
+    lexer.indent_capacity = 0;
+    lxl_lexer_rebind(&lexer, start, end);
+    return lexer;
+}
+
+// Mark the bytes which may start something reserved (see `lxl_lexer__check_reserved()`) in a 256-bit set.
+static void lxl__reserved_table(const struct lxl_lexer *lexer, uint64_t OUT_table[4]) {
+    for (int i = 0; i < 4; ++i) OUT_table[i] = 0;
+    bool all = false;  // An empty opener or punct makes every byte reserved.
+#define LXL__MARK(c) (OUT_table[(unsigned char)(c) >> 6] |= (uint64_t)1 << ((unsigned char)(c) & 63))
+    for (const char *c = LXL_WHITESPACE_CHARS; *c != '\0'; ++c) LXL__MARK(*c);
+    if (LXL_HAS_FEATURE(LXL_FEATURE_LINE_COMMENTS) && lexer->line_comment_openers != NULL) {
+        for (const char *const *s = lexer->line_comment_openers; *s != NULL; ++s) {
+            all |= (*s)[0] == '\0';
+            LXL__MARK((*s)[0]);
+        }
     }
-    lxl_lexer__skip_whitespace(lexer);
-    if (lexer->error) {
-        return lxl_lexer__create_error_token(lexer);
+    const struct lxl_delim_pair *comments[] = {
+        lexer->nestable_comment_delims, lexer->unnestable_comment_delims,
+    };
+    for (int i = 0; i < 2 && LXL_HAS_FEATURE(LXL_FEATURE_BLOCK_COMMENTS); ++i) {
+        if (comments[i] == NULL) continue;
+        for (const struct lxl_delim_pair *d = comments[i]; d->opener != NULL; ++d) {
+            all |= d->opener[0] == '\0';
+            LXL__MARK(d->opener[0]);
+        }
     }
-    else if (lxl_lexer__is_at_end(lexer)) {
-        return lxl_lexer__create_end_token(lexer);
+    const struct lxl_delim_pair *strings[] = {
+        LXL_HAS_FEATURE(LXL_FEATURE_LINE_STRINGS) ? lexer->line_string_delims : NULL,
+        LXL_HAS_FEATURE(LXL_FEATURE_MULTILINE_STRINGS) ? lexer->multiline_string_delims : NULL,
+    };
+    for (int i = 0; i < 2; ++i) {
+        if (strings[i] == NULL) continue;
+        for (const struct lxl_delim_pair *d = strings[i]; d->opener != NULL; ++d) {
+            for (const char *c = d->opener; *c != '\0'; ++c) LXL__MARK(*c);
+        }
     }
-    struct lxl_token token = lxl_lexer__start_token(lexer);
+    if (LXL_HAS_FEATURE(LXL_FEATURE_PUNCTS) && lexer->puncts != NULL) {
+        for (const char *const *s = lexer->puncts; *s != NULL; ++s) {
+            all |= (*s)[0] == '\0';
+            LXL__MARK((*s)[0]);
+        }
+    }
+#undef LXL__MARK
+    if (all) {
+        for (int i = 0; i < 4; ++i) OUT_table[i] = ~(uint64_t)0;
+    }
+}
+
+// Return whether an exponent (the default exponent marker, an optional sign and a digit) follows an
+// unprefixed integer, which is then lexed as a float (e.g. "1e5") if `.extended_floats` is set.
+static bool lxl__check_exponent(struct lxl_lexer *lexer) {
+    const char *start = lexer->current;
+    bool result = lxl_lexer__match_string(lexer, lexer->default_exponent_marker);
+    if (result) {
+        lxl_lexer__match_exponent_sign(lexer);
+        result = lxl_lexer__check_digit(lexer, lexer->default_float_base);
+        lxl_lexer__rewind_to(lexer, start);
+    }
+    return result;
+}
+
+// As `lxl_lexer__lex_word()`, but bytes not in `maybe_reserved` (see `lxl__reserved_table()`) are skipped
+// without checking each rule.
+static void lxl__lex_word_with_table(struct lxl_lexer *lexer, const uint64_t maybe_reserved[4]) {
+    struct lxl_cursor cursor = lxl_cursor__load(lexer);
+    for (;;) {
+        const char *p = cursor.current;
+        for (; p < cursor.end; ++p) {
+            unsigned char c = (unsigned char)*p;
+            if ((maybe_reserved[c >> 6] >> (c & 63)) & 1) break;
+        }
+        // LF is reserved, so the skipped bytes are all on this line.
+        cursor.pos.column += p - cursor.current;
+        cursor.current = p;
+        if (lxl_cursor__is_at_end(cursor)) break;
+        lxl_cursor__store(lexer, cursor);
+        if (lxl_lexer__check_reserved(lexer)) break;
+        lxl_cursor__advance(&cursor);
+    }
+    lxl_cursor__store(lexer, cursor);
+}
+
+// Lex the rest of a token started at `lexer->token_start` (after whitespace and the offside rule) and return
+// its type. If `classify` is false, words are not looked up as keywords. If `maybe_reserved` is non-NULL,
+// it is used to lex words (see `lxl__lex_word_with_table()`). This is shared by `lxl_lexer_next_token()` and
+// `lxl_lexer_validate()`; being inlined, each gets its own copy.
+static inline int lxl__lex_token_body(struct lxl_lexer *lexer, bool classify,
+                                      const uint64_t *maybe_reserved) {
+    int token_type = LXL_TOKEN_UNINIT;
     const char *const *matched_string = NULL;
     const struct lxl_delim_pair *matched_lxl_delim_pair = NULL;
     int number_base = 0;
@@ -757,25 +2057,30 @@ struct lxl_token lxl_lexer_next_token(struct lxl_lexer *lexer) {
     if (lxl_lexer__match_chars(lexer, "\n")) {
         // If we cannot emit line endings, we should have already skipped this LF.
         LXL_ASSERT(lxl_lexer__can_emit_line_ending(lexer));
-        token.token_type = lexer->line_ending_type;
+        token_type = lexer->line_ending_type;
     }
-    else if ((matched_lxl_delim_pair = lxl_lexer__match_string_opener(lexer, LXL_STRING_LINE))) {
-        lxl_lexer__lex_string(lexer, matched_lxl_delim_pair->closer, LXL_STRING_LINE);
+    else if (LXL_HAS_FEATURE(LXL_FEATURE_LINE_STRINGS)
+             && (matched_lxl_delim_pair = lxl_lexer__match_string_opener(lexer, LXL_STRING_LINE))) {
+        lxl_lexer__lex_string(lexer, matched_lxl_delim_pair, LXL_STRING_LINE);
         int delim_index = matched_lxl_delim_pair - lexer->line_string_delims;
         LXL_ASSERT(lexer->line_string_types != NULL);
-        token.token_type = lexer->line_string_types[delim_index];
+        token_type = lexer->line_string_types[delim_index];
     }
-    else if ((matched_lxl_delim_pair = lxl_lexer__match_string_opener(lexer, LXL_STRING_MULTILINE))) {
-        lxl_lexer__lex_string(lexer, matched_lxl_delim_pair->closer, LXL_STRING_MULTILINE);
+    else if (LXL_HAS_FEATURE(LXL_FEATURE_MULTILINE_STRINGS)
+             && (matched_lxl_delim_pair = lxl_lexer__match_string_opener(lexer, LXL_STRING_MULTILINE))) {
+        lxl_lexer__lex_string(lexer, matched_lxl_delim_pair, LXL_STRING_MULTILINE);
         int delim_index = matched_lxl_delim_pair - lexer->multiline_string_delims;
         LXL_ASSERT(lexer->multiline_string_types != NULL);
-        token.token_type = lexer->multiline_string_types[delim_index];
+        token_type = lexer->multiline_string_types[delim_index];
     }
-    else if ((number_base = lxl_lexer__match_int_prefix(lexer))) {
+    else if (LXL_HAS_FEATURE(LXL_FEATURE_INTEGERS) && (number_base = lxl_lexer__match_int_prefix(lexer))) {
         LXL_ASSERT(number_base > 1);  // Base should be valid here.
         if (lxl_lexer__lex_integer(lexer, number_base)) {
-            token.token_type = lexer->default_int_type;
-            if (lxl_lexer__check_radix_separator(lexer) && lexer->default_float_base != 0) {
+            token_type = lexer->default_int_type;
+            if (LXL_HAS_FEATURE(LXL_FEATURE_FLOATS) && lexer->default_float_base != 0
+                && (lxl_lexer__check_radix_separator(lexer)
+                    || (lexer->extended_floats && number_base == lexer->default_int_base
+                        && lxl__check_exponent(lexer)))) {
                 // Re-lex as float.
                 LXL_LEXER__CALL_HOOK0(lexer, before_unlex_int_hook);
                 lxl_lexer__unlex(lexer);
@@ -783,33 +2088,40 @@ struct lxl_token lxl_lexer_next_token(struct lxl_lexer *lexer) {
                     goto try_lex_float;
                 }
                 else {
-                    token.token_type = LXL_LERR_INVALID_INTEGER;
+                    token_type = LXL_LERR_INVALID_INTEGER;
                 }
             }
         }
         else {
-            token.token_type = LXL_LERR_INVALID_INTEGER;
+            token_type = LXL_LERR_INVALID_INTEGER;
+            // The digits were un-lexed; keep the prefix in the error token so the lexer makes progress.
+            lxl_lexer__match_int_prefix(lexer);
         }
         if (!lxl_lexer__match_int_suffix(lexer)) {
 
         }
     }
-    else if ((number_base = lxl_lexer__match_float_prefix(lexer, &exponent_marker))) {
+    else if (LXL_HAS_FEATURE(LXL_FEATURE_FLOATS)
+             && (number_base = lxl_lexer__match_float_prefix(lexer, &exponent_marker))) {
 try_lex_float:
         LXL_ASSERT(number_base > 1);  // Base should be valid here.
         LXL_ASSERT(exponent_marker != NULL);
         if (lxl_lexer__lex_float(lexer, number_base, exponent_marker)) {
-            token.token_type = lexer->default_float_type;
+            token_type = lexer->default_float_type;
+            if (lexer->extended_floats) lxl_lexer__match_float_suffix(lexer);
         }
         else {
-            token.token_type = LXL_LERR_INVALID_FLOAT;
+            token_type = LXL_LERR_INVALID_FLOAT;
+            // As above, keep the prefix in the error token.
+            lxl_lexer__match_float_prefix(lexer, &exponent_marker);
         }
 
     }
-    else if ((matched_string = lxl_lexer__match_punct(lexer))) {
+    else if (LXL_HAS_FEATURE(LXL_FEATURE_PUNCTS) && (matched_string = lxl_lexer__match_punct(lexer))) {
         int punct_index = matched_string - lexer->puncts;
         LXL_ASSERT(lexer->punct_types != NULL);
-        token.token_type = lexer->punct_types[punct_index];
+        token_type = lexer->punct_types[punct_index];
+        lxl_lexer__update_bracket_depth(lexer, *matched_string);
     }
     else {
         switch (lexer->word_lexing_rule) {
@@ -817,22 +2129,144 @@ try_lex_float:
             lxl_lexer__lex_symbolic(lexer);
             break;
         case LXL_LEX_WORD:
-            lxl_lexer__lex_word(lexer);
+            if (maybe_reserved != NULL) {
+                lxl__lex_word_with_table(lexer, maybe_reserved);
+            }
+            else {
+                lxl_lexer__lex_word(lexer);
+            }
             break;
         }
-        token.token_type = lxl_lexer__get_word_type(lexer, token.start);
+        token_type = lexer->default_word_type;
+        if (classify) token_type = lxl_lexer__get_word_type(lexer, lexer->token_start);
+    }
+    return token_type;
+}
+
+// Return the empty LXL_TOKEN_NO_TOKEN token which marks a scan paused at `.scan_pause`. It is not a token,
+// so the type of the previous token is kept.
+static struct lxl_token lxl__pause_token(const struct lxl_lexer *lexer) {
+    return (struct lxl_token) {
+        .start = lexer->current,
+        .end = lexer->current,
+        .loc = lexer->pos,
+        .token_type = LXL_TOKEN_NO_TOKEN,
+    };
+}
+
+// Resume the comment or string scan paused at `.scan_pause`. Write the string's token, or a pause token if
+// the scan paused again, to OUT_token and return true. Return false if the comment was finished, so that
+// lexing goes on as usual.
+static bool lxl__resume_scan(struct lxl_lexer *lexer, struct lxl_token *OUT_token) {
+    struct lxl_paused_scan paused = lexer->paused_scan;
+    lexer->paused_scan.delims = NULL;
+    if (paused.depth > 0) {
+        lxl_lexer__skip_block_comment(lexer, paused.delims, paused.nestable, paused.depth);
+        if (lexer->paused_scan.delims == NULL) return false;
+        *OUT_token = lxl__pause_token(lexer);
+        return true;
+    }
+    lxl_lexer__lex_string(lexer, paused.delims, paused.string_type);
+    if (lexer->paused_scan.delims != NULL) {
+        lexer->paused_scan = paused;  // Keep the token's type and location.
+        *OUT_token = lxl__pause_token(lexer);
+        return true;
+    }
+    lexer->token_start = lexer->start + paused.token_offset;
+    *OUT_token = (struct lxl_token) {
+        .start = lexer->token_start,
+        .end = lexer->current,
+        .loc = paused.token_loc,
+        .token_type = paused.token_type,
+    };
+    lxl_lexer__finish_token(lexer, OUT_token);
+    return true;
+}
+
+// Lex the next token as `lxl_lexer_next_token()` does, lexing words with `maybe_reserved` if it is non-NULL
+// (see `lxl__lex_word_with_table()`).
+static inline struct lxl_token lxl__next_token(struct lxl_lexer *lexer, const uint64_t *maybe_reserved) {
+    if (lxl_lexer_is_finished(lexer)) {
+        return lxl_lexer__create_end_token(lexer);
+    }
+    struct lxl_token token;
+    if (lexer->paused_scan.delims != NULL && lxl__resume_scan(lexer, &token)) {
+        return token;
+    }
+    lxl_lexer__skip_whitespace(lexer);
+    if (lexer->paused_scan.delims != NULL) {
+        return lxl__pause_token(lexer);  // Paused in a comment.
+    }
+    if (lexer->error) {
+        return lxl_lexer__create_error_token(lexer);
+    }
+    if (LXL_HAS_FEATURE(LXL_FEATURE_OFFSIDE_RULE) && lexer->offside_rule
+        && lxl_lexer__lex_offside(lexer, &token)) {
+        return token;
+    }
+    else if (lxl_lexer__is_at_end(lexer)) {
+        return lxl_lexer__create_end_token(lexer);
+    }
+    token = lxl_lexer__start_token(lexer);
+    token.token_type = lxl__lex_token_body(lexer, true, maybe_reserved);
+    if (lexer->paused_scan.delims != NULL) {
+        // Paused in a string: keep its token for when the scan is resumed.
+        lexer->paused_scan.token_type = token.token_type;
+        lexer->paused_scan.token_offset = token.start - lexer->start;
+        lexer->paused_scan.token_loc = token.loc;
+        return lxl__pause_token(lexer);
     }
     lxl_lexer__finish_token(lexer, &token);
+    struct lxl_rule_profile *profile = lexer->rule_profile;
+    if (profile != NULL && profile->interval != 0 && --profile->countdown == 0) {
+        lxl_rule_profile_reorder(profile);
+    }
     return token;
 }
 
+struct lxl_token lxl_lexer_next_token(struct lxl_lexer *lexer) {
+    const uint64_t *reserved_bytes = (lexer->rule_index != NULL) ? lexer->rule_index->reserved_bytes : NULL;
+    return lxl__next_token(lexer, reserved_bytes);
+}
+
+size_t lxl_lexer_tokenize(struct lxl_lexer *lexer, struct lxl_token *tokens, size_t capacity) {
+    size_t count = 0;
+    while (count < capacity) {
+        struct lxl_token token = lxl_lexer_next_token(lexer);
+        if (LXL_TOKEN_IS_END(token)) break;
+        tokens[count++] = token;
+    }
+    return count;
+}
+
 bool lxl_lexer_is_finished(struct lxl_lexer *lexer) {
     return lexer->status == LXL_LSTS_FINISHED || lexer->status == LXL_LSTS_FINISHED_ABNORMAL;
 }
 
 void lxl_lexer_reset(struct lxl_lexer *lexer) {
-    lexer->current = lexer->start;
+    const struct lxl_structural_index *structural_index = lexer->structural_index;
+    lxl_lexer_rebind(lexer, lexer->start, lexer->end);
+    lexer->structural_index = structural_index;  // Still describes the input.
+}
+
+void lxl_lexer_rebind(struct lxl_lexer *lexer, const char *start, const char *end) {
+    LXL_ASSERT(start != NULL);
+    if (end == NULL) end = start + strlen(start);
+    lexer->start = start;
+    lexer->end = end;
+    lexer->current = start;
+    lexer->token_start = start;
+    lexer->pos = (struct lxl_location) {0, 0};
+    lexer->previous_token_type = LXL_TOKEN_NO_TOKEN;
+    lexer->error = LXL_LERR_OK;
     lexer->status = LXL_LSTS_READY;
+    lexer->indent_depth = 0;
+    lexer->pending_dedents = 0;
+    lexer->bracket_depth = 0;
+    lexer->line_indent = LXL_INDENT_NONE;
+    lexer->paused_scan = (struct lxl_paused_scan) {.delims = NULL};
+    lexer->budget_slice = 0;
+    lexer->structural_index = NULL;
 }
 
 ptrdiff_t lxl_lexer__head_length(struct lxl_lexer *lexer) {
@@ -860,28 +2294,17 @@ bool lxl_lexer__is_at_start(struct lxl_lexer *lexer) {
 }
 
 char lxl_lexer__advance(struct lxl_lexer *lexer) {
-    if (lxl_lexer__is_at_end(lexer)) return '\0';
-    if (*lexer->current != '\n') {
-        ++lexer->pos.column;
-    }
-    else {
-        lexer->pos.column = 0;
-        ++lexer->pos.line;
-    }
-    ++lexer->current;
-    return lexer->current[-1];
+    struct lxl_cursor cursor = lxl_cursor__load(lexer);
+    char c = lxl_cursor__advance(&cursor);
+    lxl_cursor__store(lexer, cursor);
+    return c;
 }
 
 bool lxl_lexer__advance_by(struct lxl_lexer *lexer, size_t n) {
-    while (n-- > 0) {
-        if (lxl_lexer__is_at_end(lexer)) return false;
-        ++lexer->current;
-        if (*lexer->current == '\n') {
-            ++lexer->pos.line;
-        }
-    }
-    lxl_lexer__recalc_column(lexer);
-    return true;
+    struct lxl_cursor cursor = lxl_cursor__load(lexer);
+    bool result = lxl_cursor__advance_by(&cursor, n);
+    lxl_cursor__store(lexer, cursor);
+    return result;
 }
 
 bool lxl_lexer__advance_to(struct lxl_lexer *lexer, const char *future) {
@@ -928,7 +2351,7 @@ void lxl_lexer__unlex(struct lxl_lexer *lexer) {
 
 void lxl_lexer__recalc_column(struct lxl_lexer *lexer) {
     lexer->pos.column = 0;
-    for (const char *p = lexer->current; p != lexer->start && *p != '\n'; --p) {
+    for (const char *p = lexer->current; p != lexer->start && p[-1] != '\n'; --p) {
         ++lexer->pos.column;
     }
 }
@@ -941,10 +2364,18 @@ bool lxl_lexer__can_emit_line_ending(struct lxl_lexer *lexer) {
     return true;
 }
 
+char lxl_lexer__peek(struct lxl_lexer *lexer) {
+    // With padded input, the sentinel makes the bounds check unnecessary.
+    if (!lexer->padded_input && lxl_lexer__is_at_end(lexer)) return '\0';
+    return *lexer->current;
+}
+
 const char *lxl_lexer__check_chars(struct lxl_lexer *lexer, const char *chars) {
     if (chars == NULL) return NULL;  // Allow NULL.
+    char c = lxl_lexer__peek(lexer);
+    if (c == '\0') return NULL;  // `chars` cannot contain '\0'.
     while (*chars != '\0') {
-        if (*lexer->current == *chars) return chars;
+        if (c == *chars) return chars;
         ++chars;
     }
     return NULL;
@@ -952,9 +2383,14 @@ const char *lxl_lexer__check_chars(struct lxl_lexer *lexer, const char *chars) {
 
 bool lxl_lexer__check_string(struct lxl_lexer *lexer, const char *s) {
     if (s == NULL) return false;
-    size_t tail_length = lxl_lexer__tail_length(lexer);
+    // Most checks fail on the first character, so reject these before measuring the string.
+    if (s[0] != '\0' && (lxl_lexer__is_at_end(lexer) || *lexer->current != s[0])) return false;
     size_t n = strlen(s);
-    if (n > tail_length) return false;
+    // With padded input, a string without NULs cannot match past the end, so no bounds check is needed.
+    if (!lexer->padded_input || n > LXL_INPUT_PADDING) {
+        size_t tail_length = lxl_lexer__tail_length(lexer);
+        if (n > tail_length) return false;
+    }
     return memcmp(lexer->current, s, n) == 0;
 }
 
@@ -995,10 +2431,12 @@ bool lxl_lexer__check_reserved(struct lxl_lexer *lexer) {
 }
 
 bool lxl_lexer__check_line_comment(struct lxl_lexer *lexer) {
+    if (!LXL_HAS_FEATURE(LXL_FEATURE_LINE_COMMENTS)) return false;
     return lxl_lexer__check_strings(lexer, lexer->line_comment_openers);
 }
 
 bool lxl_lexer__check_block_comment(struct lxl_lexer *lexer) {
+    if (!LXL_HAS_FEATURE(LXL_FEATURE_BLOCK_COMMENTS)) return false;
     return lxl_lexer__check_nestable_comment(lexer) || lxl_lexer__check_unnestable_comment(lexer);
 }
 
@@ -1024,9 +2462,13 @@ bool lxl_lexer__check_unnestable_comment(struct lxl_lexer *lexer) {
 
 const struct lxl_delim_pair *lxl_lexer__check_string_opener(struct lxl_lexer *lexer,
                                                         enum lxl_string_type string_type) {
-    const struct lxl_delim_pair *string_delims = (string_type == LXL_STRING_LINE)
-        ? lexer->line_string_delims
-        : lexer->multiline_string_delims;
+    const struct lxl_delim_pair *string_delims = NULL;
+    if (string_type == LXL_STRING_LINE) {
+        if (LXL_HAS_FEATURE(LXL_FEATURE_LINE_STRINGS)) string_delims = lexer->line_string_delims;
+    }
+    else {
+        if (LXL_HAS_FEATURE(LXL_FEATURE_MULTILINE_STRINGS)) string_delims = lexer->multiline_string_delims;
+    }
     if (string_delims == NULL) return NULL;
     for (const struct lxl_delim_pair *delims = string_delims; delims->opener != NULL; ++delims) {
         if (lxl_lexer__check_chars(lexer, delims->opener)) return delims;
@@ -1035,12 +2477,8 @@ const struct lxl_delim_pair *lxl_lexer__check_string_opener(struct lxl_lexer *le
 }
 
 bool lxl_lexer__check_digit(struct lxl_lexer *lexer, int base) {
-    if (base == 0) return false;
-    LXL_ASSERT(2 <= base && base <= 26);
-    char digits[] = LXL_DIGITS "" LXL_BASIC_MIXED_LATIN_CHARS;
-    int end_digit_index = (base <= 10) ? base : 10 + 2*(base - 10);
-    digits[end_digit_index] = '\0';  // Truncate array to only contain the needed digits.
-    return lxl_lexer__check_chars(lexer, digits);
+    LXL_ASSERT(base == 0 || (2 <= base && base <= 26));
+    return lxl_cursor__check_digit(lxl_cursor__load(lexer), base);
 }
 
 bool lxl_lexer__check_digit_separator(struct lxl_lexer *lexer) {
@@ -1099,6 +2537,7 @@ bool lxl_lexer__check_float_suffix(struct lxl_lexer *lexer) {
 }
 
 bool lxl_lexer__check_number_sign(struct lxl_lexer *lexer) {
+    if (!LXL_HAS_FEATURE(LXL_FEATURE_NUMBER_SIGNS)) return false;
     return lxl_lexer__check_strings(lexer, lexer->number_signs);
 }
 
@@ -1111,8 +2550,26 @@ bool lxl_lexer__check_exponent_sign(struct lxl_lexer *lexer) {
 }
 
 const char *const *lxl_lexer__check_punct(struct lxl_lexer *lexer) {
-    if (lexer->puncts == NULL) return NULL;
-    for (const char *const *punct = lexer->puncts; *punct != NULL; ++punct) {
+    if (!LXL_HAS_FEATURE(LXL_FEATURE_PUNCTS) || lexer->puncts == NULL) return NULL;
+    const struct lxl_rule_profile *profile = lexer->rule_profile;
+    if (profile != NULL) {
+        if (lxl_lexer__is_at_end(lexer)) return NULL;
+        unsigned char c = *lexer->current;
+        for (int i = profile->punct_groups[c]; i < profile->punct_groups[c + 1]; ++i) {
+            const char *const *punct = &lexer->puncts[profile->punct_order[i]];
+            if (lxl_lexer__check_string(lexer, *punct)) return punct;
+        }
+        return NULL;
+    }
+    const char *const *punct = lexer->puncts;
+    const char *const *last = NULL;
+    if (lexer->rule_index != NULL) {
+        if (lxl_lexer__is_at_end(lexer)) return NULL;
+        unsigned char c = *lexer->current;
+        last = &lexer->puncts[lexer->rule_index->punct_groups[c + 1]];
+        punct += lexer->rule_index->punct_groups[c];
+    }
+    for (; punct != last && *punct != NULL; ++punct) {
         if (lxl_lexer__check_string(lexer, *punct)) return punct;
     }
     return NULL;
@@ -1156,6 +2613,7 @@ bool lxl_lexer__match_line_comment(struct lxl_lexer *lexer) {
 }
 
 bool lxl_lexer__match_block_comment(struct lxl_lexer *lexer) {
+    if (!LXL_HAS_FEATURE(LXL_FEATURE_BLOCK_COMMENTS)) return false;
     if (lxl_lexer__match_nestable_comment(lexer)) return true;
     return lxl_lexer__match_unnestable_comment(lexer);
 }
@@ -1166,7 +2624,7 @@ bool lxl_lexer__match_nestable_comment(struct lxl_lexer *lexer) {
          delims->opener != NULL;
          ++delims) {
         if (lxl_lexer__match_string(lexer, delims->opener)) {
-            lxl_lexer__skip_block_comment(lexer, *delims, true);
+            lxl_lexer__skip_block_comment(lexer, delims, true, 1);
             return true;
         }
     }
@@ -1179,7 +2637,7 @@ bool lxl_lexer__match_unnestable_comment(struct lxl_lexer *lexer) {
          delims->opener != NULL;
          ++delims) {
         if (lxl_lexer__match_string(lexer, delims->opener)) {
-            lxl_lexer__skip_block_comment(lexer, *delims, false);
+            lxl_lexer__skip_block_comment(lexer, delims, false, 1);
             return true;
         }
     }
@@ -1188,9 +2646,13 @@ bool lxl_lexer__match_unnestable_comment(struct lxl_lexer *lexer) {
 
 const struct lxl_delim_pair *lxl_lexer__match_string_opener(struct lxl_lexer *lexer,
                                                         enum lxl_string_type string_type) {
-    const struct lxl_delim_pair *string_delims = (string_type == LXL_STRING_LINE)
-        ? lexer->line_string_delims
-        : lexer->multiline_string_delims;
+    const struct lxl_delim_pair *string_delims = NULL;
+    if (string_type == LXL_STRING_LINE) {
+        if (LXL_HAS_FEATURE(LXL_FEATURE_LINE_STRINGS)) string_delims = lexer->line_string_delims;
+    }
+    else {
+        if (LXL_HAS_FEATURE(LXL_FEATURE_MULTILINE_STRINGS)) string_delims = lexer->multiline_string_delims;
+    }
     if (string_delims == NULL) return NULL;
     for (const struct lxl_delim_pair *delims = string_delims; delims->opener != NULL; ++delims) {
         if (lxl_lexer__match_chars(lexer, delims->opener)) return delims;
@@ -1252,6 +2714,7 @@ bool lxl_lexer__match_float_suffix(struct lxl_lexer *lexer) {
 }
 
 bool lxl_lexer__match_number_sign(struct lxl_lexer *lexer) {
+    if (!LXL_HAS_FEATURE(LXL_FEATURE_NUMBER_SIGNS)) return false;
     return lxl_lexer__match_strings(lexer, lexer->number_signs);
 }
 
@@ -1264,8 +2727,29 @@ bool lxl_lexer__match_exponent_sign(struct lxl_lexer *lexer) {
 }
 
 const char *const *lxl_lexer__match_punct(struct lxl_lexer *lexer) {
-    if (lexer->puncts == NULL) return NULL;
-    for (const char *const *punct = lexer->puncts; *punct != NULL; ++punct) {
+    if (!LXL_HAS_FEATURE(LXL_FEATURE_PUNCTS) || lexer->puncts == NULL) return NULL;
+    struct lxl_rule_profile *profile = lexer->rule_profile;
+    if (profile != NULL) {
+        if (lxl_lexer__is_at_end(lexer)) return NULL;
+        unsigned char c = *lexer->current;
+        for (int i = profile->punct_groups[c]; i < profile->punct_groups[c + 1]; ++i) {
+            int punct_index = profile->punct_order[i];
+            if (lxl_lexer__match_string(lexer, lexer->puncts[punct_index])) {
+                ++profile->punct_hits[punct_index];
+                return &lexer->puncts[punct_index];
+            }
+        }
+        return NULL;
+    }
+    const char *const *punct = lexer->puncts;
+    const char *const *last = NULL;
+    if (lexer->rule_index != NULL) {
+        if (lxl_lexer__is_at_end(lexer)) return NULL;
+        unsigned char c = *lexer->current;
+        last = &lexer->puncts[lexer->rule_index->punct_groups[c + 1]];
+        punct += lexer->rule_index->punct_groups[c];
+    }
+    for (; punct != last && *punct != NULL; ++punct) {
         if (lxl_lexer__match_string(lexer, *punct)) return punct;
     }
     return NULL;
@@ -1273,12 +2757,23 @@ const char *const *lxl_lexer__match_punct(struct lxl_lexer *lexer) {
 
 int lxl_lexer__skip_whitespace(struct lxl_lexer *lexer) {
     const char *whitespace_start = lexer->current;
+    bool lf_is_whitespace = !lxl_lexer__can_emit_line_ending(lexer);
     for(;;) {
-        if (lxl_lexer__check_whitespace(lexer)) {
-            // Whitespace, skip.
-            if (!lxl_lexer__advance(lexer)) break;
+        // Skip a run of whitespace.
+        int run_line = lexer->pos.line;
+        bool run_at_line_start = (lexer->pos.column == 0);
+        if (lexer->structural_index != NULL) lxl_lexer__skip_indexed_whitespace(lexer, lf_is_whitespace);
+        struct lxl_cursor cursor = lxl_cursor__load(lexer);
+        while (lxl_cursor__check_blank(cursor) || (lf_is_whitespace && lxl_cursor__peek(cursor) == '\n')) {
+            lxl_cursor__advance(&cursor);
         }
-        else if (lxl_lexer__check_string(lexer, "\n")) {
+        lxl_cursor__store(lexer, cursor);
+        if (LXL_HAS_FEATURE(LXL_FEATURE_OFFSIDE_RULE) && lexer->offside_rule
+            && (run_at_line_start || lexer->pos.line != run_line)) {
+            // The run reached the start of a line: measure its indentation before any comment.
+            lexer->line_indent = lxl_lexer__measure_indentation(lexer);
+        }
+        if (lxl_lexer__check_string(lexer, "\n")) {
             // LF should have already been considered whitespace if we cannot emit a line ending here.
             LXL_ASSERT(lxl_lexer__can_emit_line_ending(lexer));
             break;
@@ -1287,7 +2782,7 @@ int lxl_lexer__skip_whitespace(struct lxl_lexer *lexer) {
             /* Do nothing; comment already consumed. */
         }
         else if (lxl_lexer__match_block_comment(lexer)) {
-            /* Do nothing; comment already consumed. */
+            if (lexer->paused_scan.delims != NULL) break;  // Paused inside the comment.
         }
         else {
             // Not a comment or whitespace.
@@ -1300,29 +2795,58 @@ int lxl_lexer__skip_whitespace(struct lxl_lexer *lexer) {
 int lxl_lexer__skip_line(struct lxl_lexer *lexer) {
     const char *line_start = lexer->current;
     // NOTE: final LF is NOT consumed.
-    while (!lxl_lexer__check_chars(lexer, "\n")) {
-        if (!lxl_lexer__advance(lexer)) break;
+    if (lexer->padded_input) {
+        // Scan up to the LF or sentinel without bounds checks.
+        const char *p = lexer->current;
+        for (;;) {
+            while (*p != '\n' && *p != '\0') ++p;
+            if (*p == '\0' && p < lexer->end) {
+                ++p;  // NUL in the input itself.
+                continue;
+            }
+            break;
+        }
+        lexer->pos.column += p - lexer->current;
+        lexer->current = p;
+        return lxl_lexer__length_from(lexer, line_start);
+    }
+    struct lxl_cursor cursor = lxl_cursor__load(lexer);
+    while (!lxl_cursor__is_at_end(cursor) && *cursor.current != '\n') {
+        lxl_cursor__advance(&cursor);
     }
+    lxl_cursor__store(lexer, cursor);
     return lxl_lexer__length_from(lexer, line_start);
 }
 
-int lxl_lexer__skip_block_comment(struct lxl_lexer *lexer, struct lxl_delim_pair delims, bool nestable) {
-    const char *comment_start = lexer->start;
-    while (!lxl_lexer__match_string(lexer, delims.closer)) {
-        if (nestable && lxl_lexer__match_string(lexer, delims.opener)) {
-            if (lxl_lexer__skip_block_comment(lexer, delims, true) <= 0) {
-                // Unclosed nested comment.
-                lexer->error = LXL_LERR_UNCLOSED_COMMENT;
-                break;
-            }
+int lxl_lexer__skip_block_comment(struct lxl_lexer *lexer, const struct lxl_delim_pair *delims, bool nestable,
+                                  int depth) {
+    const char *comment_start = lexer->current;
+    size_t opener_length = strlen(delims->opener);
+    size_t closer_length = strlen(delims->closer);
+    const char *pause = lexer->scan_pause;
+    struct lxl_cursor cursor = lxl_cursor__load(lexer);
+    // Nested comments are tracked by depth rather than recursion.
+    while (depth > 0) {
+        if (lxl_cursor__match_string_n(&cursor, delims->closer, closer_length)) {
+            --depth;
         }
-        else {
-            if (!lxl_lexer__advance(lexer)) {
-                lexer->error = LXL_LERR_UNCLOSED_COMMENT;
-                break;
-            }
+        else if (nestable && lxl_cursor__match_string_n(&cursor, delims->opener, opener_length)) {
+            ++depth;
+        }
+        else if (!lxl_cursor__advance(&cursor)) {
+            lexer->error = LXL_LERR_UNCLOSED_COMMENT;
+            break;
+        }
+        if (pause != NULL && cursor.current >= pause && depth > 0) {
+            lexer->paused_scan = (struct lxl_paused_scan) {
+                .delims = delims,
+                .depth = depth,
+                .nestable = nestable,
+            };
+            break;
         }
     }
+    lxl_cursor__store(lexer, cursor);
     return lxl_lexer__length_from(lexer, comment_start);
 }
 
@@ -1370,10 +2894,35 @@ struct lxl_token lxl_lexer__create_error_token(struct lxl_lexer *lexer) {
 
 int lxl_lexer__lex_symbolic(struct lxl_lexer *lexer) {
     int count = 0;
-    while (!lxl_lexer__is_at_end(lexer) && !lxl_lexer__check_whitespace(lexer)) {
-        lxl_lexer__advance(lexer);
+    if (lexer->padded_input) {
+        // Scan up to whitespace or the sentinel without bounds checks.
+        bool lf_is_whitespace = !lxl_lexer__can_emit_line_ending(lexer);
+        const char *p = lexer->current;
+        for (;; ++p) {
+            char c = *p;
+            if (c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v') break;
+            if (c == '\n') {
+                if (lf_is_whitespace) break;
+                ++lexer->pos.line;
+                lexer->pos.column = -1;  // Incremented below.
+            }
+            else if (c == '\0' && p >= lexer->end) {
+                break;
+            }
+            ++lexer->pos.column;
+        }
+        count = p - lexer->current;
+        lexer->current = p;
+        return count;
+    }
+    bool lf_is_whitespace = !lxl_lexer__can_emit_line_ending(lexer);
+    struct lxl_cursor cursor = lxl_cursor__load(lexer);
+    while (!lxl_cursor__is_at_end(cursor) && !lxl_cursor__check_blank(cursor)) {
+        if (lf_is_whitespace && *cursor.current == '\n') break;
+        lxl_cursor__advance(&cursor);
         ++count;
     }
+    lxl_cursor__store(lexer, cursor);
     return count;
 }
 
@@ -1386,61 +2935,83 @@ int lxl_lexer__lex_word(struct lxl_lexer *lexer) {
     return count;
 }
 
-int lxl_lexer__lex_string(struct lxl_lexer *lexer, const char *closer, enum lxl_string_type string_type) {
+int lxl_lexer__lex_string(struct lxl_lexer *lexer, const struct lxl_delim_pair *delims,
+                          enum lxl_string_type string_type) {
+    const char *closer = delims->closer;
     LXL_ASSERT(closer != NULL);
     const char *start = lexer->current;
-    while (!lxl_lexer__match_string(lexer, closer)) {
-        if (lxl_lexer__match_chars(lexer, lexer->string_escape_chars)) {
-            // Consume escaped closer.
-            lxl_lexer__match_string(lexer, closer);
+    const char *pause = lexer->scan_pause;
+    if (lexer->structural_index != NULL && pause == NULL && lxl_lexer__skip_indexed_string(lexer, closer)) {
+        return lxl_lexer__length_from(lexer, start);
+    }
+    const char *escape_chars = lexer->string_escape_chars;
+    size_t closer_length = strlen(closer);
+    struct lxl_cursor cursor = lxl_cursor__load(lexer);
+    while (!lxl_cursor__match_string_n(&cursor, closer, closer_length)) {
+        if (lxl_cursor__check_chars(cursor, escape_chars)) {
+            // Consume the escape character. The escaped character (e.g. the closer) is consumed below.
+            lxl_cursor__advance(&cursor);
         }
         // Consume non-delimiter character.
-        char c = lxl_lexer__advance(lexer);
+        char c = lxl_cursor__advance(&cursor);
         if (c == '\0' || (c == '\n' && string_type == LXL_STRING_LINE)) {
             lexer->error = LXL_LERR_UNCLOSED_STRING;
-            return lxl_lexer__length_from(lexer, start);
+            break;
+        }
+        if (pause != NULL && cursor.current >= pause) {
+            // The caller records the token's type and location.
+            lexer->paused_scan = (struct lxl_paused_scan) {.delims = delims, .string_type = string_type};
+            break;
         }
     }
+    lxl_cursor__store(lexer, cursor);
     return lxl_lexer__length_from(lexer, start);
 }
 
 int lxl_lexer__lex_integer(struct lxl_lexer *lexer, int base) {
     const char *start = lexer->current;
+    if (lxl_lexer__lex_digits(lexer, base) <= 0) {
+        // Un-lex token which is not a valid integer literal.
+        LXL_LEXER__CALL_HOOK0(lexer, before_unlex_int_hook);
+        lxl_lexer__unlex(lexer);
+        return 0;
+    }
+    return lxl_lexer__length_from(lexer, start);
+}
+
+int lxl_lexer__lex_digits(struct lxl_lexer *lexer, int base) {
+    LXL_ASSERT(base == 0 || (2 <= base && base <= 26));
+    const char *separators = lexer->digit_separators;
     int digit_count = 0;
+    struct lxl_cursor cursor = lxl_cursor__load(lexer);
     for (;;) {
-        if (lxl_lexer__match_digit(lexer, base)) {
+        if (lxl_cursor__check_digit(cursor, base)) {
             ++digit_count;
         }
-        else if (lxl_lexer__match_digit_separator(lexer)) {
-            /* Do nothing. */
-        }
-        else {
+        else if (!lxl_cursor__check_chars(cursor, separators)) {
             // Not a digit or separator.
             break;
         }
+        lxl_cursor__advance(&cursor);
     }
-    if (digit_count <= 0) {
-        // Un-lex token which is not a valid integer literal.
-        LXL_LEXER__CALL_HOOK0(lexer, before_unlex_int_hook);
-        lxl_lexer__unlex(lexer);
-        return 0;
-    }
-    return lxl_lexer__length_from(lexer, start);
+    lxl_cursor__store(lexer, cursor);
+    return digit_count;
 }
 
 int lxl_lexer__lex_float(struct lxl_lexer *lexer, int base, const char *exponent_marker) {
     const char *start = lexer->current;
-    int digit_length = lxl_lexer__lex_integer(lexer, base);
+    // Each part may be empty on its own (e.g. "1." or ".5"), so don't un-lex until we've seen them all.
+    int digit_count = lxl_lexer__lex_digits(lexer, base);
     if (lxl_lexer__match_radix_separator(lexer)) {
         // Part after '.' OE.
-        digit_length += lxl_lexer__lex_integer(lexer, base);
+        digit_count += lxl_lexer__lex_digits(lexer, base);
     }
     if (lxl_lexer__match_string(lexer, exponent_marker)) {
         // Part after 'e' OE.
         lxl_lexer__match_exponent_sign(lexer);  // Consume sign before actual exponent.
-        digit_length += lxl_lexer__lex_integer(lexer, base);
+        digit_count += lxl_lexer__lex_digits(lexer, base);
     }
-    if (digit_length <= 0) {
+    if (digit_count <= 0) {
         // Un-lex token which is not a valid floating-point literal.
         LXL_LEXER__CALL_HOOK0(lexer, before_unlex_float_hook);
         lxl_lexer__unlex(lexer);
@@ -1450,12 +3021,33 @@ int lxl_lexer__lex_float(struct lxl_lexer *lexer, int base, const char *exponent
 }
 
 int lxl_lexer__get_word_type(struct lxl_lexer *lexer, const char *word_start) {
-    if (lexer->keywords == NULL) return lexer->default_word_type;
+    if (!LXL_HAS_FEATURE(LXL_FEATURE_KEYWORDS) || lexer->keywords == NULL) return lexer->default_word_type;
     LXL_ASSERT(lexer->keyword_types != NULL);
     ptrdiff_t word_length = lxl_lexer__length_from(lexer, word_start);
     LXL_ASSERT(word_length > 0);  // Length = 0 is invalid.
-    for (int i = 0; lexer->keywords[i] != NULL; ++i) {
+    struct lxl_rule_profile *profile = lexer->rule_profile;
+    if (profile != NULL) {
+        unsigned char c = *word_start;
+        for (int i = profile->keyword_groups[c]; i < profile->keyword_groups[c + 1]; ++i) {
+            int keyword_index = profile->keyword_order[i];
+            const char *keyword = lexer->keywords[keyword_index];
+            if (strlen(keyword) == (size_t)word_length && memcmp(word_start, keyword, word_length) == 0) {
+                ++profile->keyword_hits[keyword_index];
+                return lexer->keyword_types[keyword_index];
+            }
+        }
+        return lexer->default_word_type;
+    }
+    int first = 0;
+    int last = INT_MAX;
+    if (lexer->rule_index != NULL) {
+        unsigned char c = *word_start;
+        first = lexer->rule_index->keyword_groups[c];
+        last = lexer->rule_index->keyword_groups[c + 1];
+    }
+    for (int i = first; i < last && lexer->keywords[i] != NULL; ++i) {
         const char *keyword = lexer->keywords[i];
+        if (keyword[0] != word_start[0]) continue;  // No match (cheaply).
         size_t keyword_length = strlen(keyword);
         if (keyword_length != (size_t)word_length) continue;  // No match.
         if (memcmp(word_start, keyword, keyword_length) == 0) {
@@ -1465,6 +3057,101 @@ int lxl_lexer__get_word_type(struct lxl_lexer *lexer, const char *word_start) {
     return lexer->default_word_type;
 }
 
+void lxl_lexer__update_bracket_depth(struct lxl_lexer *lexer, const char *punct) {
+    if (lexer->bracket_delims == NULL) return;
+    for (const struct lxl_delim_pair *delims = lexer->bracket_delims; delims->opener != NULL; ++delims) {
+        if (strcmp(punct, delims->opener) == 0) {
+            ++lexer->bracket_depth;
+            return;
+        }
+        if (strcmp(punct, delims->closer) == 0) {
+            if (lexer->bracket_depth > 0) --lexer->bracket_depth;
+            return;
+        }
+    }
+}
+
+int lxl_lexer__measure_indentation(struct lxl_lexer *lexer) {
+    const char *line_start = lexer->current - lexer->pos.column;
+    LXL_ASSERT(line_start >= lexer->start);
+    int width = 0;
+    for (const char *p = line_start; p != lexer->current; ++p) {
+        if (*p != '\t') {
+            ++width;
+            continue;
+        }
+        switch (lexer->tab_policy) {
+        case LXL_TABS_EXPAND:
+            LXL_ASSERT(lexer->tab_width > 0);
+            width = (width / lexer->tab_width + 1) * lexer->tab_width;
+            break;
+        case LXL_TABS_SINGLE:
+            ++width;
+            break;
+        case LXL_TABS_REJECT:
+            return LXL_INDENT_REJECTED;
+        }
+    }
+    return width;
+}
+
+bool lxl_lexer__lex_offside(struct lxl_lexer *lexer, struct lxl_token *OUT_token) {
+    int token_type;
+    if (lexer->pending_dedents > 0) {
+        --lexer->pending_dedents;
+        token_type = lexer->dedent_type;
+        goto emit;
+    }
+    bool at_end = lxl_lexer__is_at_end(lexer);
+    if (!at_end) {
+        if (lexer->line_indent == LXL_INDENT_NONE) return false;
+        if (lxl_lexer__check_chars(lexer, "\n")) return false;  // Blank line.
+        if (lexer->bracket_depth > 0) {
+            // Continuation line.
+            lexer->line_indent = LXL_INDENT_NONE;
+            return false;
+        }
+    }
+    int width = (at_end) ? 0 : lexer->line_indent;
+    lexer->line_indent = LXL_INDENT_NONE;
+    if (width == LXL_INDENT_REJECTED) {
+        lexer->error = LXL_LERR_TAB_INDENT;
+        *OUT_token = lxl_lexer__create_error_token(lexer);
+        return true;
+    }
+    int *stack = lexer->indent_stack;
+    int top = (lexer->indent_depth > 0) ? stack[lexer->indent_depth - 1] : 0;
+    if (width > top) {
+        if (lexer->indent_depth >= lexer->indent_capacity) {
+            lexer->error = LXL_LERR_INDENT_OVERFLOW;
+            *OUT_token = lxl_lexer__create_error_token(lexer);
+            return true;
+        }
+        stack[lexer->indent_depth++] = width;
+        token_type = lexer->indent_type;
+        goto emit;
+    }
+    if (width == top) return false;
+    int dedent_count = 0;
+    while (lexer->indent_depth > 0 && stack[lexer->indent_depth - 1] > width) {
+        --lexer->indent_depth;
+        ++dedent_count;
+    }
+    top = (lexer->indent_depth > 0) ? stack[lexer->indent_depth - 1] : 0;
+    if (top != width) {
+        lexer->error = LXL_LERR_INCONSISTENT_DEDENT;
+        *OUT_token = lxl_lexer__create_error_token(lexer);
+        return true;
+    }
+    lexer->pending_dedents = dedent_count - 1;
+    token_type = lexer->dedent_type;
+emit:
+    *OUT_token = lxl_lexer__start_token(lexer);
+    OUT_token->token_type = token_type;
+    lxl_lexer__finish_token(lexer, OUT_token);
+    return true;
+}
+
 // END LEXER FUNCTIONS.
 
 // STRING VIEW FUNCTIONS.
@@ -1521,6 +3208,2354 @@ bool lxl_region__align(struct lxl_region *region) {
 
 // END REGION FUNCTIONS.
 
+// CONFIG PUBLICATION FUNCTIONS.
+
+#ifdef LXL_HAS_CONFIG_PUBLICATION
+
+void lxl_config_slot_init(struct lxl_config_slot *slot, const struct lxl_lexer *config) {
+    atomic_init(&slot->config, config);
+    atomic_init(&slot->epoch, 0);
+    atomic_init(&slot->reader_counts[0], 0);
+    atomic_init(&slot->reader_counts[1], 0);
+}
+
+struct lxl_config_ref lxl_config_acquire(struct lxl_config_slot *slot) {
+    unsigned parity;
+    for (;;) {
+        unsigned epoch = atomic_load(&slot->epoch);
+        parity = epoch & 1;
+        atomic_fetch_add(&slot->reader_counts[parity], 1);
+        // If a writer flipped the epoch in the meantime, it may not be waiting for us. Retry.
+        if (atomic_load(&slot->epoch) == epoch) break;
+        atomic_fetch_sub(&slot->reader_counts[parity], 1);
+    }
+    return (struct lxl_config_ref) {.config = atomic_load(&slot->config), .parity = parity};
+}
+
+void lxl_config_release(struct lxl_config_slot *slot, struct lxl_config_ref ref) {
+    LXL_ASSERT(ref.parity <= 1);
+    unsigned previous_count = atomic_fetch_sub(&slot->reader_counts[ref.parity], 1);
+    LXL_ASSERT(previous_count > 0 && "Configuration reference released too many times.");
+    (void)previous_count;
+}
+
+const struct lxl_lexer *lxl_config_publish(struct lxl_config_slot *slot, const struct lxl_lexer *config) {
+    LXL_ASSERT(lxl_config_is_quiescent(slot) && "Configuration published twice in one grace period.");
+    const struct lxl_lexer *old_config = atomic_exchange(&slot->config, config);
+    // Readers registered under the old parity may hold `old_config`; new readers use the new parity.
+    atomic_fetch_add(&slot->epoch, 1);
+    return old_config;
+}
+
+bool lxl_config_is_quiescent(struct lxl_config_slot *slot) {
+    unsigned old_parity = (atomic_load(&slot->epoch) - 1) & 1;
+    return atomic_load(&slot->reader_counts[old_parity]) == 0;
+}
+
+void lxl_config_synchronize(struct lxl_config_slot *slot) {
+    while (!lxl_config_is_quiescent(slot)) {
+        /* Spin. */
+    }
+}
+
+#endif  // LXL_HAS_CONFIG_PUBLICATION
+
+// END CONFIG PUBLICATION FUNCTIONS.
+
+// TOKEN STREAM FUNCTIONS.
+
+uint64_t lxl_source_hash(struct lxl_string_view source) {
+    // 64-bit FNV-1a.
+    uint64_t hash = 0xcbf29ce484222325u;
+    for (size_t i = 0; i < source.length; ++i) {
+        hash ^= (unsigned char)source.start[i];
+        hash *= 0x100000001b3u;
+    }
+    return hash;
+}
+
+size_t lxl_token_stream_record_size(unsigned flags) {
+    size_t size = sizeof(int32_t) + 2 * sizeof(uint32_t);  // Type, offset, length.
+    if (flags & LXL_TSF_LOCATIONS) size += 2 * sizeof(int32_t);  // Line, column.
+    return size;
+}
+
+struct lxl_token_stream_writer lxl_token_stream_writer_new(void *buffer, size_t capacity,
+                                                           struct lxl_string_view source, unsigned flags) {
+    struct lxl_token_stream_writer writer = {
+        .data = buffer,
+        .capacity = capacity,
+        .size = sizeof(struct lxl_token_stream_header),
+        .source_start = source.start,
+        .source_end = LXL_SV_END(source),
+        .token_count = 0,
+        .flags = flags,
+        .overflowed = (capacity < sizeof(struct lxl_token_stream_header) || source.length > UINT32_MAX),
+    };
+    if (!writer.overflowed) {
+        struct lxl_token_stream_header header = {
+            .magic = {LXL_TOKEN_STREAM_MAGIC[0], LXL_TOKEN_STREAM_MAGIC[1],
+                      LXL_TOKEN_STREAM_MAGIC[2], LXL_TOKEN_STREAM_MAGIC[3]},
+            .version = LXL_TOKEN_STREAM_VERSION,
+            .flags = (uint16_t)flags,
+            .byte_order = LXL_TOKEN_STREAM_BYTE_ORDER,
+            .token_count = 0,
+            .source_length = source.length,
+            .source_hash = lxl_source_hash(source),
+        };
+        memcpy(writer.data, &header, sizeof header);
+    }
+    return writer;
+}
+
+// Return whether another record fits in the stream, marking the writer as overflowed if not.
+static bool lxl__token_stream_has_room(struct lxl_token_stream_writer *writer) {
+    if (writer->overflowed) return false;
+    size_t record_size = lxl_token_stream_record_size(writer->flags);
+    if (writer->size + record_size > writer->capacity || writer->token_count == UINT32_MAX) {
+        writer->overflowed = true;
+        return false;
+    }
+    return true;
+}
+
+bool lxl_token_stream_write_token(struct lxl_token_stream_writer *writer, struct lxl_token token) {
+    if (!lxl__token_stream_has_room(writer)) return false;
+    size_t record_size = lxl_token_stream_record_size(writer->flags);
+    LXL_ASSERT(writer->source_start <= token.start && token.start <= token.end);
+    LXL_ASSERT(token.end <= writer->source_end);
+    int32_t fields[5] = {
+        token.token_type,
+        (int32_t)(uint32_t)(token.start - writer->source_start),
+        (int32_t)(uint32_t)(token.end - token.start),
+        token.loc.line,
+        token.loc.column,
+    };
+    memcpy(&writer->data[writer->size], fields, record_size);
+    writer->size += record_size;
+    ++writer->token_count;
+    return true;
+}
+
+size_t lxl_token_stream_write_lexer(struct lxl_token_stream_writer *writer, struct lxl_lexer *lexer) {
+    size_t count = 0;
+    // Check for room before lexing, so that a token is never lexed without being written.
+    while (lxl__token_stream_has_room(writer)) {
+        struct lxl_token token = lxl_lexer_next_token(lexer);
+        lxl_token_stream_write_token(writer, token);
+        ++count;
+        if (LXL_TOKEN_IS_END(token)) break;
+    }
+    return count;
+}
+
+size_t lxl_token_stream_finish(struct lxl_token_stream_writer *writer) {
+    if (writer->overflowed) return 0;
+    memcpy(&writer->data[offsetof(struct lxl_token_stream_header, token_count)],
+           &writer->token_count, sizeof writer->token_count);
+    return writer->size;
+}
+
+bool lxl_token_stream_reader_init(struct lxl_token_stream_reader *reader, const void *data, size_t size,
+                                  struct lxl_string_view source) {
+    struct lxl_token_stream_header header;
+    if (size < sizeof header) return false;
+    memcpy(&header, data, sizeof header);
+    if (memcmp(header.magic, LXL_TOKEN_STREAM_MAGIC, sizeof header.magic) != 0) return false;
+    if (header.version != LXL_TOKEN_STREAM_VERSION) return false;
+    if (header.byte_order != LXL_TOKEN_STREAM_BYTE_ORDER) return false;
+    if (header.flags & ~LXL_TSF_ALL) return false;
+    if (header.source_length != source.length) return false;
+    size_t record_size = lxl_token_stream_record_size(header.flags);
+    if ((size - sizeof header) / record_size < header.token_count) return false;  // Truncated.
+    // Check that every value lies within the source (the stream may be corrupt or stale).
+    const char *records = (const char *)data + sizeof header;
+    for (uint32_t i = 0; i < header.token_count; ++i) {
+        uint32_t offset_length[2];
+        memcpy(offset_length, &records[(size_t)i * record_size + sizeof(int32_t)], sizeof offset_length);
+        if (offset_length[0] > source.length || offset_length[1] > source.length - offset_length[0]) {
+            return false;
+        }
+    }
+    *reader = (struct lxl_token_stream_reader) {
+        .records = records,
+        .record_size = record_size,
+        .token_count = header.token_count,
+        .index = 0,
+        .source_start = source.start,
+        .source_end = LXL_SV_END(source),
+        .flags = header.flags,
+    };
+    return true;
+}
+
+struct lxl_token lxl_token_stream_reader_next_token(struct lxl_token_stream_reader *reader) {
+    if (lxl_token_stream_reader_is_finished(reader)) {
+        // Repeat the final token if it was an end token, else synthesise one.
+        if (reader->token_count > 0) {
+            struct lxl_token last = lxl_token_stream_reader_token_at(reader, reader->token_count - 1);
+            if (LXL_TOKEN_IS_END(last)) return last;
+        }
+        return (struct lxl_token) {
+            .start = reader->source_end,
+            .end = reader->source_end,
+            .loc = {-1, -1},
+            .token_type = LXL_TOKENS_END,
+        };
+    }
+    return lxl_token_stream_reader_token_at(reader, reader->index++);
+}
+
+bool lxl_token_stream_reader_is_finished(struct lxl_token_stream_reader *reader) {
+    return reader->index >= reader->token_count;
+}
+
+void lxl_token_stream_reader_reset(struct lxl_token_stream_reader *reader) {
+    reader->index = 0;
+}
+
+struct lxl_token lxl_token_stream_reader_token_at(struct lxl_token_stream_reader *reader, uint32_t index) {
+    LXL_ASSERT(index < reader->token_count);
+    int32_t fields[5] = {0, 0, 0, -1, -1};
+    memcpy(fields, &reader->records[(size_t)index * reader->record_size], reader->record_size);
+    const char *start = reader->source_start + (uint32_t)fields[1];
+    return (struct lxl_token) {
+        .start = start,
+        .end = start + (uint32_t)fields[2],
+        .loc = {fields[3], fields[4]},
+        .token_type = fields[0],
+    };
+}
+
+// END TOKEN STREAM FUNCTIONS.
+
+// FINGERPRINT FUNCTIONS.
+
+static uint64_t lxl__rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static uint64_t lxl__fmix64(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdu;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53u;
+    k ^= k >> 33;
+    return k;
+}
+
+#define LXL__MURMUR_C1 0x87c37b91114253d5u
+#define LXL__MURMUR_C2 0x4cf5ad432745937fu
+
+static void lxl__hasher_block(struct lxl_hasher *hasher, const unsigned char *block) {
+    uint64_t k1, k2;
+    memcpy(&k1, block, sizeof k1);
+    memcpy(&k2, block + sizeof k1, sizeof k2);
+    k1 *= LXL__MURMUR_C1; k1 = lxl__rotl64(k1, 31); k1 *= LXL__MURMUR_C2; hasher->h1 ^= k1;
+    hasher->h1 = lxl__rotl64(hasher->h1, 27); hasher->h1 += hasher->h2; hasher->h1 = hasher->h1*5 + 0x52dce729;
+    k2 *= LXL__MURMUR_C2; k2 = lxl__rotl64(k2, 33); k2 *= LXL__MURMUR_C1; hasher->h2 ^= k2;
+    hasher->h2 = lxl__rotl64(hasher->h2, 31); hasher->h2 += hasher->h1; hasher->h2 = hasher->h2*5 + 0x38495ab5;
+}
+
+void lxl_hasher_init(struct lxl_hasher *hasher, uint64_t seed) {
+    *hasher = (struct lxl_hasher) {.h1 = seed, .h2 = seed, .buffer_length = 0, .total_length = 0};
+}
+
+void lxl_hasher_update(struct lxl_hasher *hasher, const void *data, size_t length) {
+    const unsigned char *bytes = data;
+    hasher->total_length += length;
+    if (hasher->buffer_length > 0) {
+        size_t fill = sizeof hasher->buffer - hasher->buffer_length;
+        if (fill > length) fill = length;
+        memcpy(&hasher->buffer[hasher->buffer_length], bytes, fill);
+        hasher->buffer_length += fill;
+        bytes += fill;
+        length -= fill;
+        if (hasher->buffer_length < sizeof hasher->buffer) return;
+        lxl__hasher_block(hasher, hasher->buffer);
+        hasher->buffer_length = 0;
+    }
+    for (; length >= sizeof hasher->buffer; bytes += sizeof hasher->buffer, length -= sizeof hasher->buffer) {
+        lxl__hasher_block(hasher, bytes);
+    }
+    memcpy(hasher->buffer, bytes, length);
+    hasher->buffer_length = length;
+}
+
+struct lxl_hash128 lxl_hasher_final(const struct lxl_hasher *hasher) {
+    uint64_t h1 = hasher->h1, h2 = hasher->h2;
+    // Tail.
+    unsigned char tail[16] = {0};
+    memcpy(tail, hasher->buffer, hasher->buffer_length);
+    uint64_t k1, k2;
+    memcpy(&k1, tail, sizeof k1);
+    memcpy(&k2, tail + sizeof k1, sizeof k2);
+    if (hasher->buffer_length > 8) {
+        k2 *= LXL__MURMUR_C2; k2 = lxl__rotl64(k2, 33); k2 *= LXL__MURMUR_C1; h2 ^= k2;
+    }
+    if (hasher->buffer_length > 0) {
+        k1 *= LXL__MURMUR_C1; k1 = lxl__rotl64(k1, 31); k1 *= LXL__MURMUR_C2; h1 ^= k1;
+    }
+    // Finalisation.
+    h1 ^= hasher->total_length;
+    h2 ^= hasher->total_length;
+    h1 += h2;
+    h2 += h1;
+    h1 = lxl__fmix64(h1);
+    h2 = lxl__fmix64(h2);
+    h1 += h2;
+    h2 += h1;
+    return (struct lxl_hash128) {.low = h1, .high = h2};
+}
+
+bool lxl_hash128_equal(struct lxl_hash128 a, struct lxl_hash128 b) {
+    return a.low == b.low && a.high == b.high;
+}
+
+struct lxl_fingerprinter lxl_fingerprinter_new(void) {
+    struct lxl_fingerprinter fingerprinter = {
+        .trivia_type = LXL_TOKEN_LINE_ENDING,
+        .block_open_type = LXL_TOKEN_NO_TOKEN,
+        .block_close_type = LXL_TOKEN_NO_TOKEN,
+        .depth = 0,
+        .block_start = NULL,
+        .block_end = NULL,
+        .blocks = NULL,
+        .block_capacity = 0,
+        .block_count = 0,
+    };
+    lxl_hasher_init(&fingerprinter.hasher, 0);
+    lxl_hasher_init(&fingerprinter.block_hasher, 0);
+    return fingerprinter;
+}
+
+void lxl_fingerprinter_set_blocks(struct lxl_fingerprinter *fingerprinter, int open_type, int close_type,
+                                  struct lxl_block_fingerprint *blocks, size_t capacity) {
+    fingerprinter->block_open_type = open_type;
+    fingerprinter->block_close_type = close_type;
+    fingerprinter->blocks = blocks;
+    fingerprinter->block_capacity = capacity;
+}
+
+static void lxl__fingerprinter_end_block(struct lxl_fingerprinter *fingerprinter) {
+    if (fingerprinter->block_start == NULL) return;  // Empty block.
+    if (fingerprinter->block_count < fingerprinter->block_capacity) {
+        fingerprinter->blocks[fingerprinter->block_count] = (struct lxl_block_fingerprint) {
+            .start = fingerprinter->block_start,
+            .end = fingerprinter->block_end,
+            .hash = lxl_hasher_final(&fingerprinter->block_hasher),
+        };
+    }
+    ++fingerprinter->block_count;
+    fingerprinter->block_start = NULL;
+    lxl_hasher_init(&fingerprinter->block_hasher, 0);
+}
+
+void lxl_fingerprinter_add_token(struct lxl_fingerprinter *fingerprinter, struct lxl_token token) {
+    if (LXL_TOKEN_IS_END(token) || token.token_type == fingerprinter->trivia_type) return;
+    int32_t type = token.token_type;
+    uint32_t length = (uint32_t)(token.end - token.start);
+    lxl_hasher_update(&fingerprinter->hasher, &type, sizeof type);
+    lxl_hasher_update(&fingerprinter->hasher, &length, sizeof length);
+    lxl_hasher_update(&fingerprinter->hasher, token.start, length);
+    if (fingerprinter->blocks == NULL) return;
+    if (fingerprinter->block_start == NULL) fingerprinter->block_start = token.start;
+    fingerprinter->block_end = token.end;
+    lxl_hasher_update(&fingerprinter->block_hasher, &type, sizeof type);
+    lxl_hasher_update(&fingerprinter->block_hasher, &length, sizeof length);
+    lxl_hasher_update(&fingerprinter->block_hasher, token.start, length);
+    if (token.token_type == fingerprinter->block_open_type) {
+        ++fingerprinter->depth;
+    }
+    else if (token.token_type == fingerprinter->block_close_type && fingerprinter->depth > 0) {
+        if (--fingerprinter->depth == 0) lxl__fingerprinter_end_block(fingerprinter);
+    }
+}
+
+struct lxl_hash128 lxl_fingerprinter_finish(struct lxl_fingerprinter *fingerprinter) {
+    if (fingerprinter->blocks != NULL) lxl__fingerprinter_end_block(fingerprinter);
+    return lxl_hasher_final(&fingerprinter->hasher);
+}
+
+struct lxl_hash128 lxl_lexer_fingerprint(struct lxl_lexer *lexer, struct lxl_fingerprinter *fingerprinter) {
+    fingerprinter->trivia_type = lexer->line_ending_type;
+    for (;;) {
+        struct lxl_token token = lxl_lexer_next_token(lexer);
+        if (LXL_TOKEN_IS_END(token)) break;
+        lxl_fingerprinter_add_token(fingerprinter, token);
+    }
+    return lxl_fingerprinter_finish(fingerprinter);
+}
+
+// END FINGERPRINT FUNCTIONS.
+
+// PACKED TOKEN FUNCTIONS.
+
+static size_t lxl__varint_encode(unsigned char *out, uint64_t value) {
+    size_t length = 0;
+    while (value >= 0x80) {
+        out[length++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    out[length++] = (unsigned char)value;
+    return length;
+}
+
+static uint64_t lxl__varint_decode(const unsigned char **p) {
+    const unsigned char *q = *p;
+    if (*q < 0x80) {
+        // Fast path: single byte.
+        *p = q + 1;
+        return *q;
+    }
+    uint64_t value = 0;
+    int shift = 0;
+    do {
+        value |= (uint64_t)(*q & 0x7f) << shift;
+        shift += 7;
+    } while (*q++ & 0x80);
+    *p = q;
+    return value;
+}
+
+static uint64_t lxl__zigzag_encode(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static int64_t lxl__zigzag_decode(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+struct lxl_packed_tokens lxl_packed_tokens_new(const char *source_start, void *data, size_t capacity,
+                                               struct lxl_packed_skip *skips, size_t skip_capacity,
+                                               size_t skip_interval) {
+    LXL_ASSERT(skips == NULL || skip_interval > 0);
+    return (struct lxl_packed_tokens) {
+        .data = data,
+        .capacity = capacity,
+        .size = 0,
+        .skips = skips,
+        .skip_capacity = skip_capacity,
+        .skip_interval = skip_interval,
+        .token_count = 0,
+        .source_start = source_start,
+        .state = {.byte_offset = 0, .prev_start = 0, .prev_end = 0, .prev_loc = {0, 0}},
+        .overflowed = false,
+    };
+}
+
+// The maximum encoded size of a single token (five 64-bit varints).
+#define LXL__PACKED_TOKEN_MAX_SIZE 50
+
+// Return whether another token fits in the container, marking it as overflowed if not.
+static bool lxl__packed_tokens_has_room(struct lxl_packed_tokens *tokens) {
+    if (tokens->overflowed) return false;
+    bool needs_skip = tokens->skips != NULL && tokens->token_count % tokens->skip_interval == 0;
+    if (tokens->size + LXL__PACKED_TOKEN_MAX_SIZE > tokens->capacity
+        || (needs_skip && tokens->token_count / tokens->skip_interval >= tokens->skip_capacity)) {
+        tokens->overflowed = true;
+        return false;
+    }
+    return true;
+}
+
+// Return the column predicted for a token `offset_delta` bytes after the previous one on the same line.
+// An unknown column (-1) is predicted to stay unknown.
+static int lxl__packed_predict_column(const struct lxl_packed_skip *state, size_t offset_delta) {
+    if (state->prev_loc.column < 0) return state->prev_loc.column;
+    return state->prev_loc.column + (int)offset_delta;
+}
+
+bool lxl_packed_tokens_push(struct lxl_packed_tokens *tokens, struct lxl_token token) {
+    if (!lxl__packed_tokens_has_room(tokens)) return false;
+    if (tokens->skips != NULL && tokens->token_count % tokens->skip_interval == 0) {
+        size_t skip_index = tokens->token_count / tokens->skip_interval;
+        tokens->state.byte_offset = tokens->size;
+        tokens->skips[skip_index] = tokens->state;
+    }
+    struct lxl_packed_skip *state = &tokens->state;
+    size_t start = token.start - tokens->source_start;
+    size_t end = token.end - tokens->source_start;
+    LXL_ASSERT(start >= state->prev_end && end >= start);  // Tokens must be in order.
+    // The line delta is signed, as the line may be unknown (-1) or go backwards (e.g. tokens from hooks).
+    int line_delta = token.loc.line - state->prev_loc.line;
+    // On the same line, the column usually advances by the same amount as the offset.
+    int predicted_column = 0;
+    if (line_delta == 0) predicted_column = lxl__packed_predict_column(state, start - state->prev_start);
+    unsigned char *out = &tokens->data[tokens->size];
+    out += lxl__varint_encode(out, lxl__zigzag_encode(token.token_type));
+    out += lxl__varint_encode(out, start - state->prev_end);
+    out += lxl__varint_encode(out, end - start);
+    out += lxl__varint_encode(out, lxl__zigzag_encode(line_delta));
+    out += lxl__varint_encode(out, lxl__zigzag_encode(token.loc.column - predicted_column));
+    tokens->size = out - tokens->data;
+    state->prev_start = start;
+    state->prev_end = end;
+    state->prev_loc = token.loc;
+    ++tokens->token_count;
+    return true;
+}
+
+size_t lxl_packed_tokens_push_lexer(struct lxl_packed_tokens *tokens, struct lxl_lexer *lexer) {
+    size_t count = 0;
+    // Check for room before lexing, so that a token is never lexed without being added.
+    while (lxl__packed_tokens_has_room(tokens)) {
+        struct lxl_token token = lxl_lexer_next_token(lexer);
+        lxl_packed_tokens_push(tokens, token);
+        ++count;
+        if (LXL_TOKEN_IS_END(token)) break;
+    }
+    return count;
+}
+
+struct lxl_packed_cursor lxl_packed_cursor_new(const struct lxl_packed_tokens *tokens) {
+    return (struct lxl_packed_cursor) {
+        .tokens = tokens,
+        .index = 0,
+        .state = {.byte_offset = 0, .prev_start = 0, .prev_end = 0, .prev_loc = {0, 0}},
+    };
+}
+
+struct lxl_packed_cursor lxl_packed_cursor_at(const struct lxl_packed_tokens *tokens, size_t index) {
+    struct lxl_packed_cursor cursor = lxl_packed_cursor_new(tokens);
+    if (index > tokens->token_count) index = tokens->token_count;
+    if (tokens->skips != NULL && tokens->token_count > 0) {
+        size_t skip_index = index / tokens->skip_interval;
+        size_t last_skip = (tokens->token_count - 1) / tokens->skip_interval;
+        if (skip_index > last_skip) skip_index = last_skip;
+        cursor.index = skip_index * tokens->skip_interval;
+        cursor.state = tokens->skips[skip_index];
+    }
+    struct lxl_token token;
+    while (cursor.index < index && lxl_packed_cursor_next(&cursor, &token)) {
+        /* Do nothing. */
+    }
+    return cursor;
+}
+
+bool lxl_packed_cursor_next(struct lxl_packed_cursor *cursor, struct lxl_token *OUT_token) {
+    const struct lxl_packed_tokens *tokens = cursor->tokens;
+    if (cursor->index >= tokens->token_count) return false;
+    struct lxl_packed_skip *state = &cursor->state;
+    const unsigned char *p = &tokens->data[state->byte_offset];
+    int token_type = (int)lxl__zigzag_decode(lxl__varint_decode(&p));
+    size_t start = state->prev_end + lxl__varint_decode(&p);
+    size_t end = start + lxl__varint_decode(&p);
+    int line_delta = (int)lxl__zigzag_decode(lxl__varint_decode(&p));
+    int column = (int)lxl__zigzag_decode(lxl__varint_decode(&p));
+    if (line_delta == 0) column += lxl__packed_predict_column(state, start - state->prev_start);
+    struct lxl_location loc = {state->prev_loc.line + line_delta, column};
+    *OUT_token = (struct lxl_token) {
+        .start = tokens->source_start + start,
+        .end = tokens->source_start + end,
+        .loc = loc,
+        .token_type = token_type,
+    };
+    state->byte_offset = p - tokens->data;
+    state->prev_start = start;
+    state->prev_end = end;
+    state->prev_loc = loc;
+    ++cursor->index;
+    return true;
+}
+
+// END PACKED TOKEN FUNCTIONS.
+
+// CHECKPOINT FUNCTIONS.
+
+struct lxl_checkpoint lxl_lexer_save_checkpoint(struct lxl_lexer *lexer) {
+    return (struct lxl_checkpoint) {
+        .offset = lxl_lexer__head_length(lexer),
+        .pos = lexer->pos,
+        .previous_token_type = lexer->previous_token_type,
+        .status = lexer->status,
+        .bracket_depth = lexer->bracket_depth,
+        .line_indent = lexer->line_indent,
+        .indent_depth = lexer->indent_depth,
+        .pending_dedents = lexer->pending_dedents,
+    };
+}
+
+void lxl_lexer_restore_checkpoint(struct lxl_lexer *lexer, struct lxl_checkpoint checkpoint) {
+    LXL_ASSERT(checkpoint.offset <= (size_t)(lexer->end - lexer->start));
+    lexer->current = lexer->start + checkpoint.offset;
+    lexer->token_start = lexer->current;
+    lexer->pos = checkpoint.pos;
+    lexer->previous_token_type = checkpoint.previous_token_type;
+    lexer->status = checkpoint.status;
+    lexer->bracket_depth = checkpoint.bracket_depth;
+    lexer->line_indent = checkpoint.line_indent;
+    LXL_ASSERT(checkpoint.indent_depth == 0 || checkpoint.indent_depth <= lexer->indent_capacity);
+    lexer->indent_depth = checkpoint.indent_depth;
+    lexer->pending_dedents = checkpoint.pending_dedents;
+    lexer->error = LXL_LERR_OK;
+}
+
+struct lxl_checkpoint_table lxl_checkpoint_table_new(struct lxl_checkpoint *checkpoints, size_t capacity,
+                                                     size_t interval) {
+    return (struct lxl_checkpoint_table) {
+        .checkpoints = checkpoints,
+        .capacity = capacity,
+        .count = 0,
+        .interval = interval,
+    };
+}
+
+bool lxl_checkpoint_table_record(struct lxl_checkpoint_table *table, struct lxl_lexer *lexer) {
+    // The indent stack is not part of a checkpoint, so only record checkpoints where it is empty.
+    if (lexer->indent_depth != 0 || lexer->pending_dedents != 0) return true;
+    size_t offset = lxl_lexer__head_length(lexer);
+    if (table->count > 0) {
+        size_t last_offset = table->checkpoints[table->count - 1].offset;
+        if (offset < last_offset + table->interval) return true;  // Too soon.
+    }
+    if (table->count >= table->capacity) return false;
+    table->checkpoints[table->count++] = lxl_lexer_save_checkpoint(lexer);
+    return true;
+}
+
+size_t lxl_lexer_build_checkpoints(struct lxl_lexer *lexer, struct lxl_checkpoint_table *table) {
+    size_t count = 0;
+    for (;;) {
+        if (!lxl_checkpoint_table_record(table, lexer)) return 0;
+        struct lxl_token token = lxl_lexer_next_token(lexer);
+        ++count;
+        if (LXL_TOKEN_IS_END(token)) break;
+    }
+    return count;
+}
+
+const struct lxl_checkpoint *lxl_checkpoint_table_find(const struct lxl_checkpoint_table *table, size_t offset) {
+    // Binary search for the first checkpoint after `offset`.
+    size_t low = 0, high = table->count;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (table->checkpoints[mid].offset <= offset) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+    return (low > 0) ? &table->checkpoints[low - 1] : NULL;
+}
+
+// END CHECKPOINT FUNCTIONS.
+
+// SEMANTIC TOKEN FUNCTIONS.
+
+struct lxl_semantic_encoder lxl_semantic_encoder_new(const char *source_start, uint32_t *data, size_t capacity,
+                                                     const int *legend_types, int legend_type_count,
+                                                     const uint32_t *legend_modifiers) {
+    return (struct lxl_semantic_encoder) {
+        .data = data,
+        .capacity = capacity,
+        .size = 0,
+        .legend_types = legend_types,
+        .legend_type_count = legend_type_count,
+        .legend_modifiers = legend_modifiers,
+        .scan = source_start,
+        .scan_line = 0,
+        .scan_column = 0,
+        .prev_line = 0,
+        .prev_column = 0,
+        .overflowed = false,
+    };
+}
+
+// Return the number of UTF-16 code units contributed by a UTF-8 byte.
+static uint32_t lxl__utf16_units(unsigned char byte) {
+    if ((byte & 0xc0) == 0x80) return 0;  // Continuation byte.
+    return (byte >= 0xf0) ? 2 : 1;        // 4-byte sequences become surrogate pairs.
+}
+
+static void lxl__semantic_encoder_scan_to(struct lxl_semantic_encoder *encoder, const char *point) {
+    LXL_ASSERT(encoder->scan <= point);
+    for (const char *p = encoder->scan; p < point; ++p) {
+        if (*p == '\n') {
+            ++encoder->scan_line;
+            encoder->scan_column = 0;
+        }
+        else {
+            encoder->scan_column += lxl__utf16_units(*p);
+        }
+    }
+    encoder->scan = point;
+}
+
+static bool lxl__semantic_encoder_emit(struct lxl_semantic_encoder *encoder, uint32_t line, uint32_t column,
+                                       uint32_t length, int token_type) {
+    if (length == 0) return true;
+    if (encoder->size + 5 > encoder->capacity) {
+        encoder->overflowed = true;
+        return false;
+    }
+    uint32_t *out = &encoder->data[encoder->size];
+    out[0] = line - encoder->prev_line;
+    out[1] = (line == encoder->prev_line) ? column - encoder->prev_column : column;
+    out[2] = length;
+    out[3] = (uint32_t)encoder->legend_types[token_type];
+    out[4] = (encoder->legend_modifiers) ? encoder->legend_modifiers[token_type] : 0;
+    encoder->size += 5;
+    encoder->prev_line = line;
+    encoder->prev_column = column;
+    return true;
+}
+
+bool lxl_semantic_encoder_add_token(struct lxl_semantic_encoder *encoder, struct lxl_token token) {
+    if (encoder->overflowed) return false;
+    int type = token.token_type;
+    if (type < 0 || type >= encoder->legend_type_count || encoder->legend_types[type] < 0) return true;
+    lxl__semantic_encoder_scan_to(encoder, token.start);
+    uint32_t line = encoder->scan_line;
+    uint32_t column = encoder->scan_column;
+    uint32_t length = 0;
+    for (const char *p = token.start; p < token.end; ++p) {
+        if (*p == '\n') {
+            // Split multiline tokens.
+            if (!lxl__semantic_encoder_emit(encoder, line, column, length, type)) return false;
+            ++line;
+            column = 0;
+            length = 0;
+        }
+        else {
+            length += lxl__utf16_units(*p);
+        }
+    }
+    if (!lxl__semantic_encoder_emit(encoder, line, column, length, type)) return false;
+    encoder->scan = token.end;
+    encoder->scan_line = line;
+    encoder->scan_column = column + length;
+    return true;
+}
+
+size_t lxl_semantic_encoder_encode_lexer(struct lxl_semantic_encoder *encoder, struct lxl_lexer *lexer) {
+    for (;;) {
+        struct lxl_token token = lxl_lexer_next_token(lexer);
+        if (LXL_TOKEN_IS_END(token)) break;
+        if (!lxl_semantic_encoder_add_token(encoder, token)) return 0;
+    }
+    return encoder->size;
+}
+
+// END SEMANTIC TOKEN FUNCTIONS.
+
+// TOKEN INDEX FUNCTIONS.
+
+// Return the 1-based index of the least significant set bit, or 0 if none are set.
+static int lxl__ffs(size_t x) {
+#ifdef __GNUC__
+    return __builtin_ffsll((long long)x);
+#else
+    if (x == 0) return 0;
+    int n = 1;
+    while (!(x & 1)) {
+        x >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+// Fill the Eytzinger array with an in-order traversal of the implicit tree rooted at `k`.
+static size_t lxl__token_index_fill(struct lxl_token_index *index, size_t k, size_t i) {
+    if (k > index->count) return i;
+    i = lxl__token_index_fill(index, 2*k, i);
+    index->keys[k] = (uint32_t)(index->tokens[i].start - index->source_start);
+    index->ranks[k] = (uint32_t)i;
+    return lxl__token_index_fill(index, 2*k + 1, i + 1);
+}
+
+bool lxl_token_index_build(struct lxl_token_index *index, const struct lxl_token *tokens, size_t count,
+                           const char *source_start, struct lxl_region *region) {
+    LXL_ASSERT(count < UINT32_MAX);
+    uint32_t *keys = lxl_region_allocate((count + 1) * sizeof *keys, region);
+    uint32_t *ranks = lxl_region_allocate((count + 1) * sizeof *ranks, region);
+    if (!keys || !ranks) return false;
+    *index = (struct lxl_token_index) {
+        .tokens = tokens,
+        .count = count,
+        .source_start = source_start,
+        .keys = keys,
+        .ranks = ranks,
+    };
+    keys[0] = 0;
+    ranks[0] = 0;
+    lxl__token_index_fill(index, 1, 0);
+    return true;
+}
+
+// Convert the final position of an Eytzinger search for the first key > offset into the covering token.
+static ptrdiff_t lxl__token_index_resolve(const struct lxl_token_index *index, size_t k, size_t offset) {
+    k >>= lxl__ffs(~k);  // Undo the final right turns to find the upper bound.
+    size_t upper = (k == 0) ? index->count : index->ranks[k];
+    if (upper == 0) return LXL_NO_TOKEN_INDEX;
+    const struct lxl_token *token = &index->tokens[upper - 1];
+    size_t end = token->end - index->source_start;
+    return (offset < end) ? (ptrdiff_t)(upper - 1) : LXL_NO_TOKEN_INDEX;
+}
+
+// Prefetch the keys four levels below `k`. The index is clamped to the last key, as forming a pointer past
+// the end of the array is undefined (and the clamp compiles to a conditional move).
+static inline void lxl__token_index_prefetch(const struct lxl_token_index *index, size_t k) {
+    size_t descendant = 16*k;
+    LXL__PREFETCH(&index->keys[(descendant <= index->count) ? descendant : index->count]);
+}
+
+ptrdiff_t lxl_token_index_find(const struct lxl_token_index *index, size_t offset) {
+    size_t k = 1;
+    while (k <= index->count) {
+        lxl__token_index_prefetch(index, k);
+        k = 2*k + (index->keys[k] <= offset);
+    }
+    return lxl__token_index_resolve(index, k, offset);
+}
+
+// The number of searches interleaved by `lxl_token_index_find_batch()`.
+#define LXL__TOKEN_INDEX_BATCH 8
+
+void lxl_token_index_find_batch(const struct lxl_token_index *index, const size_t *offsets, size_t count,
+                                ptrdiff_t *OUT_indices) {
+    size_t i = 0;
+    for (; i + LXL__TOKEN_INDEX_BATCH <= count; i += LXL__TOKEN_INDEX_BATCH) {
+        size_t k[LXL__TOKEN_INDEX_BATCH];
+        for (int j = 0; j < LXL__TOKEN_INDEX_BATCH; ++j) k[j] = 1;
+        // Every search takes the same number of steps (the tree depth) except at the last level.
+        for (size_t level = 1; level <= index->count; level *= 2) {
+            for (int j = 0; j < LXL__TOKEN_INDEX_BATCH; ++j) {
+                if (k[j] <= index->count) {
+                    lxl__token_index_prefetch(index, k[j]);
+                    k[j] = 2*k[j] + (index->keys[k[j]] <= offsets[i + j]);
+                }
+            }
+        }
+        for (int j = 0; j < LXL__TOKEN_INDEX_BATCH; ++j) {
+            OUT_indices[i + j] = lxl__token_index_resolve(index, k[j], offsets[i + j]);
+        }
+    }
+    for (; i < count; ++i) {
+        OUT_indices[i] = lxl_token_index_find(index, offsets[i]);
+    }
+}
+
+// END TOKEN INDEX FUNCTIONS.
+
+// BUDGETED LEXING FUNCTIONS.
+
+// Lex the next token without the lexer's hooks and rule profile, as the token may be un-lexed.
+static struct lxl_token lxl__budget_lex_speculatively(struct lxl_lexer *lexer) {
+    void (*before_unlex_int_hook)(struct lxl_lexer *) = lexer->before_unlex_int_hook;
+    void (*before_unlex_float_hook)(struct lxl_lexer *) = lexer->before_unlex_float_hook;
+    void (*after_token_hook)(struct lxl_lexer *, struct lxl_token *) = lexer->after_token_hook;
+    struct lxl_rule_profile *rule_profile = lexer->rule_profile;
+    lexer->before_unlex_int_hook = NULL;
+    lexer->before_unlex_float_hook = NULL;
+    lexer->after_token_hook = NULL;
+    lexer->rule_profile = NULL;
+    struct lxl_token token = lxl_lexer_next_token(lexer);
+    lexer->before_unlex_int_hook = before_unlex_int_hook;
+    lexer->before_unlex_float_hook = before_unlex_float_hook;
+    lexer->after_token_hook = after_token_hook;
+    lexer->rule_profile = rule_profile;
+    return token;
+}
+
+struct lxl_budget_result lxl_lexer_tokenize_budgeted(struct lxl_lexer *lexer, struct lxl_token *tokens,
+                                                     size_t capacity, struct lxl_budget budget) {
+    const char *real_end = lexer->end;
+    const char *start = lexer->current;
+    const char *byte_limit = real_end;
+    if (budget.max_bytes != 0 && budget.max_bytes < (size_t)(real_end - start)) {
+        byte_limit = start + budget.max_bytes;
+    }
+    size_t slice = (budget.poll_bytes != 0) ? budget.poll_bytes : LXL_BUDGET_POLL_BYTES;
+    if (budget.expired == NULL) slice = byte_limit - start;  // No need to poll.
+    if (slice < 2*LXL_BUDGET_LOOKAHEAD) slice = 2*LXL_BUDGET_LOOKAHEAD;
+    const size_t base_slice = slice;
+    if (lexer->budget_slice > slice) slice = lexer->budget_slice;  // The next token did not fit before.
+    const char *horizon = (slice < (size_t)(byte_limit - start)) ? start + slice : byte_limit;
+    bool has_hooks = lexer->before_unlex_int_hook || lexer->before_unlex_float_hook || lexer->after_token_hook
+                     || lexer->rule_profile;
+    bool progressed = false;  // Has lexing moved on since the horizon was last moved?
+    struct lxl_budget_result result = {.token_count = 0, .byte_count = 0, .status = LXL_BUDGET_FINISHED};
+    for (;;) {
+        if (lxl_lexer_is_finished(lexer)) {
+            result.status = LXL_BUDGET_FINISHED;
+            break;
+        }
+        if (result.token_count >= capacity) {
+            result.status = LXL_BUDGET_FULL;
+            break;
+        }
+        if (budget.max_tokens != 0 && result.token_count >= budget.max_tokens) {
+            result.status = LXL_BUDGET_EXHAUSTED;
+            break;
+        }
+        // Lex up to a little beyond the horizon: a token which ends before the horizon is then complete.
+        // Comment and string scans pause a lookahead before it, where their state does not depend on what
+        // follows the horizon.
+        const char *lex_end = ((size_t)(real_end - horizon) > LXL_BUDGET_LOOKAHEAD)
+                              ? horizon + LXL_BUDGET_LOOKAHEAD : real_end;
+        struct lxl_checkpoint checkpoint = lxl_lexer_save_checkpoint(lexer);
+        struct lxl_paused_scan paused_scan = lexer->paused_scan;
+        bool padded_input = lexer->padded_input;
+        lexer->end = lex_end;
+        lexer->padded_input = padded_input && lex_end == real_end;  // No sentinel at the horizon.
+        if (horizon != real_end) {
+            lexer->scan_pause = ((size_t)(horizon - lexer->current) > LXL_BUDGET_LOOKAHEAD)
+                                ? horizon - LXL_BUDGET_LOOKAHEAD : lexer->current;
+        }
+        struct lxl_token token = lxl__budget_lex_speculatively(lexer);
+        bool complete = lexer->current <= byte_limit && (lex_end == real_end || lexer->current <= horizon);
+        if (complete && has_hooks) {
+            // Lex the token again with the hooks (and rule profile) it was lexed without.
+            lxl_lexer_restore_checkpoint(lexer, checkpoint);
+            lexer->paused_scan = paused_scan;
+            token = lxl_lexer_next_token(lexer);
+        }
+        lexer->end = real_end;
+        lexer->padded_input = padded_input;
+        lexer->scan_pause = NULL;
+        bool paused = lexer->paused_scan.delims != NULL;
+        if (complete && !paused) {
+            if (!LXL_TOKEN_IS_END(token)) tokens[result.token_count++] = token;
+            progressed = true;
+            continue;
+        }
+        if (complete) {
+            // Paused in a comment or string: go on with the next slice.
+            progressed = true;
+            slice = base_slice;
+        }
+        else {
+            // The token may continue beyond the horizon. Un-lex it and move the horizon.
+            bool beyond_limit = lexer->current > byte_limit;
+            lxl_lexer_restore_checkpoint(lexer, checkpoint);
+            lexer->paused_scan = paused_scan;
+            if (horizon == byte_limit || beyond_limit) {
+                result.status = LXL_BUDGET_EXHAUSTED;
+                break;
+            }
+            // Grow the slice only while a single token is larger than it.
+            slice = (progressed) ? base_slice : 2*slice;
+            progressed = false;
+        }
+        if (budget.expired && budget.expired(budget.user_data)) {
+            result.status = LXL_BUDGET_EXPIRED;
+            break;
+        }
+        horizon = (slice < (size_t)(byte_limit - lexer->current)) ? lexer->current + slice : byte_limit;
+    }
+    lexer->budget_slice = (progressed) ? 0 : slice;
+    result.byte_count = lexer->current - start;
+    return result;
+}
+
+// END BUDGETED LEXING FUNCTIONS.
+
+// RULE PROFILE FUNCTIONS.
+
+// Group the strings by first byte (keeping their declared order within each group).
+static void lxl__group_by_first_byte(const char *const *strings, int count, uint16_t *order,
+                                     uint16_t *groups) {
+    for (int c = 0; c <= 256; ++c) groups[c] = 0;
+    for (int i = 0; i < count; ++i) ++groups[(unsigned char)strings[i][0] + 1];
+    for (int c = 0; c < 256; ++c) groups[c + 1] += groups[c];
+    uint16_t next[256];
+    for (int c = 0; c < 256; ++c) next[c] = groups[c];
+    for (int i = 0; i < count; ++i) order[next[(unsigned char)strings[i][0]]++] = (uint16_t)i;
+}
+
+// Must `a` stay before `b`? Puncts must if either is a prefix of the other; keywords if they are equal.
+static bool lxl__must_precede(const char *a, const char *b, bool is_punct) {
+    if (!is_punct) return strcmp(a, b) == 0;
+    size_t a_length = strlen(a);
+    size_t b_length = strlen(b);
+    return strncmp(a, b, (a_length < b_length) ? a_length : b_length) == 0;
+}
+
+// Re-order a group by descending hit count (ties in declared order). Each position is filled with the most
+// frequent remaining candidate which no remaining candidate declared before it must precede.
+static void lxl__reorder_group(uint16_t *order, int count, const uint32_t *hits, const char *const *strings,
+                               bool is_punct) {
+    for (int i = 0; i < count; ++i) {
+        int best = -1;
+        for (int j = i; j < count; ++j) {
+            if (best >= 0 && (hits[order[j]] < hits[order[best]]
+                              || (hits[order[j]] == hits[order[best]] && order[j] > order[best]))) {
+                continue;
+            }
+            bool is_free = true;
+            for (int k = i; k < count && is_free; ++k) {
+                is_free = !(order[k] < order[j]
+                            && lxl__must_precede(strings[order[k]], strings[order[j]], is_punct));
+            }
+            if (is_free) best = j;
+        }
+        LXL_ASSERT(best >= 0);  // The earliest declared remaining candidate is always free.
+        // Move the best candidate to position i, keeping the others in order.
+        uint16_t chosen = order[best];
+        for (int j = best; j > i; --j) order[j] = order[j - 1];
+        order[i] = chosen;
+    }
+}
+
+bool lxl_rule_profile_init(struct lxl_rule_profile *profile, struct lxl_lexer *lexer, uint32_t interval,
+                           struct lxl_region *region) {
+    size_t punct_count = 0;
+    size_t keyword_count = 0;
+    if (lexer->puncts != NULL) {
+        while (lexer->puncts[punct_count] != NULL) ++punct_count;
+    }
+    if (lexer->keywords != NULL) {
+        while (lexer->keywords[keyword_count] != NULL) ++keyword_count;
+    }
+    if (punct_count > UINT16_MAX || keyword_count > UINT16_MAX) return false;
+    uint32_t *punct_hits = lxl_region_allocate((punct_count + 1) * sizeof *punct_hits, region);
+    uint32_t *keyword_hits = lxl_region_allocate((keyword_count + 1) * sizeof *keyword_hits, region);
+    uint16_t *punct_order = lxl_region_allocate((punct_count + 1) * sizeof *punct_order, region);
+    uint16_t *keyword_order = lxl_region_allocate((keyword_count + 1) * sizeof *keyword_order, region);
+    if (punct_hits == NULL || keyword_hits == NULL || punct_order == NULL || keyword_order == NULL) {
+        return false;
+    }
+    profile->puncts = lexer->puncts;
+    profile->keywords = lexer->keywords;
+    profile->punct_count = (uint16_t)punct_count;
+    profile->keyword_count = (uint16_t)keyword_count;
+    profile->punct_hits = punct_hits;
+    profile->keyword_hits = keyword_hits;
+    profile->punct_order = punct_order;
+    profile->keyword_order = keyword_order;
+    memset(punct_hits, 0, punct_count * sizeof *punct_hits);
+    memset(keyword_hits, 0, keyword_count * sizeof *keyword_hits);
+    lxl__group_by_first_byte(lexer->puncts, punct_count, punct_order, profile->punct_groups);
+    lxl__group_by_first_byte(lexer->keywords, keyword_count, keyword_order, profile->keyword_groups);
+    profile->interval = interval;
+    profile->countdown = interval;
+    lexer->rule_profile = profile;
+    return true;
+}
+
+void lxl_rule_profile_reorder(struct lxl_rule_profile *profile) {
+    for (int c = 0; c < 256; ++c) {
+        int start = profile->punct_groups[c];
+        lxl__reorder_group(&profile->punct_order[start], profile->punct_groups[c + 1] - start,
+                           profile->punct_hits, profile->puncts, true);
+        start = profile->keyword_groups[c];
+        lxl__reorder_group(&profile->keyword_order[start], profile->keyword_groups[c + 1] - start,
+                           profile->keyword_hits, profile->keywords, false);
+    }
+    for (int i = 0; i < profile->punct_count; ++i) profile->punct_hits[i] /= 2;
+    for (int i = 0; i < profile->keyword_count; ++i) profile->keyword_hits[i] /= 2;
+    profile->countdown = profile->interval;
+}
+
+size_t lxl_rule_profile_size(const struct lxl_rule_profile *profile) {
+    return (size_t)profile->punct_count + profile->keyword_count;
+}
+
+void lxl_rule_profile_export(const struct lxl_rule_profile *profile, uint32_t *OUT_counts) {
+    memcpy(OUT_counts, profile->punct_hits, profile->punct_count * sizeof *OUT_counts);
+    memcpy(OUT_counts + profile->punct_count, profile->keyword_hits,
+           profile->keyword_count * sizeof *OUT_counts);
+}
+
+bool lxl_rule_profile_import(struct lxl_rule_profile *profile, const uint32_t *counts, size_t count) {
+    if (count != lxl_rule_profile_size(profile)) return false;
+    memcpy(profile->punct_hits, counts, profile->punct_count * sizeof *counts);
+    memcpy(profile->keyword_hits, counts + profile->punct_count, profile->keyword_count * sizeof *counts);
+    lxl_rule_profile_reorder(profile);
+    return true;
+}
+
+// END RULE PROFILE FUNCTIONS.
+
+// RULE INDEX FUNCTIONS.
+
+// Set `OUT_groups` (of 257 entries) for `strings`, which must be sorted by their first byte. Return false if
+// they are not sorted or there are too many of them.
+static bool lxl__index_groups(const char *const *strings, uint16_t *OUT_groups) {
+    size_t count = 0;
+    int c = 0;
+    OUT_groups[0] = 0;
+    for (; strings != NULL && strings[count] != NULL; ++count) {
+        int first = (unsigned char)strings[count][0];
+        if (first == '\0' || first < c || count >= UINT16_MAX) return false;
+        while (c < first) OUT_groups[++c] = (uint16_t)count;
+    }
+    while (c < 256) OUT_groups[++c] = (uint16_t)count;
+    return true;
+}
+
+bool lxl_rule_index_init(struct lxl_rule_index *index, const struct lxl_lexer *lexer) {
+    if (!lxl__index_groups(lexer->puncts, index->punct_groups)) return false;
+    if (!lxl__index_groups(lexer->keywords, index->keyword_groups)) return false;
+    lxl__reserved_table(lexer, index->reserved_bytes);
+    return true;
+}
+
+// END RULE INDEX FUNCTIONS.
+
+// STRUCTURAL INDEX FUNCTIONS.
+
+#ifdef __SSE2__
+#include <emmintrin.h>   // _mm_cmpeq_epi8(), _mm_movemask_epi8() et al.
+#endif
+
+// Return the number of trailing zero bits in a non-zero word.
+static int lxl__ctz64(uint64_t x) {
+    LXL_ASSERT(x != 0);
+#ifdef __GNUC__
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+    while (!(x & 1)) {
+        x >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+// Return the index of the most significant set bit of a non-zero word.
+static int lxl__msb64(uint64_t x) {
+    LXL_ASSERT(x != 0);
+#ifdef __GNUC__
+    return 63 - __builtin_clzll(x);
+#else
+    int n = 0;
+    while (x >>= 1) ++n;
+    return n;
+#endif
+}
+
+static int lxl__popcount64(uint64_t x) {
+#ifdef __GNUC__
+    return __builtin_popcountll(x);
+#else
+    int n = 0;
+    for (; x != 0; x &= x - 1) ++n;
+    return n;
+#endif
+}
+
+// Return the mask of bytes in the block equal to any character in `chars`.
+static uint64_t lxl__block_mask(const char *block, const char *chars) {
+    uint64_t mask = 0;
+#ifdef __SSE2__
+    __m128i lanes[4];
+    for (int i = 0; i < 4; ++i) lanes[i] = _mm_loadu_si128((const __m128i *)(block + 16*i));
+    for (; *chars != '\0'; ++chars) {
+        __m128i needle = _mm_set1_epi8(*chars);
+        for (int i = 0; i < 4; ++i) {
+            uint64_t bits = (uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(lanes[i], needle));
+            mask |= bits << (16*i);
+        }
+    }
+#else
+    for (int i = 0; i < LXL_STRUCTURAL_BLOCK; ++i) {
+        if (block[i] != '\0' && strchr(chars, block[i]) != NULL) mask |= (uint64_t)1 << i;
+    }
+#endif
+    return mask;
+}
+
+// Return the mask of bytes escaped by an (unescaped) escape character. `carry` is set on entry if the first
+// byte is escaped by the previous block, and on exit if the next block's first byte is escaped.
+static uint64_t lxl__escaped_bytes(uint64_t escapes, bool *carry) {
+    uint64_t escaped = (*carry) ? 1 : 0;
+    escapes &= ~escaped;
+    *carry = false;
+    while (escapes != 0) {
+        uint64_t bit = escapes & (~escapes + 1);  // The lowest set bit.
+        if (bit >> 63) {
+            *carry = true;
+            break;
+        }
+        escaped |= bit << 1;
+        escapes &= ~(bit | bit << 1);
+    }
+    return escaped;
+}
+
+// Return the single quote character if the lexer's strings can be indexed, '\0' if it has no strings,
+// or -1 if strings cannot be indexed.
+static int lxl__structural_quote(const struct lxl_lexer *lexer) {
+    const struct lxl_delim_pair *delims = NULL;
+    int delim_count = 0;
+    if (LXL_HAS_FEATURE(LXL_FEATURE_LINE_STRINGS) && lexer->line_string_delims != NULL) {
+        for (const struct lxl_delim_pair *d = lexer->line_string_delims; d->opener != NULL;
+             ++d, ++delim_count) {
+            delims = d;
+        }
+    }
+    if (LXL_HAS_FEATURE(LXL_FEATURE_MULTILINE_STRINGS) && lexer->multiline_string_delims != NULL) {
+        for (const struct lxl_delim_pair *d = lexer->multiline_string_delims; d->opener != NULL;
+             ++d, ++delim_count) {
+            delims = d;
+        }
+    }
+    if (delim_count == 0) return '\0';
+    if (delim_count > 1) return -1;
+    if (strlen(delims->opener) != 1 || strcmp(delims->opener, delims->closer) != 0) return -1;
+    return (unsigned char)delims->opener[0];
+}
+
+bool lxl_structural_index_build(struct lxl_structural_index *index, struct lxl_lexer *lexer,
+                                struct lxl_region *region) {
+    size_t length = lexer->end - lexer->start;
+    size_t block_count = (length + LXL_STRUCTURAL_BLOCK - 1) / LXL_STRUCTURAL_BLOCK;
+    int quote = lxl__structural_quote(lexer);
+    size_t mask_size = (block_count + 1) * sizeof(uint64_t);
+    uint64_t *blank = lxl_region_allocate(mask_size, region);
+    uint64_t *lf = lxl_region_allocate(mask_size, region);
+    if (blank == NULL || lf == NULL) return false;
+    uint64_t *quotes = NULL;
+    if (quote > 0) {
+        quotes = lxl_region_allocate(mask_size, region);
+        if (quotes == NULL) return false;
+    }
+    const char quote_chars[2] = {(char)((quote > 0) ? quote : 0), '\0'};
+    const char *escape_chars = "";
+    if (quote > 0 && lexer->string_escape_chars != NULL) escape_chars = lexer->string_escape_chars;
+    bool escape_carry = false;
+    for (size_t b = 0; b < block_count; ++b) {
+        const char *block = lexer->start + b*LXL_STRUCTURAL_BLOCK;
+        char last_block[LXL_STRUCTURAL_BLOCK];
+        size_t block_length = length - b*LXL_STRUCTURAL_BLOCK;
+        uint64_t valid = ~(uint64_t)0;
+        if (block_length < LXL_STRUCTURAL_BLOCK) {
+            // Pad the last block with NULs, which belong to no class.
+            memset(last_block, 0, sizeof last_block);
+            memcpy(last_block, block, block_length);
+            block = last_block;
+            valid = ((uint64_t)1 << block_length) - 1;
+        }
+        blank[b] = lxl__block_mask(block, LXL_WHITESPACE_CHARS_NO_LF) & valid;
+        lf[b] = lxl__block_mask(block, "\n") & valid;
+        if (quotes == NULL) continue;
+        uint64_t escaped = lxl__escaped_bytes(lxl__block_mask(block, escape_chars) & valid, &escape_carry);
+        quotes[b] = lxl__block_mask(block, quote_chars) & valid & ~escaped;
+    }
+    index->start = lexer->start;
+    index->length = length;
+    index->block_count = block_count;
+    index->blank = blank;
+    index->lf = lf;
+    index->quotes = quotes;
+    lexer->structural_index = index;
+    return true;
+}
+
+void lxl_lexer__skip_indexed_whitespace(struct lxl_lexer *lexer, bool lf_is_whitespace) {
+    const struct lxl_structural_index *index = lexer->structural_index;
+    if (index->start != lexer->start) return;  // The index is for another input.
+    size_t offset = lexer->current - lexer->start;
+    size_t length = lexer->end - lexer->start;
+    if (length > index->length) length = index->length;
+    while (offset < length) {
+        size_t b = offset / LXL_STRUCTURAL_BLOCK;
+        int bit = offset % LXL_STRUCTURAL_BLOCK;
+        uint64_t lf = (lf_is_whitespace) ? index->lf[b] : 0;
+        uint64_t stops = ~(index->blank[b] | lf) >> bit;
+        size_t run = (stops != 0) ? (size_t)lxl__ctz64(stops) : (size_t)(LXL_STRUCTURAL_BLOCK - bit);
+        if (run > length - offset) run = length - offset;
+        if (run == 0) break;
+        // Count the LFs in the run; the column restarts after the last one.
+        uint64_t run_mask = (run == 64) ? ~(uint64_t)0 : (((uint64_t)1 << run) - 1) << bit;
+        uint64_t lfs = lf & run_mask;
+        if (lfs != 0) {
+            lexer->pos.line += lxl__popcount64(lfs);
+            lexer->pos.column = bit + (int)run - lxl__msb64(lfs) - 1;
+        }
+        else {
+            lexer->pos.column += (int)run;
+        }
+        offset += run;
+        if ((size_t)bit + run < LXL_STRUCTURAL_BLOCK) break;  // Stopped within the block.
+    }
+    lexer->current = lexer->start + offset;
+}
+
+bool lxl_lexer__skip_indexed_string(struct lxl_lexer *lexer, const char *closer) {
+    const struct lxl_structural_index *index = lexer->structural_index;
+    if (index->quotes == NULL || index->start != lexer->start) return false;
+    // The index only holds the quotes of a single-character delimiter opened and closed alike.
+    if (closer[0] == '\0' || closer[1] != '\0' || lexer->current == lexer->start
+        || lexer->current[-1] != closer[0]) {
+        return false;
+    }
+    if (lexer->string_escape_chars != NULL && strchr(lexer->string_escape_chars, closer[0]) != NULL) {
+        return false;
+    }
+    size_t length = lexer->end - lexer->start;
+    if (length > index->length) length = index->length;
+    size_t opener = lexer->current - lexer->start - 1;
+    size_t b = opener / LXL_STRUCTURAL_BLOCK;
+    int bit = opener % LXL_STRUCTURAL_BLOCK;
+    // The opener must be a quote bit, so that the closer is the quote the index holds. (An opener escaped
+    // outside a string, where the lexer has no escapes, is lexed byte by byte.)
+    if (!((index->quotes[b] >> bit) & 1)) return false;
+    // Find the next quote, and give up on an LF before it: line strings end there, and multiline strings
+    // would need their lines counted.
+    uint64_t above = (bit == 63) ? 0 : ~(uint64_t)0 << (bit + 1);
+    uint64_t quotes = index->quotes[b] & above;
+    uint64_t lfs = index->lf[b] & above;
+    while (quotes == 0) {
+        if (lfs != 0 || ++b >= index->block_count) return false;
+        quotes = index->quotes[b];
+        lfs = index->lf[b];
+    }
+    uint64_t first_quote = quotes & (~quotes + 1);
+    if ((lfs & (first_quote - 1)) != 0) return false;
+    size_t closer_offset = b*LXL_STRUCTURAL_BLOCK + lxl__ctz64(quotes);
+    if (closer_offset >= length) return false;
+    // A NUL ends the string for the lexer.
+    const char *string_end = lexer->start + closer_offset;
+    if (memchr(lexer->current, '\0', string_end - lexer->current) != NULL) return false;
+    lexer->pos.column += (int)(string_end + 1 - lexer->current);
+    lexer->current = string_end + 1;
+    return true;
+}
+
+// END STRUCTURAL INDEX FUNCTIONS.
+
+// BRACKET PAIR FUNCTIONS.
+
+// Return whether the token's value is equal to `s`.
+static bool lxl__token_equals(struct lxl_token token, const char *s) {
+    size_t length = token.end - token.start;
+    return s[0] == token.start[0] && strlen(s) == length && memcmp(token.start, s, length) == 0;
+}
+
+bool lxl_bracket_pairer_init(struct lxl_bracket_pairer *pairer, const struct lxl_delim_pair *brackets,
+                             ptrdiff_t *partners, size_t capacity, struct lxl_region *region) {
+    size_t pair_count = 0;
+    while (brackets != NULL && brackets[pair_count].opener != NULL) ++pair_count;
+    size_t alloc_count = region->alloc_count;
+    struct lxl_open_bracket *stack = lxl_region_allocate((capacity + 1) * sizeof *stack, region);
+    size_t *open_counts = lxl_region_allocate((pair_count + 1) * sizeof *open_counts, region);
+    if (stack == NULL || open_counts == NULL) {
+        region->alloc_count = alloc_count;
+        return false;
+    }
+    for (size_t i = 0; i < pair_count; ++i) open_counts[i] = 0;
+    *pairer = (struct lxl_bracket_pairer) {
+        .brackets = brackets,
+        .partners = partners,
+        .capacity = capacity,
+        .token_count = 0,
+        .stack = stack,
+        .depth = 0,
+        .open_counts = open_counts,
+        .unmatched_count = 0,
+    };
+    return true;
+}
+
+bool lxl_bracket_pairer_add(struct lxl_bracket_pairer *pairer, struct lxl_token token) {
+    if (pairer->token_count >= pairer->capacity) return false;
+    size_t index = pairer->token_count++;
+    pairer->partners[index] = LXL_BRACKET_NONE;
+    if (pairer->brackets == NULL || token.end == token.start || LXL_TOKEN_IS_ERROR(token)) return true;
+    for (size_t pair_index = 0; pairer->brackets[pair_index].opener != NULL; ++pair_index) {
+        const struct lxl_delim_pair *pair = &pairer->brackets[pair_index];
+        if (lxl__token_equals(token, pair->opener)) {
+            LXL_ASSERT(pairer->depth < pairer->capacity);  // The stack holds at most one entry per token.
+            pairer->stack[pairer->depth++] = (struct lxl_open_bracket) {index, pair_index};
+            ++pairer->open_counts[pair_index];
+            return true;
+        }
+        if (!lxl__token_equals(token, pair->closer)) continue;
+        if (pairer->open_counts[pair_index] == 0) {
+            pairer->partners[index] = LXL_BRACKET_UNMATCHED;
+            ++pairer->unmatched_count;
+            return true;
+        }
+        // Close the nearest open bracket of this kind. The brackets searched past are popped, so each stack
+        // entry is searched past at most once.
+        size_t depth = pairer->depth;
+        while (pairer->stack[depth - 1].pair_index != pair_index) --depth;
+        // Brackets left open inside this pair are unbalanced.
+        for (size_t d = depth; d < pairer->depth; ++d) {
+            pairer->partners[pairer->stack[d].token_index] = LXL_BRACKET_UNMATCHED;
+            --pairer->open_counts[pairer->stack[d].pair_index];
+            ++pairer->unmatched_count;
+        }
+        size_t opener_index = pairer->stack[depth - 1].token_index;
+        pairer->partners[opener_index] = index;
+        pairer->partners[index] = opener_index;
+        --pairer->open_counts[pair_index];
+        pairer->depth = depth - 1;
+        return true;
+    }
+    return true;
+}
+
+size_t lxl_bracket_pairer_finish(struct lxl_bracket_pairer *pairer) {
+    for (size_t d = 0; d < pairer->depth; ++d) {
+        pairer->partners[pairer->stack[d].token_index] = LXL_BRACKET_UNMATCHED;
+        --pairer->open_counts[pairer->stack[d].pair_index];
+        ++pairer->unmatched_count;
+    }
+    pairer->depth = 0;
+    return pairer->unmatched_count;
+}
+
+bool lxl_tokens_pair_brackets(const struct lxl_token *tokens, size_t count,
+                              const struct lxl_delim_pair *brackets, ptrdiff_t *OUT_partners,
+                              size_t *OUT_unmatched_count, struct lxl_region *region) {
+    struct lxl_bracket_pairer pairer;
+    if (!lxl_bracket_pairer_init(&pairer, brackets, OUT_partners, count, region)) return false;
+    for (size_t i = 0; i < count; ++i) {
+        lxl_bracket_pairer_add(&pairer, tokens[i]);
+    }
+    *OUT_unmatched_count = lxl_bracket_pairer_finish(&pairer);
+    return true;
+}
+
+size_t lxl_lexer_tokenize_paired(struct lxl_lexer *lexer, struct lxl_token *tokens, size_t capacity,
+                                 struct lxl_bracket_pairer *pairer) {
+    size_t count = 0;
+    while (count < capacity && pairer->token_count < pairer->capacity) {
+        struct lxl_token token = lxl_lexer_next_token(lexer);
+        if (LXL_TOKEN_IS_END(token)) break;
+        lxl_bracket_pairer_add(pairer, token);
+        tokens[count++] = token;
+    }
+    return count;
+}
+
+// END BRACKET PAIR FUNCTIONS.
+
+// BALANCED SKIPPING FUNCTIONS.
+
+// Add `c` to the set of characters `chars` (with room for 256) if it is not already present.
+static void lxl__add_char(char *chars, char c) {
+    if (c == '\0' || strchr(chars, c) != NULL) return;
+    size_t length = strlen(chars);
+    chars[length] = c;
+    chars[length + 1] = '\0';
+}
+
+// Advance the cursor to the first character in `chars`, counting lines on the way. Return false if the end
+// of the input is reached first.
+static bool lxl__cursor_find_chars(struct lxl_cursor *cursor, const char *chars) {
+    const char *p = cursor->current;
+    const char *line_start = NULL;  // The start of the last line reached (if any).
+    int line_count = 0;
+#ifdef __SSE2__
+    const __m128i lf = _mm_set1_epi8('\n');
+    for (; cursor->end - p >= 16; p += 16) {
+        __m128i bytes = _mm_loadu_si128((const __m128i *)p);
+        uint64_t hits = 0;
+        for (const char *c = chars; *c != '\0'; ++c) {
+            hits |= (uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(*c)));
+        }
+        uint64_t lfs = (uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, lf));
+        if (hits != 0) {
+            int offset = lxl__ctz64(hits);
+            lfs &= ((uint64_t)1 << offset) - 1;  // Only the LFs before the hit.
+            if (lfs != 0) {
+                line_count += lxl__popcount64(lfs);
+                line_start = p + lxl__msb64(lfs) + 1;
+            }
+            p += offset;
+            goto found;
+        }
+        if (lfs != 0) {
+            line_count += lxl__popcount64(lfs);
+            line_start = p + lxl__msb64(lfs) + 1;
+        }
+    }
+#endif
+    for (; p < cursor->end; ++p) {
+        if (*p != '\0' && strchr(chars, *p) != NULL) goto found;
+        if (*p == '\n') {
+            ++line_count;
+            line_start = p + 1;
+        }
+    }
+found:
+    if (line_count > 0) {
+        cursor->pos.line += line_count;
+        cursor->pos.column = p - line_start;
+    }
+    else {
+        cursor->pos.column += p - cursor->current;
+    }
+    cursor->current = p;
+    return p < cursor->end;
+}
+
+bool lxl_lexer_skip_balanced(struct lxl_lexer *lexer, const char *open, const char *close) {
+    LXL_ASSERT(open != NULL && close != NULL && open[0] != '\0' && close[0] != '\0');
+    struct lxl_checkpoint checkpoint = lxl_lexer_save_checkpoint(lexer);
+    // The first characters of anything which needs a closer look.
+    char candidates[257] = {0};
+    lxl__add_char(candidates, open[0]);
+    lxl__add_char(candidates, close[0]);
+    if (LXL_HAS_FEATURE(LXL_FEATURE_LINE_COMMENTS) && lexer->line_comment_openers != NULL) {
+        for (const char *const *opener = lexer->line_comment_openers; *opener != NULL; ++opener) {
+            lxl__add_char(candidates, (*opener)[0]);
+        }
+    }
+    const struct lxl_delim_pair *delim_lists[] = {
+        LXL_HAS_FEATURE(LXL_FEATURE_BLOCK_COMMENTS) ? lexer->nestable_comment_delims : NULL,
+        LXL_HAS_FEATURE(LXL_FEATURE_BLOCK_COMMENTS) ? lexer->unnestable_comment_delims : NULL,
+    };
+    for (size_t i = 0; i < sizeof delim_lists / sizeof delim_lists[0]; ++i) {
+        if (delim_lists[i] == NULL) continue;
+        for (const struct lxl_delim_pair *delims = delim_lists[i]; delims->opener != NULL; ++delims) {
+            lxl__add_char(candidates, delims->opener[0]);
+        }
+    }
+    // String openers are sets of characters.
+    const struct lxl_delim_pair *string_lists[] = {
+        LXL_HAS_FEATURE(LXL_FEATURE_LINE_STRINGS) ? lexer->line_string_delims : NULL,
+        LXL_HAS_FEATURE(LXL_FEATURE_MULTILINE_STRINGS) ? lexer->multiline_string_delims : NULL,
+    };
+    for (size_t i = 0; i < sizeof string_lists / sizeof string_lists[0]; ++i) {
+        if (string_lists[i] == NULL) continue;
+        for (const struct lxl_delim_pair *delims = string_lists[i]; delims->opener != NULL; ++delims) {
+            for (const char *c = delims->opener; *c != '\0'; ++c) lxl__add_char(candidates, *c);
+        }
+    }
+
+    int depth = 1;
+    while (depth > 0) {
+        struct lxl_cursor cursor = lxl_cursor__load(lexer);
+        bool found = lxl__cursor_find_chars(&cursor, candidates);
+        lxl_cursor__store(lexer, cursor);
+        if (!found) break;
+        const struct lxl_delim_pair *string_delims = NULL;
+        if (lxl_lexer__match_line_comment(lexer)) {
+            /* Do nothing; comment already consumed. */
+        }
+        else if (lxl_lexer__match_block_comment(lexer)) {
+            if (lexer->error) break;  // Unclosed comment.
+        }
+        else if ((string_delims = lxl_lexer__match_string_opener(lexer, LXL_STRING_LINE))) {
+            lxl_lexer__lex_string(lexer, string_delims, LXL_STRING_LINE);
+            lexer->error = LXL_LERR_OK;  // An unclosed line string ends at the LF.
+        }
+        else if ((string_delims = lxl_lexer__match_string_opener(lexer, LXL_STRING_MULTILINE))) {
+            lxl_lexer__lex_string(lexer, string_delims, LXL_STRING_MULTILINE);
+            if (lexer->error) break;  // Unclosed string.
+        }
+        else if (lxl_lexer__match_string(lexer, open)) {
+            ++depth;
+        }
+        else if (lxl_lexer__match_string(lexer, close)) {
+            --depth;
+        }
+        else {
+            lxl_lexer__advance(lexer);  // Not what it looked like.
+        }
+    }
+    if (depth > 0) {
+        lxl_lexer_restore_checkpoint(lexer, checkpoint);
+        return false;
+    }
+    lxl_lexer__update_bracket_depth(lexer, close);
+    return true;
+}
+
+// END BALANCED SKIPPING FUNCTIONS.
+
+// VALIDATION FUNCTIONS.
+
+// Copy `lexer` to `scan` without its hooks, so the lexer functions need not check for them, without its rule
+// profile, so that scanned tokens are not counted as hits, and without a scan pause. Build the table of bytes
+// which may be reserved for `lxl__lex_word_with_table()`.
+static void lxl__scan_begin(const struct lxl_lexer *lexer, struct lxl_lexer *scan,
+                            uint64_t OUT_maybe_reserved[4]) {
+    *scan = *lexer;
+    scan->before_unlex_int_hook = NULL;
+    scan->before_unlex_float_hook = NULL;
+    scan->after_token_hook = NULL;
+    scan->rule_profile = NULL;
+    scan->scan_pause = NULL;
+    lxl__reserved_table(scan, OUT_maybe_reserved);
+}
+
+// Copy the state of `scan` back to `lexer`, keeping the lexer's hooks, rule profile and scan pause.
+static void lxl__scan_end(struct lxl_lexer *lexer, struct lxl_lexer *scan) {
+    scan->before_unlex_int_hook = lexer->before_unlex_int_hook;
+    scan->before_unlex_float_hook = lexer->before_unlex_float_hook;
+    scan->after_token_hook = lexer->after_token_hook;
+    scan->rule_profile = lexer->rule_profile;
+    scan->scan_pause = lexer->scan_pause;
+    *lexer = *scan;
+}
+
+// Lex the next token as `lxl_lexer_next_token()` would, but return only its type (LXL_TOKENS_END at the end
+// of the input, without keyword lookup) and location.
+static inline int lxl__scan_token(struct lxl_lexer *scan, const uint64_t maybe_reserved[4],
+                                  struct lxl_location *OUT_loc) {
+    int token_type = LXL_TOKEN_UNINIT;
+    struct lxl_token token;
+    if (scan->paused_scan.delims != NULL && lxl__resume_scan(scan, &token)) {
+        *OUT_loc = token.loc;
+        return token.token_type;
+    }
+    lxl_lexer__skip_whitespace(scan);
+    *OUT_loc = scan->pos;
+    if (scan->error) {
+        token_type = scan->error;
+    }
+    else if (LXL_HAS_FEATURE(LXL_FEATURE_OFFSIDE_RULE) && scan->offside_rule
+             && lxl_lexer__lex_offside(scan, &token)) {
+        token_type = token.token_type;
+        *OUT_loc = token.loc;
+    }
+    else if (lxl_lexer__is_at_end(scan)) {
+        scan->status = LXL_LSTS_FINISHED;
+        return LXL_TOKENS_END;
+    }
+    else {
+        scan->token_start = scan->current;
+        token_type = lxl__lex_token_body(scan, false, maybe_reserved);
+        if (scan->error) token_type = scan->error;
+    }
+    scan->error = LXL_LERR_OK;
+    if (scan->emit_line_endings) scan->previous_token_type = token_type;
+    return token_type;
+}
+
+// How `lxl__skip_plain_tokens()` treats a byte at the start of a token.
+enum lxl__byte_class {
+    LXL__BYTE_WORD,   // Starts a word, as it cannot start anything else.
+    LXL__BYTE_BLANK,  // Whitespace other than a LF.
+    LXL__BYTE_LF,     // A LF which is whitespace (line endings are not emitted).
+    LXL__BYTE_PUNCT,  // Starts a punct or, if none matches, a word.
+    LXL__BYTE_DIGIT,  // Starts an unprefixed integer, or a float with the same digits.
+    LXL__BYTE_OTHER,  // Needs the full rules (e.g. starts a comment, string or prefixed number).
+};
+
+// Return whether a token of `token_type` is neither an error nor a line ending, so that counting and
+// validation can skip it without looking at its type.
+static bool lxl__is_plain_type(const struct lxl_lexer *lexer, int token_type) {
+    return token_type > LXL_LERR_GENERIC && token_type != lexer->line_ending_type;
+}
+
+// Set the class of each byte for `lxl__skip_plain_tokens()`. Return false if no tokens can be skipped that
+// way (e.g. with the offside rule, which needs the location of every token).
+static bool lxl__byte_classes(const struct lxl_lexer *lexer, uint8_t OUT_classes[256]) {
+    if ((LXL_HAS_FEATURE(LXL_FEATURE_OFFSIDE_RULE) && lexer->offside_rule)
+        || lexer->word_lexing_rule != LXL_LEX_WORD || !lxl__is_plain_type(lexer, lexer->default_word_type)) {
+        return false;
+    }
+    memset(OUT_classes, LXL__BYTE_WORD, 256);
+    bool plain_puncts = true;
+    if (LXL_HAS_FEATURE(LXL_FEATURE_PUNCTS) && lexer->puncts != NULL) {
+        for (int i = 0; lexer->puncts[i] != NULL; ++i) {
+            if (lexer->puncts[i][0] == '\0') return false;
+            plain_puncts &= lxl__is_plain_type(lexer, lexer->punct_types[i]);
+            OUT_classes[(unsigned char)lexer->puncts[i][0]] = LXL__BYTE_PUNCT;
+        }
+    }
+    if (!plain_puncts) {
+        for (int c = 0; c < 256; ++c) {
+            if (OUT_classes[c] == LXL__BYTE_PUNCT) OUT_classes[c] = LXL__BYTE_OTHER;
+        }
+    }
+    // Unprefixed integers are skipped in one pass when a float would start with the same digits, so that
+    // no integer is re-lexed as a float; numbers are only skipped if neither kind is an error token.
+    bool floats = LXL_HAS_FEATURE(LXL_FEATURE_FLOATS) && lexer->default_float_base != 0;
+    bool plain_digits = LXL_HAS_FEATURE(LXL_FEATURE_INTEGERS) && lexer->default_int_base != 0
+                        && lxl__is_plain_type(lexer, lexer->default_int_type)
+                        && (!floats || (lexer->default_float_base == lexer->default_int_base
+                                        && lxl__is_plain_type(lexer, lexer->default_float_type)));
+    int int_base = LXL_HAS_FEATURE(LXL_FEATURE_INTEGERS) ? lexer->default_int_base : 0;
+    int float_base = LXL_HAS_FEATURE(LXL_FEATURE_FLOATS) ? lexer->default_float_base : 0;
+    for (int c = 0; c < 256; ++c) {
+        char byte = (char)c;
+        struct lxl_cursor cursor = {.current = &byte, .end = &byte + 1, .pos = {0, 0}};
+        if (lxl_cursor__check_digit(cursor, int_base) || lxl_cursor__check_digit(cursor, float_base)) {
+            OUT_classes[c] = (plain_digits) ? LXL__BYTE_DIGIT : LXL__BYTE_OTHER;
+        }
+    }
+    // Anything else which may start a number, a comment or a string needs the full rules.
+    bool numbers = LXL_HAS_FEATURE(LXL_FEATURE_INTEGERS) || LXL_HAS_FEATURE(LXL_FEATURE_FLOATS);
+    const char *const *starts[] = {
+        (numbers) ? lexer->number_signs : NULL,
+        LXL_HAS_FEATURE(LXL_FEATURE_INTEGERS) ? lexer->integer_prefixes : NULL,
+        LXL_HAS_FEATURE(LXL_FEATURE_FLOATS) ? lexer->float_prefixes : NULL,
+        LXL_HAS_FEATURE(LXL_FEATURE_LINE_COMMENTS) ? lexer->line_comment_openers : NULL,
+    };
+    for (size_t i = 0; i < sizeof starts / sizeof starts[0]; ++i) {
+        for (const char *const *s = starts[i]; s != NULL && *s != NULL; ++s) {
+            if ((*s)[0] == '\0') return false;
+            OUT_classes[(unsigned char)(*s)[0]] = LXL__BYTE_OTHER;
+        }
+    }
+    const struct lxl_delim_pair *delims[] = {
+        LXL_HAS_FEATURE(LXL_FEATURE_BLOCK_COMMENTS) ? lexer->nestable_comment_delims : NULL,
+        LXL_HAS_FEATURE(LXL_FEATURE_BLOCK_COMMENTS) ? lexer->unnestable_comment_delims : NULL,
+        LXL_HAS_FEATURE(LXL_FEATURE_LINE_STRINGS) ? lexer->line_string_delims : NULL,
+        LXL_HAS_FEATURE(LXL_FEATURE_MULTILINE_STRINGS) ? lexer->multiline_string_delims : NULL,
+    };
+    for (size_t i = 0; i < sizeof delims / sizeof delims[0]; ++i) {
+        for (const struct lxl_delim_pair *d = delims[i]; d != NULL && d->opener != NULL; ++d) {
+            if (d->opener[0] == '\0') return false;
+            if (i < 2) {
+                OUT_classes[(unsigned char)d->opener[0]] = LXL__BYTE_OTHER;
+                continue;
+            }
+            // Any of a string opener's characters opens the string.
+            for (const char *c = d->opener; *c != '\0'; ++c) OUT_classes[(unsigned char)*c] = LXL__BYTE_OTHER;
+        }
+    }
+    for (const char *c = LXL_WHITESPACE_CHARS_NO_LF; *c != '\0'; ++c) {
+        OUT_classes[(unsigned char)*c] = LXL__BYTE_BLANK;
+    }
+    OUT_classes['\n'] = (lexer->emit_line_endings) ? LXL__BYTE_OTHER : LXL__BYTE_LF;
+    return true;
+}
+
+// Skip whitespace and the tokens which can be found from their first byte (see `lxl__byte_classes()`):
+// words, puncts and unprefixed numbers, which are never errors or line endings. Their types are not
+// worked out (keywords, or whether a number is an integer or a float) and the location is only updated
+// when the scan stops, at the end of the input or at the first byte which needs the full rules (e.g. a
+// comment or string), which `lxl__scan_token()` must lex next. Return the number of tokens skipped.
+static size_t lxl__skip_plain_tokens(struct lxl_lexer *scan, const uint8_t classes[256],
+                                     const uint64_t maybe_reserved[4]) {
+    if (scan->paused_scan.delims != NULL) return 0;  // The scan must be resumed first.
+    const char *p = scan->current;
+    const char *end = scan->end;
+    const char *line_start = p - scan->pos.column;
+    int line = scan->pos.line;
+    size_t count = 0;
+    int token_type = LXL_TOKEN_UNINIT;
+    while (p < end) {
+        switch (classes[(unsigned char)*p]) {
+        case LXL__BYTE_BLANK:
+            ++p;
+            continue;
+        case LXL__BYTE_LF:
+            line_start = ++p;
+            ++line;
+            continue;
+        case LXL__BYTE_PUNCT: {
+            scan->current = p;
+            const char *const *punct = lxl_lexer__match_punct(scan);
+            if (punct != NULL) {
+                lxl_lexer__update_bracket_depth(scan, *punct);
+                token_type = scan->punct_types[punct - scan->puncts];
+                p = scan->current;
+                break;
+            }
+            // No punct matched, so it is a word (as in `lxl__lex_token_body()`).
+        }
+            // fall through
+        case LXL__BYTE_WORD:
+            // As `lxl__lex_word_with_table()`, but LF is reserved, so the location need not be updated.
+            for (;;) {
+                for (; p < end; ++p) {
+                    unsigned char c = (unsigned char)*p;
+                    if ((maybe_reserved[c >> 6] >> (c & 63)) & 1) break;
+                }
+                if (p == end) break;
+                scan->current = p;
+                // A BLANK or LF byte is whitespace, and a PUNCT byte is reserved only if a punct starts there.
+                int byte_class = classes[(unsigned char)*p];
+                if (byte_class == LXL__BYTE_BLANK || byte_class == LXL__BYTE_LF) break;
+                if (byte_class == LXL__BYTE_PUNCT ? lxl_lexer__check_punct(scan) != NULL
+                                                  : lxl_lexer__check_reserved(scan)) {
+                    break;
+                }
+                ++p;
+            }
+            token_type = scan->default_word_type;
+            break;
+        case LXL__BYTE_DIGIT:
+            scan->current = p;
+            lxl_lexer__lex_digits(scan, scan->default_int_base);
+            token_type = scan->default_int_type;
+            if (LXL_HAS_FEATURE(LXL_FEATURE_FLOATS) && scan->default_float_base != 0
+                && (lxl_lexer__check_radix_separator(scan)
+                    || (scan->extended_floats && lxl__check_exponent(scan)))) {
+                // Carry on with the rest of the float rather than lexing it again from the start.
+                if (lxl_lexer__match_radix_separator(scan)) lxl_lexer__lex_digits(scan, scan->default_float_base);
+                if (lxl_lexer__match_string(scan, scan->default_exponent_marker)) {
+                    lxl_lexer__match_exponent_sign(scan);
+                    lxl_lexer__lex_digits(scan, scan->default_float_base);
+                }
+                if (scan->extended_floats) lxl_lexer__match_float_suffix(scan);
+                token_type = scan->default_float_type;
+            }
+            else {
+                lxl_lexer__match_int_suffix(scan);
+            }
+            p = scan->current;
+            break;
+        default:
+            goto stop;
+        }
+        ++count;
+    }
+stop:
+    scan->current = p;
+    scan->pos = (struct lxl_location) {line, (int)(p - line_start)};
+    if (count > 0 && scan->emit_line_endings) scan->previous_token_type = token_type;
+    return count;
+}
+
+struct lxl_validation lxl_lexer_validate(struct lxl_lexer *lexer, bool stop_at_first_error) {
+    struct lxl_validation result = {.error_count = 0, .first_error = LXL_LERR_OK, .first_error_loc = {0, 0}};
+    struct lxl_lexer scan;
+    uint64_t maybe_reserved[4];
+    lxl__scan_begin(lexer, &scan, maybe_reserved);
+    uint8_t classes[256];
+    bool skip_plain = lxl__byte_classes(&scan, classes);
+    while (!lxl_lexer_is_finished(&scan)) {
+        if (skip_plain) lxl__skip_plain_tokens(&scan, classes, maybe_reserved);
+        struct lxl_location loc;
+        int token_type = lxl__scan_token(&scan, maybe_reserved, &loc);
+        if (token_type == LXL_TOKENS_END) break;
+        if (token_type > LXL_LERR_GENERIC) continue;  // Not an error (see LXL_TOKEN_IS_ERROR()).
+        if (result.error_count++ == 0) {
+            result.first_error = token_type;
+            result.first_error_loc = loc;
+        }
+        if (stop_at_first_error) break;
+    }
+    lxl__scan_end(lexer, &scan);
+    return result;
+}
+
+// END VALIDATION FUNCTIONS.
+
+// TOKEN COUNTING FUNCTIONS.
+
+size_t lxl_lexer_count_tokens(struct lxl_lexer *lexer, size_t *OUT_trivia_count, size_t *OUT_error_count) {
+    size_t count = 0;
+    size_t trivia_count = 0;
+    size_t error_count = 0;
+    struct lxl_lexer scan;
+    uint64_t maybe_reserved[4];
+    lxl__scan_begin(lexer, &scan, maybe_reserved);
+    uint8_t classes[256];
+    bool skip_plain = lxl__byte_classes(&scan, classes);
+    while (!lxl_lexer_is_finished(&scan)) {
+        if (skip_plain) count += lxl__skip_plain_tokens(&scan, classes, maybe_reserved);
+        struct lxl_location loc;
+        int token_type = lxl__scan_token(&scan, maybe_reserved, &loc);
+        if (token_type == LXL_TOKENS_END) break;
+        ++count;
+        trivia_count += token_type == scan.line_ending_type;
+        error_count += token_type <= LXL_LERR_GENERIC;
+    }
+    lxl__scan_end(lexer, &scan);
+    if (OUT_trivia_count != NULL) *OUT_trivia_count = trivia_count;
+    if (OUT_error_count != NULL) *OUT_error_count = error_count;
+    return count;
+}
+
+bool lxl_token_columns_init(struct lxl_token_columns *columns, size_t capacity, bool with_locations,
+                            struct lxl_region *region) {
+    size_t alloc_count = region->alloc_count;
+    struct lxl_token_columns result = {
+        .starts = lxl_region_allocate(capacity * sizeof *result.starts, region),
+        .ends = lxl_region_allocate(capacity * sizeof *result.ends, region),
+        .locs = (with_locations) ? lxl_region_allocate(capacity * sizeof *result.locs, region) : NULL,
+        .token_types = lxl_region_allocate(capacity * sizeof *result.token_types, region),
+        .count = 0,
+        .capacity = capacity,
+    };
+    if (result.starts == NULL || result.ends == NULL || (with_locations && result.locs == NULL)
+        || result.token_types == NULL) {
+        region->alloc_count = alloc_count;
+        return false;
+    }
+    *columns = result;
+    return true;
+}
+
+size_t lxl_lexer_tokenize_columns(struct lxl_lexer *lexer, struct lxl_token_columns *columns) {
+    size_t count = columns->count;
+    while (count < columns->capacity) {
+        struct lxl_token token = lxl_lexer_next_token(lexer);
+        if (LXL_TOKEN_IS_END(token)) break;
+        columns->starts[count] = token.start;
+        columns->ends[count] = token.end;
+        if (columns->locs != NULL) columns->locs[count] = token.loc;
+        columns->token_types[count] = token.token_type;
+        ++count;
+    }
+    size_t added = count - columns->count;
+    columns->count = count;
+    return added;
+}
+
+bool lxl_lexer_tokenize_exact(struct lxl_lexer *lexer, struct lxl_token_columns *OUT_columns,
+                              bool with_locations, struct lxl_region *region) {
+    size_t alloc_count = region->alloc_count;
+    struct lxl_lexer counter = *lexer;
+    if (counter.offside_rule && counter.indent_stack != NULL) {
+        // Count with a temporary copy of the indent stack, as counting would overwrite the live entries.
+        counter.indent_stack = lxl_region_allocate(counter.indent_capacity * sizeof *counter.indent_stack,
+                                                   region);
+        if (counter.indent_stack == NULL) {
+            region->alloc_count = alloc_count;
+            return false;
+        }
+        memcpy(counter.indent_stack, lexer->indent_stack, lexer->indent_depth * sizeof *lexer->indent_stack);
+    }
+    size_t count = lxl_lexer_count_tokens(&counter, NULL, NULL);
+    region->alloc_count = alloc_count;  // Free the copy of the indent stack.
+    if (!lxl_token_columns_init(OUT_columns, count, with_locations, region)) return false;
+    lxl_lexer_tokenize_columns(lexer, OUT_columns);
+    return true;
+}
+
+// END TOKEN COUNTING FUNCTIONS.
+
+// RECORD BATCH FUNCTIONS.
+
+// Copy `config` for lexing records, which are not padded, and mark the bytes which may start something
+// other than a word in `OUT_maybe_reserved` once for all the records (see `lxl__reserved_table()`).
+static struct lxl_lexer lxl__record_lexer(const struct lxl_lexer *config, uint64_t OUT_maybe_reserved[4]) {
+    struct lxl_lexer lexer = *config;
+    lexer.padded_input = false;
+    lexer.rule_profile = NULL;
+    lxl__reserved_table(&lexer, OUT_maybe_reserved);
+    return lexer;
+}
+
+// Lex the record [start, end) into `batch`. Return false (leaving the batch unchanged) if it does not fit in
+// a batch which already holds tokens; in an empty batch it is truncated instead.
+static bool lxl__tokenize_record(struct lxl_lexer *lexer, const uint64_t maybe_reserved[4], const char *start,
+                                 const char *end, struct lxl_record_batch *batch) {
+    if (batch->record_count == batch->record_capacity) return false;
+    size_t capacity = batch->token_capacity - batch->token_count;
+    bool truncated = false;
+    lxl_lexer_rebind(lexer, start, end);
+    // Without the offside rule every token but an error at the end takes at least a byte, so a record shorter
+    // than the free space fits. Otherwise hooks must not run for a record which is dropped, so count first.
+    bool has_hooks = lexer->after_token_hook != NULL || lexer->before_unlex_int_hook != NULL
+                     || lexer->before_unlex_float_hook != NULL;
+    if (has_hooks && (lexer->offside_rule || (size_t)(end - start) >= capacity)) {
+        if (lxl_lexer_count_tokens(lexer, NULL, NULL) > capacity) {
+            if (batch->token_count != 0) return false;
+            truncated = true;
+        }
+        lxl_lexer_rebind(lexer, start, end);
+    }
+    struct lxl_token *tokens = &batch->tokens[batch->token_count];
+    size_t count = 0;
+    while (count < capacity) {
+        struct lxl_token token = lxl__next_token(lexer, maybe_reserved);
+        if (LXL_TOKEN_IS_END(token)) break;
+        tokens[count++] = token;
+    }
+    if (count == capacity && !truncated && !lxl_lexer_is_finished(lexer)) {
+        // The batch is full: the record fits only if nothing but the end token is left.
+        struct lxl_token token = lxl__next_token(lexer, maybe_reserved);
+        if (!LXL_TOKEN_IS_END(token)) {
+            if (batch->token_count != 0) return false;
+            truncated = true;
+        }
+    }
+    size_t begin = batch->token_count;
+    batch->records[batch->record_count++] = (struct lxl_record_range) {begin, begin + count, truncated};
+    batch->token_count = begin + count;
+    return true;
+}
+
+const char *lxl_lexer_tokenize_lines(const struct lxl_lexer *config, const char *start, const char *end,
+                                     struct lxl_record_batch *batch) {
+    uint64_t maybe_reserved[4];
+    struct lxl_lexer lexer = lxl__record_lexer(config, maybe_reserved);
+    while (start < end) {
+        const char *line_end = memchr(start, '\n', end - start);
+        if (line_end == NULL) line_end = end;
+        if (!lxl__tokenize_record(&lexer, maybe_reserved, start, line_end, batch)) break;
+        start = (line_end < end) ? line_end + 1 : end;
+    }
+    return start;
+}
+
+size_t lxl_lexer_tokenize_records(const struct lxl_lexer *config, const char *data, const size_t *lengths,
+                                  size_t record_count, struct lxl_record_batch *batch) {
+    uint64_t maybe_reserved[4];
+    struct lxl_lexer lexer = lxl__record_lexer(config, maybe_reserved);
+    size_t i = 0;
+    for (; i < record_count; ++i) {
+        if (!lxl__tokenize_record(&lexer, maybe_reserved, data, data + lengths[i], batch)) break;
+        data += lengths[i];
+    }
+    return i;
+}
+
+// END RECORD BATCH FUNCTIONS.
+
+// PRESET FUNCTIONS.
+
+#define LXL__SEQ8(first)                                                                        \
+    (first), (first) + 1, (first) + 2, (first) + 3, (first) + 4, (first) + 5, (first) + 6, (first) + 7
+#define LXL__SEQ64(first)                                                                       \
+    LXL__SEQ8(first), LXL__SEQ8((first) + 8), LXL__SEQ8((first) + 16), LXL__SEQ8((first) + 24), \
+    LXL__SEQ8((first) + 32), LXL__SEQ8((first) + 40), LXL__SEQ8((first) + 48), LXL__SEQ8((first) + 56)
+
+// Punct and keyword types for the presets. The keyword types repeat for SQL's lowercase keywords.
+static const int lxl__preset_punct_types[] = {LXL__SEQ64(LXL_PRESET_PUNCT)};
+static const int lxl__preset_keyword_types[] = {
+    LXL__SEQ64(LXL_PRESET_KEYWORD), LXL__SEQ64(LXL_PRESET_KEYWORD),
+};
+
+#undef LXL__SEQ64
+#undef LXL__SEQ8
+
+// C.
+
+static const char *const lxl__c_line_comments[] = {"//", NULL};
+static const struct lxl_delim_pair lxl__c_block_comments[] = {{"/*", "*/"}, {NULL, NULL}};
+static const struct lxl_delim_pair lxl__c_strings[] = {{"\"", "\""}, {"'", "'"}, {NULL, NULL}};
+static const int lxl__c_string_types[] = {LXL_PRESET_STRING, LXL_PRESET_CHAR};
+static const char *const lxl__c_int_prefixes[] = {"0x", "0X", "0b", "0B", NULL};
+static const int lxl__c_int_bases[] = {16, 16, 2, 2};
+static const char *const lxl__c_int_suffixes[] = {
+    "ull", "uLL", "Ull", "ULL", "llu", "llU", "LLu", "LLU", "ul", "uL", "Ul", "UL", "lu", "lU", "Lu", "LU",
+    "ll", "LL", "u", "U", "l", "L", NULL,
+};
+static const char *const lxl__c_float_suffixes[] = {"f", "F", "l", "L", NULL};
+static const char *const lxl__c_puncts[] = {
+    "!=", "!", "##", "#", "%=", "%", "&&", "&=", "&", "(", ")", "*=", "*", "++", "+=", "+", ",", "--", "-=",
+    "->", "-", "...", ".", "/=", "/", ":", ";", "<<=", "<<", "<=", "<", "==", "=", ">>=", ">=", ">>", ">",
+    "?", "[", "]", "^=", "^", "{", "|=", "||", "|", "}", "~", NULL,
+};
+static const char *const lxl__c_keywords[] = {
+    "_Alignas", "_Alignof", "_Atomic", "_Bool", "_Complex", "_Generic", "_Imaginary", "_Noreturn",
+    "_Static_assert", "_Thread_local", "auto", "break", "case", "char", "const", "continue", "default", "do",
+    "double", "else", "enum", "extern", "float", "for", "goto", "if", "inline", "int", "long", "register",
+    "restrict", "return", "short", "signed", "sizeof", "static", "struct", "switch", "typedef", "union",
+    "unsigned", "void", "volatile", "while", NULL,
+};
+static const struct lxl_rule_index lxl__c_rule_index = {
+    .reserved_bytes = {
+        UINT64_C(0xfc00ffef00003e00),
+        UINT64_C(0x7800000068000000),
+        UINT64_C(0x0000000000000000),
+        UINT64_C(0x0000000000000000),
+    },
+    .punct_groups = {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        2, 2, 4, 4, 6, 9, 9, 10, 11, 13, 16, 17, 21, 23, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 26, 27,
+        31, 33, 37, 38, 38, 38, 38, 38, 38, 38, 38, 38, 38, 38, 38, 38, 38, 38, 38, 38, 38, 38, 38, 38, 38,
+        38, 38, 38, 38, 38, 38, 39, 39, 40, 42, 42, 42, 42, 42, 42, 42, 42, 42, 42, 42, 42, 42, 42, 42, 42,
+        42, 42, 42, 42, 42, 42, 42, 42, 42, 42, 42, 42, 42, 43, 46, 47, 48, 48, 48, 48, 48, 48, 48, 48, 48,
+        48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48,
+        48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48,
+        48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48,
+        48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48,
+        48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48,
+    },
+    .keyword_groups = {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 10, 10, 11, 12,
+        16, 19, 22, 24, 25, 25, 28, 28, 28, 29, 29, 29, 29, 29, 29, 32, 38, 39, 41, 43, 44, 44, 44, 44, 44,
+        44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44,
+        44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44,
+        44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44,
+        44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44,
+        44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44, 44,
+        44, 44, 44, 44, 44, 44, 44,
+    },
+};
+// JSON.
+
+static const struct lxl_delim_pair lxl__json_strings[] = {{"\"", "\""}, {NULL, NULL}};
+static const int lxl__json_string_types[] = {LXL_PRESET_STRING};
+static const char *const lxl__json_number_signs[] = {"-", NULL};
+static const char *const lxl__json_puncts[] = {
+    ",", ":", "[", "]", "{", "}", NULL,
+};
+static const char *const lxl__json_keywords[] = {
+    "false", "null", "true", NULL,
+};
+static const struct lxl_rule_index lxl__json_rule_index = {
+    .reserved_bytes = {
+        UINT64_C(0x0400100500003e00),
+        UINT64_C(0x2800000028000000),
+        UINT64_C(0x0000000000000000),
+        UINT64_C(0x0000000000000000),
+    },
+    .punct_groups = {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4,
+        4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 5, 5, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+        6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+        6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+        6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+        6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    },
+    .keyword_groups = {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+        3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+        3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+        3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+        3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    },
+};
+// SQL.
+
+static const char *const lxl__sql_line_comments[] = {"--", NULL};
+static const struct lxl_delim_pair lxl__sql_block_comments[] = {{"/*", "*/"}, {NULL, NULL}};
+static const struct lxl_delim_pair lxl__sql_strings[] = {{"'", "'"}, {"\"", "\""}, {NULL, NULL}};
+static const int lxl__sql_string_types[] = {LXL_PRESET_STRING, LXL_PRESET_QUOTED_NAME};
+static const char *const lxl__sql_puncts[] = {
+    "!=", "%", "(", ")", "*", "+", ",", "-", ".", "/", "::", ":", ";", "<=", "<>", "<", "=", ">=", ">", "||",
+    NULL,
+};
+static const char *const lxl__sql_keywords[] = {
+    "ALL", "ALTER", "AND", "AS", "ASC", "BEGIN", "BETWEEN", "BY", "CASE", "CHECK", "COMMIT", "CONSTRAINT",
+    "CREATE", "CROSS", "DEFAULT", "DELETE", "DESC", "DISTINCT", "DROP", "ELSE", "END", "EXISTS", "FALSE",
+    "FOREIGN", "FROM", "FULL", "GROUP", "HAVING", "IN", "INDEX", "INNER", "INSERT", "INTO", "IS", "JOIN",
+    "KEY", "LEFT", "LIKE", "LIMIT", "NOT", "NULL", "OFFSET", "ON", "OR", "ORDER", "OUTER", "PRIMARY",
+    "REFERENCES", "RIGHT", "ROLLBACK", "SELECT", "SET", "TABLE", "THEN", "TRUE", "UNION", "UNIQUE", "UPDATE",
+    "USING", "VALUES", "VIEW", "WHEN", "WHERE", "WITH", "all", "alter", "and", "as", "asc", "begin",
+    "between", "by", "case", "check", "commit", "constraint", "create", "cross", "default", "delete", "desc",
+    "distinct", "drop", "else", "end", "exists", "false", "foreign", "from", "full", "group", "having", "in",
+    "index", "inner", "insert", "into", "is", "join", "key", "left", "like", "limit", "not", "null", "offset",
+    "on", "or", "order", "outer", "primary", "references", "right", "rollback", "select", "set", "table",
+    "then", "true", "union", "unique", "update", "using", "values", "view", "when", "where", "with", NULL,
+};
+static const struct lxl_rule_index lxl__sql_rule_index = {
+    .reserved_bytes = {
+        UINT64_C(0x7c00ffa700003e00),
+        UINT64_C(0x1000000000000000),
+        UINT64_C(0x0000000000000000),
+        UINT64_C(0x0000000000000000),
+    },
+    .punct_groups = {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        1, 1, 1, 1, 2, 2, 2, 3, 4, 5, 6, 7, 8, 9, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 12, 13, 16, 17,
+        19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19,
+        19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19,
+        19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20,
+        20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20,
+        20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20,
+        20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20,
+        20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20,
+        20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20,
+    },
+    .keyword_groups = {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 5, 8,
+        14, 19, 22, 26, 27, 28, 34, 35, 36, 39, 39, 41, 46, 47, 47, 50, 52, 55, 59, 61, 64, 64, 64, 64, 64,
+        64, 64, 64, 64, 64, 69, 72, 78, 83, 86, 90, 91, 92, 98, 99, 100, 103, 103, 105, 110, 111, 111, 114,
+        116, 119, 123, 125, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128,
+        128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128,
+        128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128,
+        128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128,
+        128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128,
+        128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128,
+        128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128,
+        128,
+    },
+};
+// INI and TOML.
+
+static const char *const lxl__ini_line_comments[] = {"#", ";", NULL};
+static const struct lxl_delim_pair lxl__ini_strings[] = {{"\"", "\""}, {"'", "'"}, {NULL, NULL}};
+static const int lxl__ini_string_types[] = {LXL_PRESET_STRING, LXL_PRESET_STRING};
+static const char *const lxl__ini_number_signs[] = {"+", "-", NULL};
+static const char *const lxl__ini_int_prefixes[] = {"0x", "0o", "0b", NULL};
+static const int lxl__ini_int_bases[] = {16, 8, 2};
+static const char *const lxl__ini_puncts[] = {
+    ",", ".", ":", "=", "[", "]", "{", "}", NULL,
+};
+static const char *const lxl__ini_keywords[] = {
+    "false", "true", NULL,
+};
+static const struct lxl_rule_index lxl__ini_rule_index = {
+    .reserved_bytes = {
+        UINT64_C(0x2c00508d00003e00),
+        UINT64_C(0x2800000028000000),
+        UINT64_C(0x0000000000000000),
+        UINT64_C(0x0000000000000000),
+    },
+    .punct_groups = {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 4, 4, 4, 4, 4, 4,
+        4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 5, 5, 6, 6, 6, 6, 6, 6, 6, 6,
+        6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 7, 7, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8,
+        8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8,
+        8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8,
+        8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8,
+        8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8,
+    },
+    .keyword_groups = {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    },
+};
+// Shell.
+
+static const char *const lxl__shell_line_comments[] = {"#", NULL};
+static const struct lxl_delim_pair lxl__shell_strings[] = {
+    {"'", "'"}, {"\"", "\""}, {"`", "`"}, {NULL, NULL},
+};
+static const int lxl__shell_string_types[] = {LXL_PRESET_STRING, LXL_PRESET_STRING, LXL_PRESET_STRING};
+static const char *const lxl__shell_puncts[] = {
+    "&&", "&", "(", ")", ";;", ";", "<<-", "<&", "<<", "<>", "<", ">&", ">>", ">|", ">", "||", "|", NULL,
+};
+static const char *const lxl__shell_keywords[] = {
+    "!", "case", "do", "done", "elif", "else", "esac", "fi", "for", "if", "in", "then", "until", "while", "{",
+    "}", NULL,
+};
+static const struct lxl_rule_index lxl__shell_rule_index = {
+    .reserved_bytes = {
+        UINT64_C(0x580003cd00003e00),
+        UINT64_C(0x1000000100000000),
+        UINT64_C(0x0000000000000000),
+        UINT64_C(0x0000000000000000),
+    },
+    .punct_groups = {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 2, 2, 3, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 6, 11, 11, 15, 15, 15,
+        15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+        15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+        15, 15, 15, 15, 15, 15, 15, 15, 15, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17,
+        17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17,
+        17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17,
+        17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17,
+        17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17,
+        17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17,
+    },
+    .keyword_groups = {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 4,
+        7, 9, 9, 9, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 12, 13, 13, 14, 14, 14, 14, 15, 15, 16, 16,
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+        16, 16, 16, 16,
+    },
+};
+struct lxl_lexer lxl_lexer_preset(enum lxl_language language, const char *start, const char *end) {
+    struct lxl_lexer lexer = lxl_lexer_new(start, end);
+    lexer.default_word_type = LXL_PRESET_WORD;
+    lexer.word_lexing_rule = LXL_LEX_WORD;
+    lexer.default_int_type = LXL_PRESET_INT;
+    lexer.default_float_type = LXL_PRESET_FLOAT;
+    lexer.punct_types = lxl__preset_punct_types;
+    lexer.keyword_types = lxl__preset_keyword_types;
+    switch (language) {
+    case LXL_LANG_C:
+        lexer.line_comment_openers = lxl__c_line_comments;
+        lexer.unnestable_comment_delims = lxl__c_block_comments;
+        lexer.line_string_delims = lxl__c_strings;
+        lexer.line_string_types = lxl__c_string_types;
+        lexer.string_escape_chars = "\\";
+        lexer.integer_prefixes = lxl__c_int_prefixes;
+        lexer.integer_bases = lxl__c_int_bases;
+        lexer.integer_suffixes = lxl__c_int_suffixes;
+        lexer.default_int_base = 10;
+        lexer.float_suffixes = lxl__c_float_suffixes;
+        lexer.default_float_base = 10;
+        lexer.extended_floats = true;
+        lexer.puncts = lxl__c_puncts;
+        lexer.keywords = lxl__c_keywords;
+        lexer.rule_index = &lxl__c_rule_index;
+        break;
+    case LXL_LANG_JSON:
+        lexer.line_string_delims = lxl__json_strings;
+        lexer.line_string_types = lxl__json_string_types;
+        lexer.string_escape_chars = "\\";
+        lexer.number_signs = lxl__json_number_signs;
+        lexer.default_int_base = 10;
+        lexer.default_float_base = 10;
+        lexer.extended_floats = true;
+        lexer.puncts = lxl__json_puncts;
+        lexer.keywords = lxl__json_keywords;
+        lexer.rule_index = &lxl__json_rule_index;
+        break;
+    case LXL_LANG_SQL:
+        lexer.line_comment_openers = lxl__sql_line_comments;
+        lexer.unnestable_comment_delims = lxl__sql_block_comments;
+        lexer.multiline_string_delims = lxl__sql_strings;
+        lexer.multiline_string_types = lxl__sql_string_types;
+        lexer.default_int_base = 10;
+        lexer.default_float_base = 10;
+        lexer.extended_floats = true;
+        lexer.puncts = lxl__sql_puncts;
+        lexer.keywords = lxl__sql_keywords;
+        lexer.rule_index = &lxl__sql_rule_index;
+        break;
+    case LXL_LANG_INI:
+        lexer.line_comment_openers = lxl__ini_line_comments;
+        lexer.line_string_delims = lxl__ini_strings;
+        lexer.line_string_types = lxl__ini_string_types;
+        lexer.string_escape_chars = "\\";
+        lexer.number_signs = lxl__ini_number_signs;
+        lexer.digit_separators = "_";
+        lexer.integer_prefixes = lxl__ini_int_prefixes;
+        lexer.integer_bases = lxl__ini_int_bases;
+        lexer.default_int_base = 10;
+        lexer.default_float_base = 10;
+        lexer.extended_floats = true;
+        lexer.puncts = lxl__ini_puncts;
+        lexer.keywords = lxl__ini_keywords;
+        lexer.emit_line_endings = true;
+        lexer.rule_index = &lxl__ini_rule_index;
+        break;
+    case LXL_LANG_SHELL:
+        lexer.line_comment_openers = lxl__shell_line_comments;
+        lexer.multiline_string_delims = lxl__shell_strings;
+        lexer.multiline_string_types = lxl__shell_string_types;
+        lexer.string_escape_chars = "\\";
+        lexer.puncts = lxl__shell_puncts;
+        lexer.keywords = lxl__shell_keywords;
+        lexer.emit_line_endings = true;
+        lexer.rule_index = &lxl__shell_rule_index;
+        break;
+    }
+    return lexer;
+}
+
+// END PRESET FUNCTIONS.
+
+// TOKEN SET FUNCTIONS.
+
+struct lxl_token lxl_lexer_next_token_not_in(struct lxl_lexer *lexer, const struct lxl_token_set *skipped) {
+    for (;;) {
+        struct lxl_token token = lxl_lexer_next_token(lexer);
+        if (!lxl_token_set_contains(skipped, token.token_type)) return token;
+    }
+}
+
+struct lxl_token lxl_lexer_sync_to(struct lxl_lexer *lexer, const struct lxl_token_set *targets,
+                                   size_t *OUT_skipped_count) {
+    size_t skipped_count = 0;
+    struct lxl_token token;
+    for (;;) {
+        token = lxl_lexer_next_token(lexer);
+        if (lxl_token_set_contains(targets, token.token_type) || LXL_TOKEN_IS_END(token)) break;
+        ++skipped_count;
+    }
+    if (OUT_skipped_count != NULL) *OUT_skipped_count = skipped_count;
+    return token;
+}
+
+// END TOKEN SET FUNCTIONS.
+
 #endif  // LEXEL_IMPLEMENTATION
 
 #endif  // LEXEL_H
@@ -0,0 +1,1089 @@
+/*
+ * lexel.hpp -- compile-time lexer tables for lexel in C++20.
+ *
+ * This header builds on lexel.h. A lexer is described by a `constexpr lxl::spec` object and
+ * `lxl::static_lexer<spec>` lexes with tables computed from it at compile time:
+ * + a byte class table used to dispatch on the first byte of each token,
+ * + a punct trie (longest match),
+ * + a keyword perfect hash.
+ * Tokens are plain `struct lxl_token` objects with the same types and error tokens as the C lexer.
+ * `lxl::token_view` and `lxl::collect_tokens()` adapt either kind of lexer to ranges and `std::pmr`.
+ * `lxl::lex_async()` lexes input arriving in chunks from an asynchronous byte source in a coroutine.
+ *
+ * lexel.hpp itself does not need the C implementation, but lexel.h must still be compiled with
+ * LEXEL_IMPLEMENTATION (as C) in one translation unit to use the rest of the C interface.
+ *
+ * See lexel.h for licence information.
+ */
+
+#ifndef LEXEL_HPP
+#define LEXEL_HPP
+
+#include <algorithm>    // std::copy
+#include <array>        // std::array
+#include <bit>          // std::bit_ceil
+#include <concepts>     // std::convertible_to
+#include <coroutine>    // std::coroutine_handle, std::suspend_always
+#include <cstddef>      // std::size_t
+#include <cstdint>      // std::uint8_t, std::uint32_t, std::uint64_t
+#include <cstring>      // std::strlen
+#include <exception>    // std::exception_ptr
+#include <iterator>     // std::default_sentinel_t, std::input_iterator_tag
+#include <memory>       // std::align
+#include <memory_resource>  // std::pmr::memory_resource
+#include <new>          // std::bad_alloc
+#include <ranges>       // std::ranges::view_interface
+#include <span>         // std::span
+#include <string_view>  // std::string_view
+#include <type_traits>  // std::invoke_result_t
+#include <utility>      // std::exchange
+#include <vector>       // std::pmr::vector
+
+#include "lexel.h"
+
+namespace lxl {
+
+// LEXER SPEC.
+
+// A string with an associated token type (used for puncts and keywords).
+struct token_rule {
+    std::string_view text;
+    int type;
+};
+
+// A pair of delimiters with an associated token type (used for strings and block comments).
+// As in the C lexer, a string opener is a set of characters, any one of which opens the string.
+struct delim_rule {
+    std::string_view opener;
+    std::string_view closer;
+    int type = LXL_TOKEN_UNINIT;  // Unused for comments.
+};
+
+// An integer prefix and the base associated with it.
+struct prefix_rule {
+    std::string_view text;
+    int base;
+};
+
+inline constexpr std::string_view default_exponent_signs[] = {"+", "-"};
+inline constexpr std::string_view default_radix_separators[] = {"."};
+
+// The description of a lexer. The fields and their defaults mirror the configuration fields of
+// `struct lxl_lexer`. Hooks, float prefixes, float suffixes and the offside rule are not supported.
+// NOTE: the spec should be a `constexpr` object with static storage duration.
+struct spec {
+    std::span<const std::string_view> line_comments{};
+    std::span<const delim_rule> nestable_comments{};
+    std::span<const delim_rule> unnestable_comments{};
+    std::span<const delim_rule> line_strings{};
+    std::span<const delim_rule> multiline_strings{};
+    std::string_view string_escape_chars{};
+    std::string_view digit_separators{};
+    std::span<const std::string_view> number_signs{};
+    std::span<const prefix_rule> integer_prefixes{};
+    std::span<const std::string_view> integer_suffixes{};
+    int default_int_type = LXL_LERR_GENERIC;
+    int default_int_base = 0;
+    std::span<const std::string_view> exponent_signs = default_exponent_signs;
+    std::span<const std::string_view> radix_separators = default_radix_separators;
+    int default_float_type = LXL_LERR_GENERIC;
+    int default_float_base = 0;
+    std::string_view default_exponent_marker = "e";
+    bool extended_floats = false;
+    std::span<const token_rule> puncts{};
+    std::span<const token_rule> keywords{};
+    int default_word_type = LXL_TOKEN_UNINIT;
+    lxl_word_lexing_rule word_lexing_rule = LXL_LEX_SYMBOLIC;
+    int line_ending_type = LXL_TOKEN_LINE_ENDING;
+    bool emit_line_endings = false;
+    bool collect_line_endings = true;
+};
+
+// END LEXER SPEC.
+
+
+// COMPILE-TIME TABLES.
+
+namespace detail {
+
+// Byte classes used to dispatch on the first byte of a token.
+enum char_class : std::uint8_t {
+    CC_BLANK = 0x01,             // Whitespace other than LF.
+    CC_LF = 0x02,                // LF.
+    CC_LINE_STRING = 0x04,       // Opens a line string.
+    CC_MULTILINE_STRING = 0x08,  // Opens a multiline string.
+    CC_COMMENT_START = 0x10,     // First byte of a comment opener.
+    CC_PUNCT_START = 0x20,       // First byte of a punct.
+    CC_NUMBER_START = 0x40,      // First byte of a number sign, integer prefix or digit.
+};
+
+// As `lxl_cursor__check_digit()`.
+constexpr bool is_digit(char c, int base) {
+    if (base == 0) return false;
+    if ('0' <= c && c <= '9') return c - '0' < base;
+    c = static_cast<char>(c | 0x20);
+    return 'a' <= c && c <= 'z' && 10 + (c - 'a') < base;
+}
+
+constexpr void mark_first(std::array<std::uint8_t, 256> &classes, std::string_view s, std::uint8_t cls) {
+    if (!s.empty()) classes[static_cast<unsigned char>(s[0])] |= cls;
+}
+
+constexpr std::array<std::uint8_t, 256> make_char_classes(const spec &s) {
+    std::array<std::uint8_t, 256> classes{};
+    for (char c : std::string_view(LXL_WHITESPACE_CHARS_NO_LF)) {
+        classes[static_cast<unsigned char>(c)] |= CC_BLANK;
+    }
+    classes['\n'] |= CC_LF;
+    for (const delim_rule &d : s.line_strings) {
+        for (char c : d.opener) classes[static_cast<unsigned char>(c)] |= CC_LINE_STRING;
+    }
+    for (const delim_rule &d : s.multiline_strings) {
+        for (char c : d.opener) classes[static_cast<unsigned char>(c)] |= CC_MULTILINE_STRING;
+    }
+    for (std::string_view o : s.line_comments) mark_first(classes, o, CC_COMMENT_START);
+    for (const delim_rule &d : s.nestable_comments) mark_first(classes, d.opener, CC_COMMENT_START);
+    for (const delim_rule &d : s.unnestable_comments) mark_first(classes, d.opener, CC_COMMENT_START);
+    for (const token_rule &p : s.puncts) mark_first(classes, p.text, CC_PUNCT_START);
+    for (std::string_view sign : s.number_signs) mark_first(classes, sign, CC_NUMBER_START);
+    for (const prefix_rule &p : s.integer_prefixes) mark_first(classes, p.text, CC_NUMBER_START);
+    for (int c = 0; c < 256; ++c) {
+        char ch = static_cast<char>(c);
+        if (is_digit(ch, s.default_int_base) || is_digit(ch, s.default_float_base)) {
+            classes[c] |= CC_NUMBER_START;
+        }
+    }
+    // Empty signs or prefixes match anywhere.
+    for (std::string_view sign : s.number_signs) {
+        if (sign.empty()) for (std::uint8_t &cls : classes) cls |= CC_NUMBER_START;
+    }
+    for (const prefix_rule &p : s.integer_prefixes) {
+        if (p.text.empty()) for (std::uint8_t &cls : classes) cls |= CC_NUMBER_START;
+    }
+    return classes;
+}
+
+// Map each byte to the index of the first string delimiter whose opener contains it, or -1.
+constexpr std::array<int, 256> make_string_index(std::span<const delim_rule> delims) {
+    std::array<int, 256> index{};
+    index.fill(-1);
+    for (std::size_t i = delims.size(); i-- > 0;) {
+        for (char c : delims[i].opener) index[static_cast<unsigned char>(c)] = static_cast<int>(i);
+    }
+    return index;
+}
+
+// Punct trie. The first byte is dispatched through the `root` array; deeper levels are stored as
+// first-child/next-sibling lists.
+struct trie_node {
+    char ch = '\0';
+    int child = -1;
+    int sibling = -1;
+    int punct = -1;  // Index of the punct ending at this node, or -1.
+};
+
+template <std::size_t N>
+struct punct_trie {
+    std::array<int, 256> root{};
+    std::array<trie_node, N> nodes{};
+    std::size_t node_count = 0;
+};
+
+constexpr std::size_t trie_size(const spec &s) {
+    std::size_t size = 1;  // Avoid zero-sized arrays.
+    for (const token_rule &p : s.puncts) size += p.text.size();
+    return size;
+}
+
+template <std::size_t N>
+constexpr punct_trie<N> make_punct_trie(const spec &s) {
+    punct_trie<N> trie{};
+    trie.root.fill(-1);
+    for (std::size_t i = 0; i < s.puncts.size(); ++i) {
+        std::string_view text = s.puncts[i].text;
+        if (text.empty()) throw "lxl::spec: puncts must not be empty";
+        int *link = &trie.root[static_cast<unsigned char>(text[0])];
+        int node = *link;
+        if (node < 0) {
+            node = *link = static_cast<int>(trie.node_count++);
+            trie.nodes[node].ch = text[0];
+        }
+        for (std::size_t j = 1; j < text.size(); ++j) {
+            int child = trie.nodes[node].child;
+            while (child >= 0 && trie.nodes[child].ch != text[j]) child = trie.nodes[child].sibling;
+            if (child < 0) {
+                child = static_cast<int>(trie.node_count++);
+                trie.nodes[child].ch = text[j];
+                trie.nodes[child].sibling = trie.nodes[node].child;
+                trie.nodes[node].child = child;
+            }
+            node = child;
+        }
+        if (trie.nodes[node].punct < 0) trie.nodes[node].punct = static_cast<int>(i);  // First one wins.
+    }
+    return trie;
+}
+
+// Order the puncts longest first (stably), so that the C lexer's first-match rule agrees with the
+// trie's longest match.
+template <std::size_t N>
+constexpr std::array<token_rule, N + 1> order_puncts(const spec &s) {
+    std::array<token_rule, N + 1> ordered{};
+    std::size_t count = 0;
+    std::size_t max_length = 0;
+    for (const token_rule &p : s.puncts) {
+        if (p.text.size() > max_length) max_length = p.text.size();
+    }
+    for (std::size_t length = max_length; length > 0; --length) {
+        for (const token_rule &p : s.puncts) {
+            if (p.text.size() == length) ordered[count++] = p;
+        }
+    }
+    return ordered;
+}
+
+// Keyword perfect hash (hash and displace). Each keyword's hash selects a bucket, and each bucket has
+// a displacement chosen at compile time so that its keywords land in distinct, otherwise unused slots.
+constexpr std::uint64_t hash_bytes(std::string_view s) {
+    std::uint64_t hash = 0xcbf29ce484222325u;  // FNV-1a.
+    for (char c : s) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001b3u;
+    }
+    return hash;
+}
+
+constexpr std::uint64_t mix_hash(std::uint64_t hash, std::uint32_t displacement) {
+    hash ^= displacement * 0x9e3779b97f4a7c15u;
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdu;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+constexpr std::size_t keyword_slot_count(std::size_t n) { return std::bit_ceil(2*n + 1); }
+constexpr std::size_t keyword_bucket_count(std::size_t n) { return std::bit_ceil(n/2 + 1); }
+
+template <std::size_t N, std::size_t Buckets, std::size_t Slots>
+struct keyword_table {
+    std::array<std::uint32_t, Buckets> displacements{};
+    std::array<int, Slots> slots{};  // Keyword index or -1.
+};
+
+template <std::size_t N, std::size_t Buckets, std::size_t Slots>
+constexpr keyword_table<N, Buckets, Slots> make_keyword_table(const spec &s) {
+    keyword_table<N, Buckets, Slots> table{};
+    table.slots.fill(-1);
+    std::array<std::uint64_t, N + 1> hashes{};
+    std::array<bool, N + 1> duplicate{};
+    std::array<std::size_t, Buckets> bucket_sizes{};
+    std::size_t max_bucket_size = 0;
+    for (std::size_t i = 0; i < N; ++i) {
+        for (std::size_t j = 0; j < i; ++j) {
+            if (s.keywords[j].text == s.keywords[i].text) duplicate[i] = true;  // First one wins.
+        }
+        hashes[i] = hash_bytes(s.keywords[i].text);
+        if (duplicate[i]) continue;
+        std::size_t size = ++bucket_sizes[(hashes[i] >> 32) & (Buckets - 1)];
+        if (size > max_bucket_size) max_bucket_size = size;
+    }
+    // Place the largest buckets first while there is the most room.
+    for (std::size_t size = max_bucket_size; size > 0; --size) {
+        for (std::size_t bucket = 0; bucket < Buckets; ++bucket) {
+            if (bucket_sizes[bucket] != size) continue;
+            std::uint32_t displacement = 0;
+            for (;; ++displacement) {
+                if (displacement > (1u << 20)) throw "lxl::spec: could not build keyword hash";
+                std::array<std::size_t, N + 1> placed{};
+                std::size_t placed_count = 0;
+                bool ok = true;
+                for (std::size_t i = 0; i < N && ok; ++i) {
+                    if (duplicate[i] || ((hashes[i] >> 32) & (Buckets - 1)) != bucket) continue;
+                    std::size_t slot = mix_hash(hashes[i], displacement) & (Slots - 1);
+                    if (table.slots[slot] >= 0) ok = false;
+                    for (std::size_t k = 0; k < placed_count && ok; ++k) {
+                        if (placed[k] == slot) ok = false;
+                    }
+                    placed[placed_count++] = slot;
+                }
+                if (ok) break;
+            }
+            table.displacements[bucket] = displacement;
+            for (std::size_t i = 0; i < N; ++i) {
+                if (duplicate[i] || ((hashes[i] >> 32) & (Buckets - 1)) != bucket) continue;
+                table.slots[mix_hash(hashes[i], displacement) & (Slots - 1)] = static_cast<int>(i);
+            }
+        }
+    }
+    return table;
+}
+
+// C-compatible lists for `static_lexer::configure()`.
+constexpr const char *c_string(std::string_view s) {
+    if (s.data()[s.size()] != '\0') throw "lxl::spec: strings must be NUL-terminated";
+    return s.data();
+}
+
+// Build a zero-terminated C list from `items`, projecting each item with `field`.
+template <std::size_t N, typename T, typename F>
+constexpr auto c_list(std::span<const T> items, F field) {
+    std::array<std::invoke_result_t<F, const T &>, N + 1> list{};
+    for (std::size_t i = 0; i < N; ++i) list[i] = field(items[i]);
+    return list;
+}
+
+} // namespace detail
+
+// END COMPILE-TIME TABLES.
+
+
+// STATIC LEXER.
+
+// A lexer whose rules are fixed by `Spec` at compile time. It produces the same tokens as a C lexer
+// configured by `configure()`, except that puncts always use the longest match (`configure()` orders
+// the C puncts accordingly).
+template <const spec &Spec>
+class static_lexer {
+public:
+    // Create a lexer over [start, end). If `end` is NULL, `start` is treated as a null-terminated string.
+    static_lexer(const char *start, const char *end) : start_(start) {
+        if (end == nullptr) end = start + std::strlen(start);
+        cursor_.current = start;
+        cursor_.end = end;
+        cursor_.pos = {0, 0};
+    }
+    explicit static_lexer(std::string_view source)
+        : static_lexer(source.data(), source.data() + source.size()) {}
+
+    // Get the next token. A token of type LXL_TOKENS_END is returned when the token stream is exhausted.
+    lxl_token next_token();
+
+    // Return whether the token stream is exhausted.
+    bool is_finished() const { return status_ == LXL_LSTS_FINISHED; }
+
+    // Lex up to `capacity` tokens into `tokens` as `lxl_lexer_tokenize()` does (excluding the end token).
+    std::size_t tokenize(lxl_token *tokens, std::size_t capacity) {
+        std::size_t count = 0;
+        while (count < capacity) {
+            lxl_token token = next_token();
+            if (LXL_TOKEN_IS_END(token)) break;
+            tokens[count++] = token;
+        }
+        return count;
+    }
+
+    // Reset the lexer to the start of its input.
+    void reset() {
+        cursor_.current = start_;
+        cursor_.pos = {0, 0};
+        previous_token_type_ = LXL_TOKEN_NO_TOKEN;
+        status_ = LXL_LSTS_READY;
+    }
+
+    // The current position of the lexer.
+    lxl_cursor cursor() const { return cursor_; }
+
+    // Configure the rule fields of a C lexer from `Spec`, using lists built at compile time. All strings
+    // in the spec must be NUL-terminated (e.g. string literals).
+    static void configure(lxl_lexer &lexer);
+
+private:
+    static constexpr std::size_t punct_count = Spec.puncts.size();
+    static constexpr std::size_t keyword_count = Spec.keywords.size();
+    static constexpr std::size_t keyword_buckets = detail::keyword_bucket_count(keyword_count);
+    static constexpr std::size_t keyword_slots = detail::keyword_slot_count(keyword_count);
+
+    static constexpr std::array<std::uint8_t, 256> classes = detail::make_char_classes(Spec);
+    static constexpr std::array<int, 256> line_string_index = detail::make_string_index(Spec.line_strings);
+    static constexpr std::array<int, 256> multiline_string_index =
+        detail::make_string_index(Spec.multiline_strings);
+    static constexpr auto trie = detail::make_punct_trie<detail::trie_size(Spec)>(Spec);
+    static constexpr auto keyword_hash =
+        detail::make_keyword_table<keyword_count, keyword_buckets, keyword_slots>(Spec);
+
+    const char *start_;
+    lxl_cursor cursor_;
+    int previous_token_type_ = LXL_TOKEN_NO_TOKEN;
+    lxl_lexer_status status_ = LXL_LSTS_READY;
+
+    static std::uint8_t class_of(const lxl_cursor &c) {
+        return lxl_cursor__is_at_end(c) ? 0 : classes[static_cast<unsigned char>(*c.current)];
+    }
+
+    bool can_emit_line_ending() const {
+        if (!Spec.emit_line_endings) return false;
+        if (previous_token_type_ == LXL_TOKEN_LINE_ENDING) return !Spec.collect_line_endings;
+        return true;
+    }
+
+    static bool check_string(const lxl_cursor &c, std::string_view s) {
+        return lxl_cursor__check_string_n(c, s.data(), s.size());
+    }
+
+    static bool match_string(lxl_cursor &c, std::string_view s) {
+        return lxl_cursor__match_string_n(&c, s.data(), s.size());
+    }
+
+    static bool check_strings(const lxl_cursor &c, std::span<const std::string_view> strings) {
+        for (std::string_view s : strings) {
+            if (check_string(c, s)) return true;
+        }
+        return false;
+    }
+
+    static bool match_strings(lxl_cursor &c, std::span<const std::string_view> strings) {
+        for (std::string_view s : strings) {
+            if (match_string(c, s)) return true;
+        }
+        return false;
+    }
+
+    static bool check_escape_char(const lxl_cursor &c) {
+        if (lxl_cursor__is_at_end(c)) return false;
+        return Spec.string_escape_chars.find(*c.current) != std::string_view::npos;
+    }
+
+    static bool check_digit_separator(const lxl_cursor &c) {
+        return !lxl_cursor__is_at_end(c) && Spec.digit_separators.find(*c.current) != std::string_view::npos;
+    }
+
+    // Return the index of the longest punct at the cursor, or -1. The cursor is not advanced.
+    static int find_punct(const lxl_cursor &c, std::size_t *OUT_length) {
+        if (lxl_cursor__is_at_end(c)) return -1;
+        int node = trie.root[static_cast<unsigned char>(*c.current)];
+        int punct = -1;
+        std::size_t depth = 1;
+        while (node >= 0) {
+            if (trie.nodes[node].punct >= 0) {
+                punct = trie.nodes[node].punct;
+                *OUT_length = depth;
+            }
+            if (c.current + depth >= c.end) break;
+            char next = c.current[depth];
+            node = trie.nodes[node].child;
+            while (node >= 0 && trie.nodes[node].ch != next) node = trie.nodes[node].sibling;
+            ++depth;
+        }
+        return punct;
+    }
+
+    static int keyword_type(std::string_view word) {
+        if constexpr (keyword_count == 0) {
+            return Spec.default_word_type;
+        }
+        else {
+            std::uint64_t hash = detail::hash_bytes(word);
+            std::uint32_t displacement = keyword_hash.displacements[(hash >> 32) & (keyword_buckets - 1)];
+            int keyword = keyword_hash.slots[detail::mix_hash(hash, displacement) & (keyword_slots - 1)];
+            if (keyword >= 0 && Spec.keywords[keyword].text == word) return Spec.keywords[keyword].type;
+            return Spec.default_word_type;
+        }
+    }
+
+    static void skip_line(lxl_cursor &c) {
+        while (!lxl_cursor__is_at_end(c) && *c.current != '\n') lxl_cursor__advance(&c);
+    }
+
+    static bool skip_block_comment(lxl_cursor &c, const delim_rule &delims, bool nestable) {
+        int depth = 1;
+        while (depth > 0) {
+            if (match_string(c, delims.closer)) {
+                --depth;
+            }
+            else if (nestable && match_string(c, delims.opener)) {
+                ++depth;
+            }
+            else if (!lxl_cursor__advance(&c)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Skip whitespace and comments, returning an error code for an unclosed comment.
+    int skip_whitespace(lxl_cursor &c) const {
+        bool lf_is_whitespace = !can_emit_line_ending();
+        int error = LXL_LERR_OK;
+        for (;;) {
+            std::uint8_t cls;
+            while ((cls = class_of(c)) & (CC_BLANK_OR_LF)) {
+                if ((cls & detail::CC_LF) && !lf_is_whitespace) break;
+                lxl_cursor__advance(&c);
+            }
+            if (!(cls & detail::CC_COMMENT_START)) break;
+            if (check_strings(c, Spec.line_comments)) {
+                skip_line(c);
+                continue;
+            }
+            bool matched = false;
+            for (const delim_rule &delims : Spec.nestable_comments) {
+                if (match_string(c, delims.opener)) {
+                    if (!skip_block_comment(c, delims, true)) error = LXL_LERR_UNCLOSED_COMMENT;
+                    matched = true;
+                    break;
+                }
+            }
+            if (!matched) {
+                for (const delim_rule &delims : Spec.unnestable_comments) {
+                    if (match_string(c, delims.opener)) {
+                        if (!skip_block_comment(c, delims, false)) error = LXL_LERR_UNCLOSED_COMMENT;
+                        matched = true;
+                        break;
+                    }
+                }
+            }
+            if (!matched) break;
+        }
+        return error;
+    }
+
+    static constexpr std::uint8_t CC_BLANK_OR_LF = detail::CC_BLANK | detail::CC_LF;
+
+    static bool lex_string(lxl_cursor &c, std::string_view closer, bool line) {
+        while (!match_string(c, closer)) {
+            if (check_escape_char(c)) {
+                // Consume the escape character. The escaped character is consumed below.
+                lxl_cursor__advance(&c);
+            }
+            // Consume non-delimiter character.
+            char ch = lxl_cursor__advance(&c);
+            if (ch == '\0' || (ch == '\n' && line)) return false;
+        }
+        return true;
+    }
+
+    static int lex_digits(lxl_cursor &c, int base) {
+        int digit_count = 0;
+        for (;;) {
+            if (lxl_cursor__check_digit(c, base)) {
+                ++digit_count;
+            }
+            else if (!check_digit_separator(c)) {
+                break;
+            }
+            lxl_cursor__advance(&c);
+        }
+        return digit_count;
+    }
+
+    static int match_int_prefix(lxl_cursor &c) {
+        match_strings(c, Spec.number_signs);
+        for (const prefix_rule &prefix : Spec.integer_prefixes) {
+            if (match_string(c, prefix.text)) return prefix.base;
+        }
+        return lxl_cursor__check_digit(c, Spec.default_int_base) ? Spec.default_int_base : 0;
+    }
+
+    static int match_float_prefix(lxl_cursor &c) {
+        match_strings(c, Spec.number_signs);
+        return lxl_cursor__check_digit(c, Spec.default_float_base) ? Spec.default_float_base : 0;
+    }
+
+    static bool lex_float(lxl_cursor &c, int base) {
+        int digit_count = lex_digits(c, base);
+        if (match_strings(c, Spec.radix_separators)) {
+            digit_count += lex_digits(c, base);
+        }
+        if (match_string(c, Spec.default_exponent_marker)) {
+            match_strings(c, Spec.exponent_signs);
+            digit_count += lex_digits(c, base);
+        }
+        return digit_count > 0;
+    }
+
+    // Return whether an exponent (marker, optional sign and digit) follows an unprefixed integer.
+    static bool check_exponent(lxl_cursor c) {
+        if (!match_string(c, Spec.default_exponent_marker)) return false;
+        match_strings(c, Spec.exponent_signs);
+        return lxl_cursor__check_digit(c, Spec.default_float_base);
+    }
+
+    // Lex a number literal as `lxl_lexer_next_token()` does. Return false if neither an integer nor a
+    // float prefix matched (any sign matched stays consumed, as in the C lexer).
+    static bool lex_number(lxl_cursor &c, const lxl_cursor &token_start, int *OUT_type) {
+        int base = match_int_prefix(c);
+        if (base) {
+            if (lex_digits(c, base) > 0) {
+                *OUT_type = Spec.default_int_type;
+                if (Spec.default_float_base != 0
+                    && (check_strings(c, Spec.radix_separators)
+                        || (Spec.extended_floats && base == Spec.default_int_base && check_exponent(c)))) {
+                    // Re-lex as float.
+                    c = token_start;
+                    if ((base = match_float_prefix(c))) {
+                        return lex_float_from_prefix(c, token_start, base, OUT_type);
+                    }
+                    *OUT_type = LXL_LERR_INVALID_INTEGER;
+                }
+            }
+            else {
+                c = token_start;
+                *OUT_type = LXL_LERR_INVALID_INTEGER;
+                match_int_prefix(c);  // Keep the prefix in the error token.
+            }
+            match_strings(c, Spec.integer_suffixes);
+            return true;
+        }
+        if ((base = match_float_prefix(c))) return lex_float_from_prefix(c, token_start, base, OUT_type);
+        return false;
+    }
+
+    static bool lex_float_from_prefix(lxl_cursor &c, const lxl_cursor &token_start, int base, int *OUT_type) {
+        if (lex_float(c, base)) {
+            *OUT_type = Spec.default_float_type;
+        }
+        else {
+            c = token_start;
+            *OUT_type = LXL_LERR_INVALID_FLOAT;
+            match_float_prefix(c);  // Keep the prefix in the error token.
+        }
+        return true;
+    }
+
+    static bool is_reserved(const lxl_cursor &c) {
+        std::uint8_t cls = class_of(c);
+        if (cls & (CC_BLANK_OR_LF | detail::CC_LINE_STRING | detail::CC_MULTILINE_STRING)) return true;
+        if (cls & detail::CC_COMMENT_START) {
+            if (check_strings(c, Spec.line_comments)) return true;
+            for (const delim_rule &delims : Spec.nestable_comments) {
+                if (check_string(c, delims.opener)) return true;
+            }
+            for (const delim_rule &delims : Spec.unnestable_comments) {
+                if (check_string(c, delims.opener)) return true;
+            }
+        }
+        std::size_t length = 0;
+        return (cls & detail::CC_PUNCT_START) && find_punct(c, &length) >= 0;
+    }
+
+    lxl_token finish_token(lxl_token token, const lxl_cursor &c, int type) {
+        token.end = c.current;
+        token.token_type = type;
+        cursor_ = c;
+        previous_token_type_ = type;
+        return token;
+    }
+
+    lxl_token end_token() {
+        status_ = LXL_LSTS_FINISHED;
+        lxl_token token = {cursor_.current, cursor_.current, cursor_.pos, LXL_TOKENS_END};
+        previous_token_type_ = LXL_TOKENS_END;
+        return token;
+    }
+};
+
+template <const spec &Spec>
+lxl_token static_lexer<Spec>::next_token() {
+    if (is_finished()) return end_token();
+    lxl_cursor c = cursor_;
+    int error = skip_whitespace(c);
+    const lxl_cursor token_start = c;
+    lxl_token token = {c.current, c.current, c.pos, LXL_TOKEN_UNINIT};
+    if (error) return finish_token(token, c, error);
+    if (lxl_cursor__is_at_end(c)) {
+        cursor_ = c;
+        return end_token();
+    }
+    std::uint8_t cls = class_of(c);
+    int type = LXL_TOKEN_UNINIT;
+    if (cls & detail::CC_LF) {
+        // LF is only left by `skip_whitespace()` if we can emit a line ending.
+        lxl_cursor__advance(&c);
+        type = Spec.line_ending_type;
+    }
+    else if (!Spec.line_strings.empty() && (cls & detail::CC_LINE_STRING)) {
+        const delim_rule &delims =
+            Spec.line_strings[line_string_index[static_cast<unsigned char>(*c.current)]];
+        lxl_cursor__advance(&c);
+        type = lex_string(c, delims.closer, true) ? delims.type : LXL_LERR_UNCLOSED_STRING;
+    }
+    else if (!Spec.multiline_strings.empty() && (cls & detail::CC_MULTILINE_STRING)) {
+        const delim_rule &delims =
+            Spec.multiline_strings[multiline_string_index[static_cast<unsigned char>(*c.current)]];
+        lxl_cursor__advance(&c);
+        type = lex_string(c, delims.closer, false) ? delims.type : LXL_LERR_UNCLOSED_STRING;
+    }
+    else if (!((cls & detail::CC_NUMBER_START) && lex_number(c, token_start, &type))) {
+        std::size_t length = 0;
+        int punct = -1;
+        cls = class_of(c);  // A sign may have been consumed.
+        if constexpr (punct_count > 0) {
+            if (cls & detail::CC_PUNCT_START) punct = find_punct(c, &length);
+        }
+        if (punct >= 0) {
+            lxl_cursor__advance_by(&c, length);
+            type = Spec.puncts[punct].type;
+        }
+        else {
+            if (Spec.word_lexing_rule == LXL_LEX_SYMBOLIC) {
+                bool lf_is_whitespace = !can_emit_line_ending();
+                while (!lxl_cursor__is_at_end(c) && !lxl_cursor__check_blank(c)) {
+                    if (lf_is_whitespace && *c.current == '\n') break;
+                    lxl_cursor__advance(&c);
+                }
+            }
+            else {
+                while (!lxl_cursor__is_at_end(c) && !is_reserved(c)) lxl_cursor__advance(&c);
+            }
+            std::size_t length = static_cast<std::size_t>(c.current - token.start);
+            type = keyword_type(std::string_view(token.start, length));
+        }
+    }
+    return finish_token(token, c, type);
+}
+
+template <const spec &Spec>
+void static_lexer<Spec>::configure(lxl_lexer &lexer) {
+    using detail::c_list;
+    using detail::c_string;
+    constexpr auto text = [](const auto &rule) { return c_string(rule.text); };
+    constexpr auto type = [](const auto &rule) { return rule.type; };
+    constexpr auto delims = [](const delim_rule &rule) {
+        return lxl_delim_pair{c_string(rule.opener), c_string(rule.closer)};
+    };
+    constexpr auto base = [](const prefix_rule &rule) { return rule.base; };
+    static constexpr auto puncts = detail::order_puncts<punct_count>(Spec);
+
+    static constexpr auto line_comments = c_list<Spec.line_comments.size()>(Spec.line_comments, c_string);
+    static constexpr auto nestable_comments =
+        c_list<Spec.nestable_comments.size()>(Spec.nestable_comments, delims);
+    static constexpr auto unnestable_comments =
+        c_list<Spec.unnestable_comments.size()>(Spec.unnestable_comments, delims);
+    static constexpr auto line_strings = c_list<Spec.line_strings.size()>(Spec.line_strings, delims);
+    static constexpr auto line_string_types = c_list<Spec.line_strings.size()>(Spec.line_strings, type);
+    static constexpr auto multiline_strings =
+        c_list<Spec.multiline_strings.size()>(Spec.multiline_strings, delims);
+    static constexpr auto multiline_string_types =
+        c_list<Spec.multiline_strings.size()>(Spec.multiline_strings, type);
+    static constexpr auto number_signs = c_list<Spec.number_signs.size()>(Spec.number_signs, c_string);
+    static constexpr auto integer_prefixes =
+        c_list<Spec.integer_prefixes.size()>(Spec.integer_prefixes, text);
+    static constexpr auto integer_bases = c_list<Spec.integer_prefixes.size()>(Spec.integer_prefixes, base);
+    static constexpr auto integer_suffixes =
+        c_list<Spec.integer_suffixes.size()>(Spec.integer_suffixes, c_string);
+    static constexpr auto exponent_signs = c_list<Spec.exponent_signs.size()>(Spec.exponent_signs, c_string);
+    static constexpr auto radix_separators =
+        c_list<Spec.radix_separators.size()>(Spec.radix_separators, c_string);
+    static constexpr auto punct_texts = c_list<punct_count>(std::span<const token_rule>(puncts), text);
+    static constexpr auto punct_types = c_list<punct_count>(std::span<const token_rule>(puncts), type);
+    static constexpr auto keywords = c_list<keyword_count>(Spec.keywords, text);
+    static constexpr auto keyword_types = c_list<keyword_count>(Spec.keywords, type);
+    static constexpr const char *escape_chars =
+        Spec.string_escape_chars.empty() ? nullptr : c_string(Spec.string_escape_chars);
+    static constexpr const char *digit_separators =
+        Spec.digit_separators.empty() ? nullptr : c_string(Spec.digit_separators);
+    static constexpr const char *exponent_marker = c_string(Spec.default_exponent_marker);
+
+    // Empty lists are left as NULL, as in `lxl_lexer_new()`.
+    lexer.line_comment_openers = Spec.line_comments.empty() ? nullptr : line_comments.data();
+    lexer.nestable_comment_delims = Spec.nestable_comments.empty() ? nullptr : nestable_comments.data();
+    lexer.unnestable_comment_delims = Spec.unnestable_comments.empty() ? nullptr : unnestable_comments.data();
+    lexer.line_string_delims = Spec.line_strings.empty() ? nullptr : line_strings.data();
+    lexer.line_string_types = Spec.line_strings.empty() ? nullptr : line_string_types.data();
+    lexer.multiline_string_delims = Spec.multiline_strings.empty() ? nullptr : multiline_strings.data();
+    lexer.multiline_string_types = Spec.multiline_strings.empty() ? nullptr : multiline_string_types.data();
+    lexer.string_escape_chars = escape_chars;
+    lexer.digit_separators = digit_separators;
+    lexer.number_signs = Spec.number_signs.empty() ? nullptr : number_signs.data();
+    lexer.integer_prefixes = Spec.integer_prefixes.empty() ? nullptr : integer_prefixes.data();
+    lexer.integer_bases = Spec.integer_prefixes.empty() ? nullptr : integer_bases.data();
+    lexer.integer_suffixes = Spec.integer_suffixes.empty() ? nullptr : integer_suffixes.data();
+    lexer.default_int_type = Spec.default_int_type;
+    lexer.default_int_base = Spec.default_int_base;
+    lexer.exponent_signs = exponent_signs.data();
+    lexer.radix_separators = radix_separators.data();
+    lexer.default_float_type = Spec.default_float_type;
+    lexer.default_float_base = Spec.default_float_base;
+    lexer.default_exponent_marker = exponent_marker;
+    lexer.extended_floats = Spec.extended_floats;
+    lexer.puncts = (punct_count == 0) ? nullptr : punct_texts.data();
+    lexer.punct_types = (punct_count == 0) ? nullptr : punct_types.data();
+    lexer.keywords = (keyword_count == 0) ? nullptr : keywords.data();
+    lexer.keyword_types = (keyword_count == 0) ? nullptr : keyword_types.data();
+    lexer.default_word_type = Spec.default_word_type;
+    lexer.word_lexing_rule = Spec.word_lexing_rule;
+    lexer.line_ending_type = Spec.line_ending_type;
+    lexer.emit_line_endings = Spec.emit_line_endings;
+    lexer.collect_line_endings = Spec.collect_line_endings;
+}
+
+// END STATIC LEXER.
+
+
+// TOKEN VIEW.
+
+// Lex up to `capacity` tokens into `tokens`, excluding the end token. These overloads let the token view
+// and `collect_tokens()` work with both C lexers and static lexers.
+inline std::size_t tokenize(lxl_lexer &lexer, lxl_token *tokens, std::size_t capacity) {
+    return lxl_lexer_tokenize(&lexer, tokens, capacity);
+}
+
+template <const spec &Spec>
+std::size_t tokenize(static_lexer<Spec> &lexer, lxl_token *tokens, std::size_t capacity) {
+    return lexer.tokenize(tokens, capacity);
+}
+
+// A lazy input range over the tokens of a lexer (excluding the end token). Tokens are lexed in batches of
+// `BatchSize` into a buffer inside the view, so iterating touches the lexer once per batch. Iterators
+// refer to the view, which must outlive them (as with `std::ranges::istream_view`).
+template <typename Lexer, std::size_t BatchSize = 64>
+class basic_token_view : public std::ranges::view_interface<basic_token_view<Lexer, BatchSize>> {
+public:
+    class iterator {
+    public:
+        using iterator_concept = std::input_iterator_tag;
+        using value_type = lxl_token;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+        explicit iterator(basic_token_view *view) : view_(view) {}
+
+        const lxl_token &operator*() const { return view_->batch_[view_->index_]; }
+        const lxl_token *operator->() const { return &view_->batch_[view_->index_]; }
+
+        iterator &operator++() {
+            if (++view_->index_ == view_->count_) view_->refill();
+            return *this;
+        }
+        void operator++(int) { ++*this; }
+
+        bool operator==(std::default_sentinel_t) const { return view_->index_ == view_->count_; }
+
+    private:
+        basic_token_view *view_ = nullptr;
+    };
+
+    basic_token_view() = default;
+    explicit basic_token_view(Lexer &lexer) : lexer_(&lexer) {}
+
+    iterator begin() {
+        if (index_ == count_) refill();
+        return iterator(this);
+    }
+    std::default_sentinel_t end() const { return std::default_sentinel; }
+
+private:
+    Lexer *lexer_ = nullptr;
+    std::size_t index_ = 0;
+    std::size_t count_ = 0;
+    std::array<lxl_token, BatchSize> batch_;
+
+    void refill() {
+        index_ = 0;
+        count_ = tokenize(*lexer_, batch_.data(), BatchSize);
+    }
+};
+
+using token_view = basic_token_view<lxl_lexer>;
+
+// Lex all remaining tokens (excluding the end token) into a vector allocated from `resource`.
+// The tokens are lexed directly into the vector's storage in geometrically growing batches.
+// NOTE: with a `region_resource`, each time the vector grows its old storage stays allocated in the region.
+template <typename Lexer>
+std::pmr::vector<lxl_token> collect_tokens(
+    Lexer &lexer, std::pmr::memory_resource *resource = std::pmr::get_default_resource()) {
+    std::pmr::vector<lxl_token> tokens(resource);
+    std::size_t batch_size = 64;
+    for (;;) {
+        std::size_t old_size = tokens.size();
+        tokens.resize(old_size + batch_size);
+        std::size_t count = tokenize(lexer, tokens.data() + old_size, batch_size);
+        tokens.resize(old_size + count);
+        if (count < batch_size) break;
+        batch_size = tokens.size();  // Grow with the vector.
+    }
+    return tokens;
+}
+
+// A memory resource which allocates from an `lxl_region`. Deallocation is a no-op; memory is reclaimed
+// all at once with `lxl_region_reset()`. Allocation throws `std::bad_alloc` when the region is full.
+class region_resource : public std::pmr::memory_resource {
+public:
+    explicit region_resource(lxl_region &region) : region_(&region) {}
+
+    lxl_region &region() const { return *region_; }
+
+private:
+    lxl_region *region_;
+
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+        // The region aligns to LXL_REGION_ALIGN; larger alignments need padding.
+        std::size_t padding = (alignment > LXL_REGION_ALIGN) ? alignment - LXL_REGION_ALIGN : 0;
+        std::size_t space = bytes + padding;
+        void *p = lxl_region_allocate(space, region_);
+        if (p == nullptr || std::align(alignment, bytes, p, space) == nullptr) throw std::bad_alloc();
+        return p;
+    }
+
+    void do_deallocate(void *, std::size_t, std::size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+        const region_resource *r = dynamic_cast<const region_resource *>(&other);
+        return r != nullptr && r->region_ == region_;
+    }
+};
+
+// END TOKEN VIEW.
+
+
+// ASYNC LEXING.
+
+// A coroutine producing a sequence of values, which may itself suspend on other awaitables between values.
+// The consumer (another coroutine) asks for each value with `co_await generator.next()`, which returns a
+// pointer to the value, or NULL once the generator has finished. The value is only valid until `next()` is
+// awaited again. Exceptions thrown in the generator are rethrown from `co_await next()`.
+template <typename T>
+class async_generator {
+public:
+    class promise_type {
+    public:
+        async_generator get_return_object() noexcept {
+            return async_generator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        auto final_suspend() noexcept {
+            value_ = nullptr;
+            return yield_awaiter{};
+        }
+        auto yield_value(const T &value) noexcept {
+            value_ = &value;
+            return yield_awaiter{};
+        }
+        void return_void() const noexcept {}
+        void unhandled_exception() noexcept { exception_ = std::current_exception(); }
+
+    private:
+        friend async_generator;
+
+        const T *value_ = nullptr;
+        std::coroutine_handle<> consumer_;
+        std::exception_ptr exception_;
+
+        // Suspend the generator and resume the consumer waiting on `next()`.
+        struct yield_awaiter {
+            bool await_ready() const noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> generator) const noexcept {
+                return generator.promise().consumer_;
+            }
+            void await_resume() const noexcept {}
+        };
+    };
+
+    async_generator() = default;
+    async_generator(async_generator &&other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    async_generator &operator=(async_generator &&other) noexcept {
+        if (this != &other) {
+            if (handle_) handle_.destroy();
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+    ~async_generator() {
+        if (handle_) handle_.destroy();
+    }
+
+    // Resume the generator until it produces its next value or finishes.
+    auto next() {
+        struct awaiter {
+            std::coroutine_handle<promise_type> generator;
+
+            bool await_ready() const noexcept { return generator.done(); }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> consumer) const noexcept {
+                generator.promise().consumer_ = consumer;
+                return generator;
+            }
+            const T *await_resume() const {
+                promise_type &promise = generator.promise();
+                if (promise.exception_) std::rethrow_exception(std::exchange(promise.exception_, nullptr));
+                return promise.value_;
+            }
+        };
+        return awaiter{handle_};
+    }
+
+private:
+    std::coroutine_handle<promise_type> handle_;
+
+    explicit async_generator(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+};
+
+// An asynchronous byte source. `source.read(buffer)` returns an awaiter which reads up to `buffer.size()`
+// bytes into `buffer` and resumes with the number of bytes read, or 0 at the end of the input.
+template <typename Source>
+concept async_byte_source = requires(Source &source, std::span<char> buffer) {
+    { source.read(buffer).await_resume() } -> std::convertible_to<std::size_t>;
+};
+
+// Lex the input from `source` with a C lexer configured like `config`, reading `chunk_size` bytes at a time.
+// As in budgeted lexing, a token is only accepted when the lexer stopped at least LXL_BUDGET_LOOKAHEAD
+// bytes before the end of the buffered input (or the source has ended). Otherwise the partial token is
+// rewound and more input is awaited, so only the partial token is lexed again. Accepted tokens point into
+// an internal buffer and are valid until the next token is requested. Token locations count from the
+// start of the whole input.
+// Input before the current token is discarded on each read, so the buffer holds at most a token and its
+// lookahead, plus a chunk, however long the lines are. Columns are carried across reads.
+// Unlike `lxl_lexer_from_config()`, the generator keeps the rule profile and indent stack of `config`, as
+// it is the only lexer using that copy of the configuration.
+// NOTE: `source` must outlive the generator, and the generator must not be destroyed while suspended
+// on a read.
+template <async_byte_source Source>
+async_generator<lxl_token> lex_async(
+    lxl_lexer config, Source &source, std::size_t chunk_size = 4096,
+    std::pmr::memory_resource *resource = std::pmr::get_default_resource()) {
+    LXL_ASSERT(chunk_size > 0);
+    std::pmr::vector<char> buffer(resource);
+    buffer.reserve(chunk_size);  // Keep `buffer.data()` non-NULL.
+    lxl_lexer lexer = lxl_lexer_from_config(&config, buffer.data(), buffer.data());
+    lexer.rule_profile = config.rule_profile;
+    lexer.indent_stack = config.indent_stack;
+    lexer.indent_capacity = config.indent_capacity;
+    bool at_eof = false;
+    constexpr std::size_t base_lookahead = 2*LXL_BUDGET_LOOKAHEAD;
+    std::size_t lookahead = base_lookahead;
+    for (;;) {
+        // Buffer enough input ahead of the lexer that most tokens are complete on the first attempt.
+        // The offside rule measures indentation while skipping it, so no input before the lexer is needed.
+        while (!at_eof && static_cast<std::size_t>(lexer.end - lexer.current) < lookahead) {
+            std::size_t kept = static_cast<std::size_t>(lexer.end - lexer.current);
+            if (lexer.current != buffer.data()) std::copy(lexer.current, lexer.end, buffer.data());
+            buffer.resize(kept + chunk_size);
+            std::size_t count = co_await source.read(std::span<char>(buffer.data() + kept, chunk_size));
+            LXL_ASSERT(count <= chunk_size);
+            buffer.resize(kept + count);
+            at_eof = (count == 0);
+            lexer.start = buffer.data();
+            lexer.current = lexer.start;
+            lexer.token_start = lexer.current;
+            lexer.end = lexer.start + buffer.size();
+        }
+        struct lxl_checkpoint checkpoint = lxl_lexer_save_checkpoint(&lexer);
+        int indent_depth = lexer.indent_depth;
+        int pending_dedents = lexer.pending_dedents;
+        lxl_token token = lxl_lexer_next_token(&lexer);
+        if (lexer.pos.line == checkpoint.pos.line) {
+            // Rewinding within a token (e.g. to lex a number as a float) recalculates the column from the
+            // start of the line, which may have been discarded. The column is known from the checkpoint.
+            const char *checkpoint_current = lexer.start + checkpoint.offset;
+            lexer.pos.column = checkpoint.pos.column + static_cast<int>(lexer.current - checkpoint_current);
+        }
+        if (at_eof || lexer.current + LXL_BUDGET_LOOKAHEAD <= lexer.end) {
+            // The token is complete.
+            if (LXL_TOKEN_IS_END(token)) co_return;
+            co_yield token;
+            lookahead = base_lookahead;
+            continue;
+        }
+        // The token may continue beyond the buffered input. Un-lex it and wait for more input, doubling
+        // the lookahead so that a long token is lexed again only a logarithmic number of times.
+        lxl_lexer_restore_checkpoint(&lexer, checkpoint);
+        lexer.indent_depth = indent_depth;
+        lexer.pending_dedents = pending_dedents;
+        lookahead = 2*static_cast<std::size_t>(lexer.end - lexer.current);
+    }
+}
+
+// END ASYNC LEXING.
+
+} // namespace lxl
+
+#endif  // LEXEL_HPP
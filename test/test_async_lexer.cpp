@@ -0,0 +1,191 @@
+#include "../lexel.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <coroutine>
+#include <exception>
+
+enum { T_INT, T_FLOAT, T_WORD, T_STRING, T_PLUS, T_ARROW, T_LET };
+
+static const char *const line_comments[] = {"#", NULL};
+static const struct lxl_delim_pair block_comments[] = {{"/*", "*/"}, {NULL, NULL}};
+static const struct lxl_delim_pair strings[] = {{"\"", "\""}, {NULL, NULL}};
+static const int string_types[] = {T_STRING};
+static const char *const puncts[] = {"->", "+", NULL};
+static const int punct_types[] = {T_ARROW, T_PLUS};
+static const char *const keywords[] = {"let", NULL};
+static const int keyword_types[] = {T_LET};
+
+static struct lxl_lexer make_config(void) {
+    struct lxl_lexer config = lxl_lexer_new("", NULL);
+    config.line_comment_openers = line_comments;
+    config.unnestable_comment_delims = block_comments;
+    config.multiline_string_delims = strings;
+    config.multiline_string_types = string_types;
+    config.default_int_base = 10;
+    config.default_int_type = T_INT;
+    config.default_float_base = 10;
+    config.default_float_type = T_FLOAT;
+    config.puncts = puncts;
+    config.punct_types = punct_types;
+    config.keywords = keywords;
+    config.keyword_types = keyword_types;
+    config.default_word_type = T_WORD;
+    config.word_lexing_rule = LXL_LEX_WORD;
+    return config;
+}
+
+// A byte source fed by hand from `main()`, standing in for a socket on an event loop. Each read suspends
+// until `feed()` is called.
+struct manual_source {
+    std::coroutine_handle<> reader;
+    std::span<char> buffer;
+    std::size_t count = 0;
+
+    struct awaiter {
+        manual_source *source;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) const noexcept { source->reader = handle; }
+        std::size_t await_resume() const noexcept { return source->count; }
+    };
+
+    awaiter read(std::span<char> buffer) {
+        this->buffer = buffer;
+        return awaiter{this};
+    }
+
+    // Deliver up to `length` bytes (0 for the end of the input) to the pending read and resume the reader.
+    std::size_t feed(const char *data, std::size_t length) {
+        count = std::min(length, buffer.size());
+        memcpy(buffer.data(), data, count);
+        std::exchange(reader, nullptr).resume();
+        return count;
+    }
+};
+
+static_assert(lxl::async_byte_source<manual_source>);
+
+// A coroutine which runs until its first suspension as soon as it is called.
+struct detached_task {
+    struct promise_type {
+        detached_task get_return_object() const noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+};
+
+// A memory resource which records the largest allocation made through it.
+class measuring_resource : public std::pmr::memory_resource {
+public:
+    std::size_t largest = 0;
+
+private:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+        largest = std::max(largest, bytes);
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+        return this == &other;
+    }
+};
+
+struct comparison {
+    const struct lxl_token *expected;
+    int token_count;
+    int mismatches;
+    bool finished;
+};
+
+static detached_task compare_tokens(lxl::async_generator<lxl_token> tokens, comparison &result) {
+    while (const struct lxl_token *token = co_await tokens.next()) {
+        const struct lxl_token &expected = result.expected[result.token_count++];
+        size_t length = (size_t)(token->end - token->start);
+        if (token->token_type != expected.token_type || length != (size_t)(expected.end - expected.start)
+            || memcmp(token->start, expected.start, length) != 0
+            || token->loc.line != expected.loc.line || token->loc.column != expected.loc.column) {
+            ++result.mismatches;
+        }
+    }
+    result.finished = true;
+}
+
+static comparison lex_in_chunks(const char *source, const struct lxl_token *expected, size_t chunk_size,
+                                std::pmr::memory_resource *resource = std::pmr::get_default_resource(),
+                                struct lxl_lexer config = make_config()) {
+    manual_source byte_source;
+    comparison result = {expected, 0, 0, false};
+    compare_tokens(lxl::lex_async(config, byte_source, 16, resource), result);
+    // The "event loop": deliver the input `chunk_size` bytes at a time while the lexer is waiting for it.
+    size_t length = strlen(source);
+    size_t offset = 0;
+    while (byte_source.reader) {
+        offset += byte_source.feed(source + offset, std::min(chunk_size, length - offset));
+    }
+    return result;
+}
+
+int main(void) {
+    // Tokens spanning chunk boundaries: a long word, a multiline string, a block comment and "->".
+    static char source[2048];
+    strcpy(source, "let x = 12345 + \"multi\nline string\" /* a comment\n spanning lines */ a->b\n");
+    memset(source + strlen(source), 'w', 300);  // A word longer than the lookahead.
+    strcat(source, " # trailing comment\n+ 7 \"unclosed");
+
+    struct lxl_lexer config = make_config();
+    struct lxl_lexer lexer = lxl_lexer_from_config(&config, source, NULL);
+    struct lxl_token expected[64];
+    int expected_count = (int)lxl_lexer_tokenize(&lexer, expected, 64);
+    printf("Tokens lexed from the whole input: %d (expected: 13)\n", expected_count);
+
+    static const size_t chunk_sizes[] = {1, 7, 1000};
+    for (size_t i = 0; i < sizeof chunk_sizes / sizeof chunk_sizes[0]; ++i) {
+        comparison result = lex_in_chunks(source, expected, chunk_sizes[i]);
+        printf("Chunks of %zu bytes: %d tokens, %d mismatches, finished = %d "
+               "(expected: 13 tokens, 0 mismatches, finished = 1)\n",
+               chunk_sizes[i], result.token_count, result.mismatches, result.finished);
+    }
+
+    // A line much longer than the buffer, with floats whose lexing rewinds to the start of the token.
+    static char long_line[100000];
+    static struct lxl_token long_expected[40000];
+    for (size_t i = 0; i + 12 < sizeof long_line; i += 12) memcpy(long_line + i, "ab 1.5 22 + ", 12);
+    strcpy(long_line + sizeof long_line - 10, "\n 1.25 x");
+    lexer = lxl_lexer_from_config(&config, long_line, NULL);
+    int long_count = (int)lxl_lexer_tokenize(&lexer, long_expected, 40000);
+    printf("Tokens lexed from the long line: %d (expected: 33332)\n", long_count);
+    for (size_t i = 0; i < sizeof chunk_sizes / sizeof chunk_sizes[0]; ++i) {
+        measuring_resource resource;
+        comparison result = lex_in_chunks(long_line, long_expected, chunk_sizes[i], &resource);
+        printf("Long line in chunks of %zu bytes: %d tokens, %d mismatches (expected: 33332 tokens, "
+               "0 mismatches)\n", chunk_sizes[i], result.token_count, result.mismatches);
+        printf("Largest buffer under 1 KB: %d (expected: 1)\n", resource.largest < 1024);
+    }
+
+    // Indentation is measured from the start of each line although earlier input is discarded.
+    static int indent_stack[16];
+    struct lxl_lexer offside_config = make_config();
+    offside_config.offside_rule = true;
+    offside_config.indent_stack = indent_stack;
+    offside_config.indent_capacity = 16;
+    const char *offside_source = "let a\n    b 1.5\n        c\n\t    d\n    e 22\ng\n";
+    lexer = lxl_lexer_from_config(&offside_config, offside_source, NULL);
+    static int reference_indent_stack[16];
+    lexer.indent_stack = reference_indent_stack;
+    lexer.indent_capacity = 16;
+    int offside_count = (int)lxl_lexer_tokenize(&lexer, expected, 64);
+    printf("Tokens lexed from the offside input: %d (expected: 15)\n", offside_count);
+    for (size_t i = 0; i < sizeof chunk_sizes / sizeof chunk_sizes[0]; ++i) {
+        comparison result = lex_in_chunks(offside_source, expected, chunk_sizes[i],
+                                          std::pmr::get_default_resource(), offside_config);
+        printf("Offside input in chunks of %zu bytes: %d tokens, %d mismatches (expected: 15 tokens, "
+               "0 mismatches)\n", chunk_sizes[i], result.token_count, result.mismatches);
+    }
+}
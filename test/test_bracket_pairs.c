@@ -0,0 +1,133 @@
+#define LEXEL_IMPLEMENTATION
+#include "../lexel.h"
+#include "test_random.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#define MAX_TOKENS 100000
+
+static const struct lxl_delim_pair brackets[] = {{"(", ")"}, {"[", "]"}, {"{", "}"}, {NULL, NULL}};
+
+static char source[MAX_TOKENS];
+static struct lxl_token tokens[MAX_TOKENS];
+static ptrdiff_t partners[MAX_TOKENS];
+static ptrdiff_t expected[MAX_TOKENS];
+static size_t stack[MAX_TOKENS];
+static char region_buffer[1 << 22];
+
+// Return the index of the bracket pair the token belongs to, and whether it opens the pair.
+static int bracket_kind(struct lxl_token token, bool *OUT_is_opener) {
+    for (int i = 0; brackets[i].opener != NULL; ++i) {
+        if (token.end - token.start != 1) break;
+        if (token.start[0] == brackets[i].opener[0] || token.start[0] == brackets[i].closer[0]) {
+            *OUT_is_opener = token.start[0] == brackets[i].opener[0];
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Pair the brackets by searching the whole stack for each closer, and return the number unbalanced.
+static size_t pair_naively(size_t count) {
+    size_t depth = 0;
+    size_t unmatched_count = 0;
+    for (size_t i = 0; i < count; ++i) {
+        expected[i] = LXL_BRACKET_NONE;
+        bool is_opener;
+        int kind = bracket_kind(tokens[i], &is_opener);
+        if (kind < 0) continue;
+        if (is_opener) {
+            stack[depth++] = i;
+            continue;
+        }
+        size_t d = depth;
+        while (d > 0 && bracket_kind(tokens[stack[d - 1]], &is_opener) != kind) --d;
+        if (d == 0) {
+            expected[i] = LXL_BRACKET_UNMATCHED;
+            ++unmatched_count;
+            continue;
+        }
+        for (size_t j = d; j < depth; ++j) {
+            expected[stack[j]] = LXL_BRACKET_UNMATCHED;
+            ++unmatched_count;
+        }
+        expected[stack[d - 1]] = (ptrdiff_t)i;
+        expected[i] = (ptrdiff_t)stack[d - 1];
+        depth = d - 1;
+    }
+    for (size_t j = 0; j < depth; ++j) {
+        expected[stack[j]] = LXL_BRACKET_UNMATCHED;
+        ++unmatched_count;
+    }
+    return unmatched_count;
+}
+
+// Lex `source` with the C preset into `tokens` and return the number of tokens.
+static size_t lex_source(void) {
+    struct lxl_lexer lexer = lxl_lexer_preset(LXL_LANG_C, source, NULL);
+    size_t count = 0;
+    for (;;) {
+        struct lxl_token token = lxl_lexer_next_token(&lexer);
+        if (LXL_TOKEN_IS_END(token)) return count;
+        tokens[count++] = token;
+    }
+}
+
+int main(void) {
+    // Random sequences of brackets and other tokens, mostly balanced.
+    static const char pieces[] = "((([[{{}}])))]x ";
+    int mismatches = 0;
+    int samples = 0;
+    for (int length = 0; length < 200; length += 3) {
+        for (int repeat = 0; repeat < 10; ++repeat) {
+            for (int i = 0; i < length; ++i) source[i] = pieces[next_random() % (sizeof pieces - 1)];
+            source[length] = '\0';
+            size_t count = lex_source();
+            size_t expected_unmatched = pair_naively(count);
+            struct lxl_region region = REGION_FROM_ARRAY(region_buffer);
+            size_t unmatched_count;
+            ++samples;
+            if (!lxl_tokens_pair_brackets(tokens, count, brackets, partners, &unmatched_count, &region)
+                || unmatched_count != expected_unmatched
+                || memcmp(partners, expected, count * sizeof *partners) != 0) {
+                ++mismatches;
+                continue;
+            }
+            // Pairing while lexing gives the same result.
+            region = REGION_FROM_ARRAY(region_buffer);
+            struct lxl_bracket_pairer pairer;
+            lxl_bracket_pairer_init(&pairer, brackets, partners, count, &region);
+            struct lxl_lexer lexer = lxl_lexer_preset(LXL_LANG_C, source, NULL);
+            size_t paired_count = lxl_lexer_tokenize_paired(&lexer, tokens, MAX_TOKENS, &pairer);
+            if (paired_count != count || lxl_bracket_pairer_finish(&pairer) != expected_unmatched
+                || memcmp(partners, expected, count * sizeof *partners) != 0) {
+                ++mismatches;
+            }
+        }
+    }
+    printf("Random samples: %d (expected: 670)\n", samples);
+    printf("Random samples paired differently from a naive search: %d (expected: 0)\n", mismatches);
+
+    // Closers of a kind which has no open bracket are flagged without searching the stack.
+    size_t half = 40000;
+    memset(source, '(', half);
+    memset(source + half, ']', half);
+    source[2*half] = '\0';
+    size_t count = lex_source();
+    struct lxl_region region = REGION_FROM_ARRAY(region_buffer);
+    size_t unmatched_count;
+    clock_t start = clock();
+    lxl_tokens_pair_brackets(tokens, count, brackets, partners, &unmatched_count, &region);
+    double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("Unbalanced brackets: %zu (expected: %zu)\n", unmatched_count, 2*half);
+    printf("Paired in under 0.1 s: %d (expected: 1)\n", seconds < 0.1);
+
+    // Initialization fails cleanly in a region which is too small.
+    char small_buffer[64];
+    region = REGION_FROM_ARRAY(small_buffer);
+    struct lxl_bracket_pairer pairer;
+    printf("Pairer created in a small region: %d (expected: 0)\n",
+           lxl_bracket_pairer_init(&pairer, brackets, partners, 100, &region));
+    printf("Bytes allocated: %zu (expected: 0)\n", region.alloc_count);
+}
@@ -0,0 +1,260 @@
+#define LEXEL_IMPLEMENTATION
+#include "../lexel.h"
+
+#include <stdio.h>
+
+#define MAX_TOKENS 1024
+
+static char source[4096];
+static char long_source[1 << 16];
+static struct lxl_token reference[MAX_TOKENS];
+static struct lxl_token tokens[MAX_TOKENS];
+
+// A Python-like language using the offside rule.
+static const char *const line_comments[] = {"#", NULL};
+static const char *const puncts[] = {":", "(", ")", ",", "=", NULL};
+static const int punct_types[] = {1, 2, 3, 4, 5};
+static const struct lxl_delim_pair brackets[] = {{"(", ")"}, {NULL, NULL}};
+static int indent_stack[16];
+
+static const char *const offside_source =
+    "def f(x):\n"
+    "    if x:\n"
+    "        return g(1,\n"
+    "                 2)  # continuation\n"
+    "\n"
+    "    y = x\n"
+    "class C:\n"
+    "    def m(self):\n"
+    "        pass\n"
+    "w = 3\n";
+
+static int poll_count;
+static int hook_calls;
+
+// A deadline which expires on every third check.
+static bool expires_every_third_poll(void *user_data) {
+    (void)user_data;
+    return ++poll_count % 3 == 0;
+}
+
+static bool always_expired(void *user_data) {
+    (void)user_data;
+    return true;
+}
+
+static void count_hook_call(struct lxl_lexer *lexer, struct lxl_token *token) {
+    (void)lexer;
+    (void)token;
+    ++hook_calls;
+}
+
+// Build a C source with comments and strings much longer than the slices used below.
+static void build_source(void) {
+    strcpy(source, "int main(void) {\n    /* ");
+    for (int i = 0; i < 40; ++i) strcat(source, "a long comment ");
+    strcat(source, "*/\n    char *s = \"");
+    for (int i = 0; i < 30; ++i) strcat(source, "a long string ");
+    strcat(source, "\";\n    return x->y[0] + 1.5e3 - 'c' + 0x1F; // end\n}\nchar *t = \"unclosed\n");
+    for (int i = 0; i < 20; ++i) strcat(source, "f(1, 2.5);\n");
+}
+
+static struct lxl_lexer offside_lexer(void) {
+    struct lxl_lexer lexer = lxl_lexer_new(offside_source, NULL);
+    lexer.line_comment_openers = line_comments;
+    lexer.default_int_base = 10;
+    lexer.puncts = puncts;
+    lexer.punct_types = punct_types;
+    lexer.word_lexing_rule = LXL_LEX_WORD;
+    lexer.bracket_delims = brackets;
+    lexer.offside_rule = true;
+    lexer.indent_stack = indent_stack;
+    lexer.indent_capacity = sizeof indent_stack / sizeof indent_stack[0];
+    return lexer;
+}
+
+// Return whether two tokens are identical.
+static bool same_token(struct lxl_token a, struct lxl_token b) {
+    return a.start == b.start && a.end == b.end && a.token_type == b.token_type
+        && a.loc.line == b.loc.line && a.loc.column == b.loc.column;
+}
+
+// Lex the whole source with repeated budgeted calls (doubling the byte budget whenever a call makes no
+// progress, as a token may be longer than it), and return whether the tokens match the reference.
+static bool budgeted_matches(const struct lxl_lexer *config, struct lxl_budget budget,
+                             size_t reference_count) {
+    struct lxl_lexer lexer = *config;
+    size_t count = 0;
+    for (;;) {
+        struct lxl_budget_result result =
+            lxl_lexer_tokenize_budgeted(&lexer, &tokens[count], MAX_TOKENS - count, budget);
+        count += result.token_count;
+        if (result.status == LXL_BUDGET_FINISHED) break;
+        if (result.byte_count == 0 && result.token_count == 0 && budget.max_bytes != 0) budget.max_bytes *= 2;
+    }
+    if (count != reference_count) return false;
+    for (size_t i = 0; i < count; ++i) {
+        if (!same_token(tokens[i], reference[i])) return false;
+    }
+    return true;
+}
+
+// Lex the input of `config` into `reference` (without the end token) and return the number of tokens.
+static size_t lex_reference(const struct lxl_lexer *config) {
+    struct lxl_lexer lexer = *config;
+    size_t count = 0;
+    for (;;) {
+        struct lxl_token token = lxl_lexer_next_token(&lexer);
+        if (LXL_TOKEN_IS_END(token)) return count;
+        reference[count++] = token;
+    }
+}
+
+// Lex the whole input of `config` with repeated budgeted calls, without changing the budget, and return
+// whether the tokens match `lxl_lexer_next_token()` and no call exceeded the byte budget. Count the calls in
+// OUT_calls.
+static bool resumed_matches(const struct lxl_lexer *config, struct lxl_budget budget, int *OUT_calls) {
+    size_t reference_count = lex_reference(config);
+    struct lxl_lexer lexer = *config;
+    size_t count = 0;
+    *OUT_calls = 0;
+    for (;;) {
+        struct lxl_budget_result result =
+            lxl_lexer_tokenize_budgeted(&lexer, &tokens[count], MAX_TOKENS - count, budget);
+        ++*OUT_calls;
+        count += result.token_count;
+        if (result.status == LXL_BUDGET_FINISHED) break;
+        if (budget.max_bytes != 0 && result.byte_count > budget.max_bytes) return false;
+        if (*OUT_calls > 10000) return false;  // No progress.
+    }
+    if (count != reference_count) return false;
+    for (size_t i = 0; i < count; ++i) {
+        if (!same_token(tokens[i], reference[i])) return false;
+    }
+    return true;
+}
+
+// Fill `long_source` with `before`, `length` copies of `c`, then `after`.
+static void build_long_source(const char *before, char c, size_t length, const char *after) {
+    size_t size = strlen(before);
+    memcpy(long_source, before, size);
+    memset(&long_source[size], c, length);
+    strcpy(&long_source[size + length], after);
+}
+
+// Lex the input of `config` with every combination of budgets and return the number of combinations giving
+// the same tokens as `lxl_lexer_next_token()`.
+static int check_budgets(const struct lxl_lexer *config, int *OUT_runs) {
+    static const size_t byte_budgets[] = {0, 1, 7, 100, 1000};
+    static const size_t token_budgets[] = {0, 1, 5};
+    static const size_t poll_intervals[] = {0, 1, 50};
+    size_t reference_count = lex_reference(config);
+    int matches = 0;
+    *OUT_runs = 0;
+    for (size_t i = 0; i < sizeof byte_budgets / sizeof byte_budgets[0]; ++i) {
+        for (size_t j = 0; j < sizeof token_budgets / sizeof token_budgets[0]; ++j) {
+            for (size_t k = 0; k < sizeof poll_intervals / sizeof poll_intervals[0]; ++k) {
+                struct lxl_budget budget = {
+                    .max_bytes = byte_budgets[i],
+                    .max_tokens = token_budgets[j],
+                    .expired = (poll_intervals[k] != 0) ? expires_every_third_poll : NULL,
+                    .poll_bytes = poll_intervals[k],
+                };
+                ++*OUT_runs;
+                if (budgeted_matches(config, budget, reference_count)) ++matches;
+            }
+        }
+    }
+    return matches;
+}
+
+int main(void) {
+    build_source();
+    int runs;
+    struct lxl_lexer c_config = lxl_lexer_preset(LXL_LANG_C, source, NULL);
+    int matches = check_budgets(&c_config, &runs);
+    printf("C budgeted runs matching lxl_lexer_next_token(): %d (expected: %d)\n", matches, runs);
+    struct lxl_lexer offside_config = offside_lexer();
+    matches = check_budgets(&offside_config, &runs);
+    printf("Offside budgeted runs matching lxl_lexer_next_token(): %d (expected: %d)\n", matches, runs);
+
+    struct lxl_lexer lexer = c_config;
+    lexer.after_token_hook = count_hook_call;
+    size_t reference_count = lex_reference(&lexer);
+    int reference_hook_calls = hook_calls;
+
+    // The budget is respected.
+    lexer = lxl_lexer_preset(LXL_LANG_C, source, NULL);
+    struct lxl_budget_result result = lxl_lexer_tokenize_budgeted(&lexer, tokens, MAX_TOKENS,
+                                                                  (struct lxl_budget) {.max_tokens = 3});
+    printf("Token budget: %zu tokens, status %d (expected: 3 tokens, status %d)\n",
+           result.token_count, result.status, LXL_BUDGET_EXHAUSTED);
+    lexer = lxl_lexer_preset(LXL_LANG_C, source, NULL);
+    result = lxl_lexer_tokenize_budgeted(&lexer, tokens, MAX_TOKENS, (struct lxl_budget) {.max_bytes = 30});
+    printf("Byte budget: %zu tokens, %zu bytes, status %d (expected: 6 tokens, 30 bytes, status %d)\n",
+           result.token_count, result.byte_count, result.status, LXL_BUDGET_EXHAUSTED);
+    lexer = lxl_lexer_preset(LXL_LANG_C, source, NULL);
+    result = lxl_lexer_tokenize_budgeted(&lexer, tokens, 4, (struct lxl_budget) {0});
+    printf("Output full: %zu tokens, status %d (expected: 4 tokens, status %d)\n",
+           result.token_count, result.status, LXL_BUDGET_FULL);
+
+    // Hooks run once per token produced, even for tokens which are retried with a larger slice.
+    lexer = lxl_lexer_preset(LXL_LANG_C, source, NULL);
+    lexer.after_token_hook = count_hook_call;
+    hook_calls = 0;
+    poll_count = 1;
+    size_t count = 0;
+    for (;;) {
+        struct lxl_budget budget = {.expired = expires_every_third_poll, .poll_bytes = 1};
+        result = lxl_lexer_tokenize_budgeted(&lexer, &tokens[count], MAX_TOKENS - count, budget);
+        count += result.token_count;
+        if (result.status == LXL_BUDGET_FINISHED) break;
+    }
+    printf("Hook calls: %d for %zu tokens (expected: %d for %zu tokens)\n",
+           hook_calls, count, reference_hook_calls, reference_count);
+
+    // Long comments and strings pause at the end of each slice, so calls stop in them and make progress
+    // however small the budget. The deadline is checked even before the first token.
+    build_long_source("a /* ", 'x', 50000, "");
+    lexer = lxl_lexer_preset(LXL_LANG_C, long_source, NULL);
+    struct lxl_budget expired_budget = {.expired = always_expired};
+    result = lxl_lexer_tokenize_budgeted(&lexer, tokens, MAX_TOKENS, expired_budget);
+    printf("First call in an unclosed comment: %zu tokens, status %d (expected: 1 tokens, status %d)\n",
+           result.token_count, result.status, LXL_BUDGET_EXPIRED);
+    result = lxl_lexer_tokenize_budgeted(&lexer, tokens, MAX_TOKENS, expired_budget);
+    // The scan pauses a lookahead before the end of the slice.
+    printf("Second call: %zu tokens, %zu bytes, status %d (expected: 0 tokens, %d bytes, status %d)\n",
+           result.token_count, result.byte_count, result.status, LXL_BUDGET_POLL_BYTES - LXL_BUDGET_LOOKAHEAD,
+           LXL_BUDGET_EXPIRED);
+    int calls;
+    struct lxl_lexer long_config = lxl_lexer_preset(LXL_LANG_C, long_source, NULL);
+    bool matches_reference = resumed_matches(&long_config, expired_budget, &calls);
+    printf("Unclosed comment resumed after each expiry: %d in %d calls (expected: 1 in 13 calls)\n",
+           matches_reference, calls);
+    build_long_source("a /* /* ", 'x', 50000, " */ b */ c \"\\\"\" d");
+    struct lxl_lexer nested_config = lxl_lexer_new(long_source, NULL);
+    static const struct lxl_delim_pair nested_comments[] = {{"/*", "*/"}, {NULL, NULL}};
+    nested_config.nestable_comment_delims = nested_comments;
+    matches_reference = resumed_matches(&nested_config, expired_budget, &calls);
+    printf("Nested comment resumed after each expiry: %d in %d calls (expected: 1 in 13 calls)\n",
+           matches_reference, calls);
+    matches_reference = resumed_matches(&nested_config, (struct lxl_budget) {.max_bytes = 1000}, &calls);
+    printf("Nested comment resumed with a byte budget: %d in %d calls (expected: 1 in 51 calls)\n",
+           matches_reference, calls);
+    build_long_source("a = \"", 'x', 50000, "\\\"\";\nb");
+    long_config = lxl_lexer_preset(LXL_LANG_C, long_source, NULL);
+    matches_reference = resumed_matches(&long_config, expired_budget, &calls);
+    printf("String resumed after each expiry: %d in %d calls (expected: 1 in 13 calls)\n",
+           matches_reference, calls);
+    matches_reference = resumed_matches(&long_config, (struct lxl_budget) {.max_bytes = 1000}, &calls);
+    printf("String resumed with a byte budget: %d in %d calls (expected: 1 in 51 calls)\n",
+           matches_reference, calls);
+
+    // A long token of another kind is retried with a larger slice, which later calls keep.
+    build_long_source("a ", 'x', 50000, " b");
+    long_config = lxl_lexer_preset(LXL_LANG_C, long_source, NULL);
+    matches_reference = resumed_matches(&long_config, (struct lxl_budget) {.expired = always_expired,
+                                                                          .poll_bytes = 1000}, &calls);
+    printf("Long word lexed after each expiry: %d in %d calls (expected: 1 in 8 calls)\n",
+           matches_reference, calls);
+}
@@ -0,0 +1,154 @@
+#define LEXEL_IMPLEMENTATION
+#include "../lexel.h"
+
+#include <stdio.h>
+
+#define MAX_TOKENS 1024
+
+// A Python-like language using the offside rule.
+enum token_type {T_WORD, T_INT, T_STRING, T_COLON, T_LPAREN, T_RPAREN, T_COMMA, T_ASSIGN, T_PLUS};
+
+static const char *const line_comments[] = {"#", NULL};
+static const struct lxl_delim_pair strings[] = {{"\"", "\""}, {NULL, NULL}};
+static const int string_types[] = {T_STRING};
+static const char *const puncts[] = {":", "(", ")", ",", "=", "+", NULL};
+static const int punct_types[] = {T_COLON, T_LPAREN, T_RPAREN, T_COMMA, T_ASSIGN, T_PLUS};
+static const struct lxl_delim_pair brackets[] = {{"(", ")"}, {NULL, NULL}};
+static int indent_stack[16];
+
+static const char *const offside_source =
+    "def f(x):\n"
+    "    if x:\n"
+    "        return g(1,\n"
+    "                 2)  # continuation\n"
+    "\n"
+    "    y = \"s\" + x\n"
+    "class C:\n"
+    "    def m(self):\n"
+    "        pass\n"
+    "z = \"unclosed\n"
+    "w = 3\n";
+
+static const char *const c_source =
+    "#include <stdio.h>\n"
+    "/* A block comment\n   spanning lines. */\n"
+    "static int f(const char *s) {\n"
+    "    return s[0] == '\\'' ? 0x1F : 1.5e3; // comment\n"
+    "}\n"
+    "char *t = \"a\\\"b\", *u = \"unclosed\n"
+    "int main(void) { return f(\"x\"); }\n";
+
+static struct lxl_token reference[MAX_TOKENS];
+
+static struct lxl_lexer offside_lexer(const char *source) {
+    struct lxl_lexer lexer = lxl_lexer_new(source, NULL);
+    lexer.line_comment_openers = line_comments;
+    lexer.line_string_delims = strings;
+    lexer.line_string_types = string_types;
+    lexer.default_int_base = 10;
+    lexer.default_int_type = T_INT;
+    lexer.puncts = puncts;
+    lexer.punct_types = punct_types;
+    lexer.default_word_type = T_WORD;
+    lexer.word_lexing_rule = LXL_LEX_WORD;
+    lexer.bracket_delims = brackets;
+    lexer.offside_rule = true;
+    lexer.indent_stack = indent_stack;
+    lexer.indent_capacity = sizeof indent_stack / sizeof indent_stack[0];
+    return lexer;
+}
+
+// Return whether two tokens are identical.
+static bool same_token(struct lxl_token a, struct lxl_token b) {
+    return a.start == b.start && a.end == b.end && a.token_type == b.token_type
+        && a.loc.line == b.loc.line && a.loc.column == b.loc.column;
+}
+
+// Lex the rest of the input into `reference` and return the number of tokens (including the end token).
+static size_t lex_reference(struct lxl_lexer *lexer) {
+    size_t count = 0;
+    for (;;) {
+        struct lxl_token token = lxl_lexer_next_token(lexer);
+        reference[count++] = token;
+        if (LXL_TOKEN_IS_END(token)) return count;
+    }
+}
+
+// Return whether the rest of the lexer's tokens are `reference[index..count)`.
+static bool matches_reference(struct lxl_lexer *lexer, size_t index, size_t count) {
+    for (size_t i = index; i < count; ++i) {
+        if (!same_token(lxl_lexer_next_token(lexer), reference[i])) return false;
+    }
+    return true;
+}
+
+// Build a checkpoint table for a fresh copy of `config`, then restore each checkpoint in another copy and
+// compare its tokens with the reference. Return the number of checkpoints which gave different tokens.
+static int check_table(const struct lxl_lexer *config, size_t *OUT_checkpoint_count) {
+    struct lxl_lexer lexer = *config;
+    size_t count = lex_reference(&lexer);
+    struct lxl_checkpoint checkpoints[64];
+    struct lxl_checkpoint_table table = lxl_checkpoint_table_new(checkpoints, 64, 16);
+    lexer = *config;
+    int mismatches = (lxl_lexer_build_checkpoints(&lexer, &table) == count) ? 0 : 1;
+
+    // Record the same checkpoints by hand, noting the index of the token lexed after each.
+    struct lxl_checkpoint_table by_hand = lxl_checkpoint_table_new((struct lxl_checkpoint[64]){0}, 64, 16);
+    size_t indices[64];
+    lexer = *config;
+    for (size_t i = 0; i < count; ++i) {
+        size_t checkpoint_count = by_hand.count;
+        lxl_checkpoint_table_record(&by_hand, &lexer);
+        if (by_hand.count > checkpoint_count) indices[checkpoint_count] = i;
+        lxl_lexer_next_token(&lexer);
+    }
+    if (by_hand.count != table.count) ++mismatches;
+
+    for (size_t i = 0; i < table.count; ++i) {
+        struct lxl_lexer restored = *config;
+        lxl_lexer_restore_checkpoint(&restored, checkpoints[i]);
+        if (!matches_reference(&restored, indices[i], count)) ++mismatches;
+    }
+    *OUT_checkpoint_count = table.count;
+    return mismatches;
+}
+
+int main(void) {
+    size_t checkpoint_count;
+    struct lxl_lexer c_config = lxl_lexer_preset(LXL_LANG_C, c_source, NULL);
+    int mismatches = check_table(&c_config, &checkpoint_count);
+    printf("C checkpoints giving different tokens: %d (expected: 0)\n", mismatches);
+    printf("C checkpoints recorded: %d (expected: 1)\n", checkpoint_count > 4);
+
+    struct lxl_lexer offside_config = offside_lexer(offside_source);
+    mismatches = check_table(&offside_config, &checkpoint_count);
+    printf("Offside checkpoints giving different tokens: %d (expected: 0)\n", mismatches);
+    printf("Offside checkpoints recorded: %d (expected: 1)\n", checkpoint_count > 1);
+
+    // A checkpoint saved inside indented blocks keeps the indent depth and pending dedents.
+    struct lxl_lexer lexer = offside_lexer("a:\n    b:\n        c d\n");
+    size_t count = lex_reference(&lexer);
+    lexer = offside_lexer("a:\n    b:\n        c d\n");
+    size_t index = 0;
+    while (reference[index].token_type != T_WORD || reference[index].start[0] != 'c') {
+        lxl_lexer_next_token(&lexer);
+        ++index;
+    }
+    struct lxl_checkpoint checkpoint = lxl_lexer_save_checkpoint(&lexer);
+    printf("Indent depth saved: %d (expected: 2)\n", checkpoint.indent_depth);
+    lxl_lexer_next_token(&lexer);
+    lxl_lexer_restore_checkpoint(&lexer, checkpoint);
+    printf("Tokens after restoring inside blocks match: %d (expected: 1)\n",
+           matches_reference(&lexer, index, count));
+
+    // Checkpoints can be found by offset.
+    struct lxl_checkpoint checkpoints[8];
+    struct lxl_checkpoint_table table = lxl_checkpoint_table_new(checkpoints, 8, 10);
+    lexer = lxl_lexer_preset(LXL_LANG_C, c_source, NULL);
+    lxl_lexer_build_checkpoints(&lexer, &table);
+    printf("Table filled up: %d (expected: 1)\n", table.count == 8);
+    const struct lxl_checkpoint *found = lxl_checkpoint_table_find(&table, 45);
+    printf("Found checkpoint at or before 45: %d (expected: 1)\n",
+           found != NULL && found->offset <= 45 && (found + 1)->offset > 45);
+    printf("Checkpoint before the first: %d (expected: 1)\n", lxl_checkpoint_table_find(&table, 0) != NULL);
+}
@@ -0,0 +1,98 @@
+#define LEXEL_IMPLEMENTATION
+#include "../lexel.h"
+
+#include <stdio.h>
+
+#if defined(LXL_HAS_CONFIG_PUBLICATION) && !defined(__STDC_NO_THREADS__)
+
+#include <threads.h>
+
+#define CONFIG_COUNT 64
+#define READER_COUNT 4
+
+static const char *const source =
+    "int main(void) { /* comment */ return x->y[0] + 1.5e3 - 'c'; } // end\n\"unclosed";
+
+// Configurations are marked as reclaimed by setting their default word type to this value.
+#define RECLAIMED (-99)
+
+static struct lxl_lexer configs[CONFIG_COUNT];
+static struct lxl_config_slot slot;
+static atomic_bool done;
+static atomic_uint reclaimed_uses;
+
+// Return whether two token streams are identical.
+static bool same_tokens(struct lxl_lexer *a, struct lxl_lexer *b) {
+    for (;;) {
+        struct lxl_token token_a = lxl_lexer_next_token(a);
+        struct lxl_token token_b = lxl_lexer_next_token(b);
+        if (token_a.start != token_b.start || token_a.end != token_b.end
+            || token_a.token_type != token_b.token_type) {
+            return false;
+        }
+        if (LXL_TOKEN_IS_END(token_a)) return true;
+    }
+}
+
+static int reader(void *arg) {
+    (void)arg;
+    while (!atomic_load(&done)) {
+        struct lxl_config_ref ref = lxl_config_acquire(&slot);
+        struct lxl_lexer lexer = lxl_lexer_from_config(ref.config, source, NULL);
+        for (;;) {
+            struct lxl_token token = lxl_lexer_next_token(&lexer);
+            if (LXL_TOKEN_IS_END(token)) break;
+        }
+        if (ref.config->default_word_type == RECLAIMED) atomic_fetch_add(&reclaimed_uses, 1);
+        lxl_config_release(&slot, ref);
+    }
+    return 0;
+}
+
+int main(void) {
+    for (int i = 0; i < CONFIG_COUNT; ++i) {
+        configs[i] = lxl_lexer_preset(LXL_LANG_C, "", NULL);
+    }
+    lxl_config_slot_init(&slot, &configs[0]);
+
+    // A lexer created from the published configuration lexes as the configuration itself does.
+    struct lxl_config_ref ref = lxl_config_acquire(&slot);
+    struct lxl_lexer from_slot = lxl_lexer_from_config(ref.config, source, NULL);
+    struct lxl_lexer direct = lxl_lexer_preset(LXL_LANG_C, source, NULL);
+    printf("Lexer from slot matches: %d (expected: 1)\n", same_tokens(&from_slot, &direct));
+
+    // The old configuration is held until the reference taken before publication is released.
+    const struct lxl_lexer *old_config = lxl_config_publish(&slot, &configs[1]);
+    printf("Publish returns the old configuration: %d (expected: 1)\n", old_config == &configs[0]);
+    printf("Quiescent with a reader: %d (expected: 0)\n", lxl_config_is_quiescent(&slot));
+    struct lxl_config_ref new_ref = lxl_config_acquire(&slot);
+    printf("New reader sees the new configuration: %d (expected: 1)\n", new_ref.config == &configs[1]);
+    lxl_config_release(&slot, ref);
+    printf("Quiescent after release: %d (expected: 1)\n", lxl_config_is_quiescent(&slot));
+    lxl_config_release(&slot, new_ref);
+
+    // Publish while readers are lexing, reclaiming each replaced configuration after a grace period.
+    thrd_t readers[READER_COUNT];
+    for (int i = 0; i < READER_COUNT; ++i) {
+        thrd_create(&readers[i], reader, NULL);
+    }
+    for (int i = 2; i < CONFIG_COUNT; ++i) {
+        struct lxl_lexer *replaced = (struct lxl_lexer *)lxl_config_publish(&slot, &configs[i]);
+        lxl_config_synchronize(&slot);
+        replaced->default_word_type = RECLAIMED;
+        thrd_yield();
+    }
+    atomic_store(&done, true);
+    for (int i = 0; i < READER_COUNT; ++i) {
+        thrd_join(readers[i], NULL);
+    }
+    printf("Reclaimed configurations used: %u (expected: 0)\n", atomic_load(&reclaimed_uses));
+}
+
+#else
+
+int main(void) {
+    printf("Config publication is unavailable.\n");
+}
+
+#endif
@@ -0,0 +1,94 @@
+#define LEXEL_IMPLEMENTATION
+#include "../lexel.h"
+
+#include <stdio.h>
+
+// The same program three times: reformatted (same tokens), and with a change in the second function.
+static const char *const original =
+    "int f(int x) { return x + 1; }\n"
+    "int g(void) { return f(2) * 3; }\n"
+    "static int h;\n";
+static const char *const reformatted =
+    "int f ( int x )\n{\n    return x+1;  // Add one.\n}\n"
+    "/* g */ int g(void) {return f(2)*3;}\n"
+    "static   int h ;";
+static const char *const changed =
+    "int f(int x) { return x + 1; }\n"
+    "int g(void) { return f(2) * 4; }\n"
+    "static int h;\n";
+
+// Return the type of a punct of the C preset.
+static int c_punct_type(const char *punct) {
+    struct lxl_lexer lexer = lxl_lexer_preset(LXL_LANG_C, "", NULL);
+    for (int i = 0; lexer.puncts[i] != NULL; ++i) {
+        if (strcmp(lexer.puncts[i], punct) == 0) return LXL_PRESET_PUNCT + i;
+    }
+    return -1;
+}
+
+// Fingerprint a C source, writing block fingerprints to `blocks` and the number of blocks to
+// OUT_block_count.
+static struct lxl_hash128 fingerprint(const char *source, struct lxl_block_fingerprint *blocks,
+                                      size_t *OUT_block_count) {
+    struct lxl_lexer lexer = lxl_lexer_preset(LXL_LANG_C, source, NULL);
+    struct lxl_fingerprinter fingerprinter = lxl_fingerprinter_new();
+    lxl_fingerprinter_set_blocks(&fingerprinter, c_punct_type("{"), c_punct_type("}"), blocks, 4);
+    struct lxl_hash128 hash = lxl_lexer_fingerprint(&lexer, &fingerprinter);
+    *OUT_block_count = fingerprinter.block_count;
+    return hash;
+}
+
+int main(void) {
+    struct lxl_block_fingerprint original_blocks[4];
+    struct lxl_block_fingerprint reformatted_blocks[4];
+    struct lxl_block_fingerprint changed_blocks[4];
+    size_t original_count, reformatted_count, changed_count;
+    struct lxl_hash128 original_hash = fingerprint(original, original_blocks, &original_count);
+    struct lxl_hash128 reformatted_hash = fingerprint(reformatted, reformatted_blocks, &reformatted_count);
+    struct lxl_hash128 changed_hash = fingerprint(changed, changed_blocks, &changed_count);
+    printf("Reformatted source has the same fingerprint: %d (expected: 1)\n",
+           lxl_hash128_equal(original_hash, reformatted_hash));
+    printf("Changed source has the same fingerprint: %d (expected: 0)\n",
+           lxl_hash128_equal(original_hash, changed_hash));
+
+    // Blocks: f, g and the trailing declaration.
+    printf("Blocks: %zu %zu %zu (expected: 3 3 3)\n", original_count, reformatted_count, changed_count);
+    int same_blocks = 0;
+    for (size_t i = 0; i < 3; ++i) {
+        same_blocks += lxl_hash128_equal(original_blocks[i].hash, reformatted_blocks[i].hash);
+    }
+    printf("Reformatted blocks with the same fingerprint: %d (expected: 3)\n", same_blocks);
+    printf("Changed blocks with the same fingerprint: %d %d %d (expected: 1 0 1)\n",
+           lxl_hash128_equal(original_blocks[0].hash, changed_blocks[0].hash),
+           lxl_hash128_equal(original_blocks[1].hash, changed_blocks[1].hash),
+           lxl_hash128_equal(original_blocks[2].hash, changed_blocks[2].hash));
+    printf("Second block: '%.*s' (expected: 'int g(void) { return f(2) * 3; }')\n",
+           (int)(original_blocks[1].end - original_blocks[1].start), original_blocks[1].start);
+
+    // Adding tokens one at a time gives the same fingerprint as fingerprinting the lexer.
+    struct lxl_lexer lexer = lxl_lexer_preset(LXL_LANG_INI, "[a]\nb = 1\n\nc = \"d\"\n", NULL);
+    struct lxl_lexer copy = lexer;
+    struct lxl_fingerprinter by_lexer = lxl_fingerprinter_new();
+    struct lxl_fingerprinter by_token = lxl_fingerprinter_new();
+    struct lxl_hash128 lexer_hash = lxl_lexer_fingerprint(&lexer, &by_lexer);
+    for (;;) {
+        struct lxl_token token = lxl_lexer_next_token(&copy);
+        if (LXL_TOKEN_IS_END(token)) break;
+        lxl_fingerprinter_add_token(&by_token, token);
+    }
+    printf("Fingerprint by token matches: %d (expected: 1)\n",
+           lxl_hash128_equal(lexer_hash, lxl_fingerprinter_finish(&by_token)));
+
+    // Hashing in pieces gives the same hash as hashing all at once.
+    const char *text = "The quick brown fox jumps over the lazy dog, twice over.";
+    struct lxl_hasher whole, pieces;
+    lxl_hasher_init(&whole, 7);
+    lxl_hasher_init(&pieces, 7);
+    lxl_hasher_update(&whole, text, strlen(text));
+    for (size_t i = 0; i < strlen(text); i += 5) {
+        size_t length = strlen(text) - i < 5 ? strlen(text) - i : 5;
+        lxl_hasher_update(&pieces, text + i, length);
+    }
+    printf("Hash in pieces matches: %d (expected: 1)\n",
+           lxl_hash128_equal(lxl_hasher_final(&whole), lxl_hasher_final(&pieces)));
+}
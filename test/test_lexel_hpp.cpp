@@ -0,0 +1,127 @@
+#include "../lexel.hpp"
+
+#include <stdio.h>
+
+enum {
+    T_INT, T_FLOAT, T_STRING, T_WORD,
+    T_LPAREN, T_RPAREN, T_ASSIGN, T_EQ, T_ARROW, T_MINUS, T_PLUS, T_SEMICOLON,
+    T_LET, T_IF, T_RETURN,
+};
+
+constexpr std::string_view line_comments[] = {"//"};
+constexpr lxl::delim_rule block_comments[] = {{"/*", "*/"}};
+constexpr lxl::delim_rule strings[] = {{"\"", "\"", T_STRING}};
+constexpr lxl::prefix_rule int_prefixes[] = {{"0x", 16}, {"0b", 2}};
+// Deliberately listed shortest first: the trie uses the longest match regardless.
+constexpr lxl::token_rule puncts[] = {
+    {"(", T_LPAREN}, {")", T_RPAREN}, {"=", T_ASSIGN}, {"==", T_EQ}, {"-", T_MINUS}, {"->", T_ARROW},
+    {"+", T_PLUS}, {";", T_SEMICOLON},
+};
+constexpr lxl::token_rule keywords[] = {{"let", T_LET}, {"if", T_IF}, {"return", T_RETURN}};
+
+constexpr lxl::spec toy_spec = {
+    .line_comments = line_comments,
+    .unnestable_comments = block_comments,
+    .line_strings = strings,
+    .string_escape_chars = "\\",
+    .digit_separators = "_",
+    .integer_prefixes = int_prefixes,
+    .default_int_type = T_INT,
+    .default_int_base = 10,
+    .default_float_type = T_FLOAT,
+    .default_float_base = 10,
+    .puncts = puncts,
+    .keywords = keywords,
+    .default_word_type = T_WORD,
+    .word_lexing_rule = LXL_LEX_WORD,
+};
+
+// The same language with "1e5" lexed as a float.
+constexpr lxl::spec extended_spec = [] {
+    lxl::spec spec = toy_spec;
+    spec.extended_floats = true;
+    return spec;
+}();
+
+// Inputs lexed with both lexers of each spec.
+static const char *const differential_sources[] = {
+    "1e5 7e+2x 10e5f 1.e5 3. 1e 1e+ 1e+x 0x 0xg 0b2 1_000.5 1__0 0x1F_FF -3 - 3 x-3 1.2.3 2.5e-3",
+    // Numbers.
+    ".5 5. 00 007 0x_1 0x1_ 1_ _1 1._5 1.5_ 0b101 0b 0B1 0X1F 1e_5 1e5_ 0x1.8 9x 1.5.e5 1-2 1+-2 -0x1F",
+    // Escapes.
+    "\"a \\\"b\\\"\" \"\\\\\" x \"\\\\\\\"\" \"\\n\" \"\\\" \\ x\\y \"a\\\nb\" \"\\\"\"\"",
+    // Unclosed strings and comments.
+    "\"unclosed",
+    "\"unclosed\\",
+    "\"line\nbreak\" x",
+    "x /* never closed",
+    "x /* never closed *",
+    "\"\" \"",
+};
+
+static const char source[] =
+    "let x = 0x1F + 1_000; // Comment.\n"
+    "if (x == 2.5e-3) -> return \"a \\\"b\\\"\";\n"
+    "/* block\n comment */ y=-3 z\n"
+    "\"unclosed\n";
+
+// Lex `input` with the static lexer and the C lexer configured from `Spec`, and return the number of tokens
+// which differ.
+template <const lxl::spec &Spec>
+static int count_mismatches(const char *input) {
+    lxl::static_lexer<Spec> lexer(input);
+    struct lxl_lexer c_lexer = lxl_lexer_new(input, NULL);
+    lxl::static_lexer<Spec>::configure(c_lexer);
+    int mismatches = 0;
+    for (;;) {
+        struct lxl_token token = lexer.next_token();
+        struct lxl_token c_token = lxl_lexer_next_token(&c_lexer);
+        if (token.start != c_token.start || token.end != c_token.end || token.token_type != c_token.token_type
+            || token.loc.line != c_token.loc.line || token.loc.column != c_token.loc.column) {
+            ++mismatches;
+        }
+        if (LXL_TOKEN_IS_END(token) || LXL_TOKEN_IS_END(c_token)) return mismatches;
+    }
+}
+
+int main(void) {
+    lxl::static_lexer<toy_spec> lexer(source);
+    struct lxl_lexer c_lexer = lxl_lexer_new(source, NULL);
+    lxl::static_lexer<toy_spec>::configure(c_lexer);
+
+    int count = 0;
+    int mismatches = 0;
+    for (;;) {
+        struct lxl_token token = lexer.next_token();
+        struct lxl_token c_token = lxl_lexer_next_token(&c_lexer);
+        if (token.start != c_token.start || token.end != c_token.end || token.token_type != c_token.token_type
+            || token.loc.line != c_token.loc.line || token.loc.column != c_token.loc.column) {
+            ++mismatches;
+        }
+        if (LXL_TOKEN_IS_END(token)) break;
+        ++count;
+        if (count == 4) {
+            printf("Token 4: '%.*s' [type = %d] (expected: '0x1F' [type = %d])\n",
+                   (int)(token.end - token.start), token.start, token.token_type, T_INT);
+        }
+        if (count == 11) {
+            printf("Token 11: '%.*s' [type = %d] (expected: '==' [type = %d])\n",
+                   (int)(token.end - token.start), token.start, token.token_type, T_EQ);
+        }
+    }
+    printf("Token count: %d (expected: 23)\n", count);
+    printf("Mismatches with the C lexer: %d (expected: 0)\n", mismatches);
+
+    mismatches = 0;
+    for (const char *input : differential_sources) {
+        mismatches += count_mismatches<toy_spec>(input) + count_mismatches<extended_spec>(input);
+    }
+    printf("Mismatches with the C lexer on other inputs: %d (expected: 0)\n", mismatches);
+
+    // With `extended_floats`, an integer with an exponent is a float.
+    lxl::static_lexer<extended_spec> extended("1e5");
+    lxl::static_lexer<toy_spec> plain("1e5");
+    printf("Type of 1e5 with extended floats: %d (expected: %d)\n", extended.next_token().token_type,
+           T_FLOAT);
+    printf("Type of 1e5 without: %d (expected: %d)\n", plain.next_token().token_type, T_INT);
+}
@@ -0,0 +1,134 @@
+#define LEXEL_IMPLEMENTATION
+#include "../lexel.h"
+
+#include <stdio.h>
+
+#define MAX_OUTPUT 256
+
+static const char *const puncts[] = {"(", ")", NULL};
+static const int punct_types[] = {1, 2};
+static const struct lxl_delim_pair brackets[] = {{"(", ")"}, {NULL, NULL}};
+static const struct lxl_delim_pair comments[] = {{"/*", "*/"}, {NULL, NULL}};
+static const struct lxl_delim_pair strings[] = {{"\"", "\""}, {NULL, NULL}};
+static const int string_types[] = {3};
+static int indent_stack[16];
+static char output[MAX_OUTPUT];
+
+static struct lxl_lexer new_lexer(const char *source) {
+    struct lxl_lexer lexer = lxl_lexer_new(source, NULL);
+    lexer.puncts = puncts;
+    lexer.punct_types = punct_types;
+    lexer.default_word_type = 0;
+    lexer.word_lexing_rule = LXL_LEX_WORD;
+    lexer.bracket_delims = brackets;
+    lexer.unnestable_comment_delims = comments;
+    lexer.multiline_string_delims = strings;
+    lexer.multiline_string_types = string_types;
+    lexer.offside_rule = true;
+    lexer.indent_stack = indent_stack;
+    lexer.indent_capacity = sizeof indent_stack / sizeof indent_stack[0];
+    return lexer;
+}
+
+// Lex the rest of the input and return it as text: "I" for indents, "D" for dedents, "!" for errors, "S"
+// for strings, "L" for line endings and the text of other tokens, separated by spaces.
+static const char *render(struct lxl_lexer *lexer) {
+    size_t length = 0;
+    for (;;) {
+        struct lxl_token token = lxl_lexer_next_token(lexer);
+        if (LXL_TOKEN_IS_END(token)) break;
+        const char *text = NULL;
+        if (token.token_type == lexer->indent_type) text = "I";
+        else if (token.token_type == lexer->dedent_type) text = "D";
+        else if (LXL_TOKEN_IS_ERROR(token)) text = "!";
+        else if (token.token_type == string_types[0]) text = "S";
+        else if (token.token_type == LXL_TOKEN_LINE_ENDING) text = "L";
+        int text_length = (text != NULL) ? 1 : (int)(token.end - token.start);
+        if (text == NULL) text = token.start;
+        length += snprintf(&output[length], MAX_OUTPUT - length, (length == 0) ? "%.*s" : " %.*s",
+                           text_length, text);
+    }
+    output[length] = '\0';
+    return output;
+}
+
+int main(void) {
+    struct lxl_lexer lexer = new_lexer("a\n  b\n    c\nd\n");
+    printf("Nested blocks: %s (expected: a I b I c D D d)\n", render(&lexer));
+    lexer = new_lexer("a\n  b\n    c");
+    printf("Blocks open at the end: %s (expected: a I b I c D D)\n", render(&lexer));
+    lexer = new_lexer("a\n  b\n\n      \n  c\nd");
+    printf("Blank lines: %s (expected: a I b c D d)\n", render(&lexer));
+    lexer = new_lexer("a (\nb\n      c) d\n  e\n");
+    printf("Continuation lines: %s (expected: a ( b c ) d I e D)\n", render(&lexer));
+    lexer = new_lexer("a (\n  b ) c\n  d\n");
+    printf("Line after a closed bracket: %s (expected: a ( b ) c I d D)\n", render(&lexer));
+
+    // Only lines whose start is reached by skipping whitespace are measured, before any comment.
+    lexer = new_lexer("a\n/* c */ b\n");
+    printf("Comment before the first token: %s (expected: a b)\n", render(&lexer));
+    lexer = new_lexer("a\n  /* c */\n  b\n/* c\n    */ c\n");
+    printf("Comments across lines: %s (expected: a I b D c)\n", render(&lexer));
+    lexer = new_lexer("a = \"x\ny\" + 1\nz");
+    printf("Line started in a string: %s (expected: a = S + 1 z)\n", render(&lexer));
+    lexer = new_lexer("a /* x\ny */ b\nz");
+    printf("Line started in a comment: %s (expected: a b z)\n", render(&lexer));
+    lexer = new_lexer("  a\n  b\n");
+    printf("Indented first line: %s (expected: I a b D)\n", render(&lexer));
+    lexer = new_lexer("a\n  b\n\n  c\nd\n");
+    lexer.emit_line_endings = true;
+    lexer.collect_line_endings = false;
+    printf("Line ending tokens: %s (expected: a L I b L L c L D d L)\n", render(&lexer));
+
+    // Errors are reported at the first token of the line, which is then lexed normally.
+    lexer = new_lexer("a\n    b\n  c\n");
+    printf("Inconsistent dedent: %s (expected: a I b ! c)\n", render(&lexer));
+    lexer = new_lexer("a\n b\n  c\n   d\ne\n");
+    lexer.indent_capacity = 2;
+    printf("Indent overflow: %s (expected: a I b I c ! d D D e)\n", render(&lexer));
+
+    // Tab policies.
+    static const char *const tabbed = "a\n\tb\n        c\n";
+    lexer = new_lexer(tabbed);
+    printf("Expanded tabs: %s (expected: a I b c D)\n", render(&lexer));
+    lexer = new_lexer("a\n  \tb\n    c\n");
+    lexer.tab_width = 4;
+    printf("Tabs expanded to a width of 4: %s (expected: a I b c D)\n", render(&lexer));
+    lexer = new_lexer(tabbed);
+    lexer.tab_policy = LXL_TABS_SINGLE;
+    printf("Single-column tabs: %s (expected: a I b I c D D)\n", render(&lexer));
+    lexer = new_lexer(tabbed);
+    lexer.tab_policy = LXL_TABS_REJECT;
+    printf("Rejected tabs: %s (expected: a ! b I c D)\n", render(&lexer));
+    lexer = new_lexer(tabbed);
+    lexer.tab_policy = LXL_TABS_REJECT;
+    lxl_lexer_next_token(&lexer);
+    struct lxl_token token = lxl_lexer_next_token(&lexer);
+    printf("Rejected tab error: %d (expected: %d)\n", token.token_type, LXL_LERR_TAB_INDENT);
+
+    // Indents and dedents are zero-width tokens of the configured types at the first token of the line.
+    lexer = new_lexer("a\n  b\n");
+    lexer.indent_type = 100;
+    lexer.dedent_type = 101;
+    lxl_lexer_next_token(&lexer);
+    token = lxl_lexer_next_token(&lexer);
+    printf("Indent: type %d at %d:%d, %d bytes (expected: type 100 at 1:2, 0 bytes)\n",
+           token.token_type, token.loc.line, token.loc.column, (int)(token.end - token.start));
+    lxl_lexer_next_token(&lexer);
+    token = lxl_lexer_next_token(&lexer);
+    printf("Dedent at the end: type %d at %d:%d (expected: type 101 at 2:0)\n",
+           token.token_type, token.loc.line, token.loc.column);
+    token = lxl_lexer_next_token(&lexer);
+    printf("Then the end: %d (expected: 1)\n", LXL_TOKEN_IS_END(token));
+
+    // Lexers created from a configuration need their own indent stack.
+    struct lxl_lexer config = new_lexer("");
+    lexer = lxl_lexer_from_config(&config, "a\n  b\n", NULL);
+    printf("Indent stack taken from the configuration: %d (expected: 0)\n", lexer.indent_stack != NULL);
+    printf("Without an indent stack: %s (expected: a ! b)\n", render(&lexer));
+    static int own_stack[4];
+    lexer = lxl_lexer_from_config(&config, "a\n  b\n", NULL);
+    lexer.indent_stack = own_stack;
+    lexer.indent_capacity = 4;
+    printf("With its own indent stack: %s (expected: a I b D)\n", render(&lexer));
+}
@@ -0,0 +1,104 @@
+#define LEXEL_IMPLEMENTATION
+#include "../lexel.h"
+
+#include <stdio.h>
+
+struct sample {
+    enum lxl_language language;
+    const char *source;
+};
+
+static const struct sample samples[] = {
+    {LXL_LANG_C, "int main(void) {\n    return x->y[0] + 1.5e3 - 'c';  // comment\n}\n\n\n"
+                 "/* multi\n   line */ s = \"a\\\"b\"; t = \"unclosed\n"},
+    {LXL_LANG_C, "/* unclosed comment"},
+    {LXL_LANG_C, ""},
+    {LXL_LANG_SQL, "SELECT 'multi\nline' FROM t WHERE \"Quoted\nName\" <> 1.5;"},
+    {LXL_LANG_INI, "[section]\nkey = \"value\" ; comment\n\n\nn = 0x1F\n"},
+};
+
+#define SAMPLE_COUNT (sizeof samples / sizeof samples[0])
+#define SKIP_INTERVAL 4
+
+static unsigned char data[1 << 14];
+static struct lxl_packed_skip skips[256];
+static struct lxl_token tokens[1024];
+
+// Return whether two tokens are identical.
+static bool same_token(struct lxl_token a, struct lxl_token b) {
+    return a.start == b.start && a.end == b.end && a.token_type == b.token_type
+        && a.loc.line == b.loc.line && a.loc.column == b.loc.column;
+}
+
+// Pack the tokens in `tokens[0..count)` and return whether decoding them, sequentially and from every
+// index, gives the same tokens.
+static bool round_trips(const char *source_start, size_t count) {
+    struct lxl_packed_tokens packed = lxl_packed_tokens_new(source_start, data, sizeof data, skips, 256,
+                                                            SKIP_INTERVAL);
+    for (size_t i = 0; i < count; ++i) {
+        if (!lxl_packed_tokens_push(&packed, tokens[i])) return false;
+    }
+    struct lxl_packed_cursor cursor = lxl_packed_cursor_new(&packed);
+    struct lxl_token token;
+    for (size_t i = 0; i < count; ++i) {
+        if (!lxl_packed_cursor_next(&cursor, &token) || !same_token(token, tokens[i])) return false;
+    }
+    if (lxl_packed_cursor_next(&cursor, &token)) return false;
+    for (size_t i = 0; i < count; ++i) {
+        cursor = lxl_packed_cursor_at(&packed, i);
+        if (!lxl_packed_cursor_next(&cursor, &token) || !same_token(token, tokens[i])) return false;
+    }
+    return true;
+}
+
+// Lex the sample into `tokens` (including the end token) and return the number of tokens.
+static size_t lex_sample(const struct sample *sample) {
+    struct lxl_lexer lexer = lxl_lexer_preset(sample->language, sample->source, NULL);
+    size_t count = 0;
+    for (;;) {
+        struct lxl_token token = lxl_lexer_next_token(&lexer);
+        tokens[count++] = token;
+        if (LXL_TOKEN_IS_END(token)) break;
+    }
+    return count;
+}
+
+int main(void) {
+    int matches = 0;
+    for (size_t i = 0; i < SAMPLE_COUNT; ++i) {
+        // Tokens as lexed.
+        size_t count = lex_sample(&samples[i]);
+        if (round_trips(samples[i].source, count)) ++matches;
+
+        // The same tokens with unknown locations, as read from a token stream without locations.
+        for (size_t j = 0; j < count; ++j) {
+            tokens[j].loc = (struct lxl_location) {-1, -1};
+        }
+        if (round_trips(samples[i].source, count)) ++matches;
+
+        // Every other token with an unknown location, so that lines go backwards.
+        count = lex_sample(&samples[i]);
+        for (size_t j = 0; j < count; j += 2) {
+            tokens[j].loc = (struct lxl_location) {-1, -1};
+        }
+        if (round_trips(samples[i].source, count)) ++matches;
+    }
+    printf("Samples decoded exactly: %d (expected: %d)\n", matches, 3 * (int)SAMPLE_COUNT);
+
+    // Typical tokens are small (the preset punct and keyword types take two bytes).
+    const struct sample *sample = &samples[0];
+    size_t count = lex_sample(sample);
+    struct lxl_packed_tokens packed = lxl_packed_tokens_new(sample->source, data, sizeof data, NULL, 0, 0);
+    struct lxl_lexer lexer = lxl_lexer_preset(sample->language, sample->source, NULL);
+    printf("Tokens pushed from the lexer: %zu (expected: %zu)\n",
+           lxl_packed_tokens_push_lexer(&packed, &lexer), count);
+    printf("At most 6 bytes per token: %d (expected: 1)\n", packed.size <= 6 * count);
+
+    // A full container leaves the lexer after the last token added.
+    lexer = lxl_lexer_preset(sample->language, sample->source, NULL);
+    packed = lxl_packed_tokens_new(sample->source, data, sizeof data, skips, 2, SKIP_INTERVAL);
+    size_t first_count = lxl_packed_tokens_push_lexer(&packed, &lexer);
+    printf("Tokens pushed to a full container: %zu (expected: %d)\n", first_count, 2 * SKIP_INTERVAL);
+    struct lxl_token next = lxl_lexer_next_token(&lexer);
+    printf("Next token after a full container: %d (expected: 1)\n", same_token(next, tokens[first_count]));
+}
@@ -0,0 +1,98 @@
+#define LEXEL_IMPLEMENTATION
+#include "../lexel.h"
+
+#include <stdio.h>
+
+#define MAX_TOKENS 512
+
+struct sample {
+    enum lxl_language language;
+    const char *source;
+};
+
+static const struct sample samples[] = {
+    {LXL_LANG_C, "int main(void) {\n    return x->y[0] + 1.5e3f - 'c' + 0x1Fu; // comment\n}\n"
+                 "/* block */ s = \"a\\\"b\" \"unclosed\n/* unclosed"},
+    {LXL_LANG_C, "a = 3. + 3.x - 0x; b = .5 + 1e + 1e+ + 0x1p3 + 3.e2;"},
+    {LXL_LANG_JSON, "{\"a\": [1, -2.5e-3, true, null], \"b\": \"\\u00e9\", \"c\": -}"},
+    {LXL_LANG_SQL, "SELECT 'it''s', \"Quoted\nName\" FROM t -- comment\nWHERE x <> 1.5 /* c */;"},
+    {LXL_LANG_INI, "[section]\nkey = \"value\" ; comment\nn = 0x1F_FF\nm = 1_000.5\nx = 0b\n"},
+    {LXL_LANG_SHELL, "if [ \"$x\" ]; then echo 'a' >> f 2>&1 || cat <<-EOF; fi # comment\n`cmd"},
+};
+
+#define SAMPLE_COUNT (sizeof samples / sizeof samples[0])
+
+static char padded[1024 + LXL_INPUT_PADDING];
+static struct lxl_token tokens[MAX_TOKENS];
+
+// Lex at most MAX_TOKENS tokens into `tokens` (including the end token) and return the number of tokens.
+static size_t lex_all(struct lxl_lexer *lexer) {
+    size_t count = 0;
+    while (count < MAX_TOKENS) {
+        struct lxl_token token = lxl_lexer_next_token(lexer);
+        tokens[count++] = token;
+        if (LXL_TOKEN_IS_END(token)) break;
+    }
+    return count;
+}
+
+// Return whether lexing the first `length` bytes of the sample gives the same tokens with and without
+// padding.
+static bool padding_matches(const struct sample *sample, size_t length) {
+    struct lxl_lexer lexer = lxl_lexer_preset(sample->language, sample->source, sample->source + length);
+    size_t count = lex_all(&lexer);
+    if (count == MAX_TOKENS) return false;  // The lexer did not make progress.
+    memcpy(padded, sample->source, length);
+    memset(padded + length, '\0', LXL_INPUT_PADDING);
+    lexer = lxl_lexer_preset(sample->language, padded, padded + length);
+    lexer.padded_input = true;
+    for (size_t i = 0; i < count; ++i) {
+        struct lxl_token token = lxl_lexer_next_token(&lexer);
+        if (token.start - padded != tokens[i].start - sample->source
+            || token.end - padded != tokens[i].end - sample->source
+            || token.token_type != tokens[i].token_type
+            || token.loc.line != tokens[i].loc.line || token.loc.column != tokens[i].loc.column) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Return the text of token `i` as a string in a static buffer.
+static const char *token_text(size_t i) {
+    static char text[64];
+    snprintf(text, sizeof text, "%.*s", (int)(tokens[i].end - tokens[i].start), tokens[i].start);
+    return text;
+}
+
+int main(void) {
+    // Every prefix of each sample, so that every construct is cut off at every point.
+    int mismatches = 0;
+    for (size_t i = 0; i < SAMPLE_COUNT; ++i) {
+        size_t length = strlen(samples[i].source);
+        for (size_t j = 0; j <= length; ++j) {
+            if (!padding_matches(&samples[i], j)) ++mismatches;
+        }
+    }
+    printf("Prefixes lexed differently with padding: %d (expected: 0)\n", mismatches);
+
+    // A float with no digits after the point ends at the point without stalling the lexer.
+    struct lxl_lexer lexer = lxl_lexer_preset(LXL_LANG_C, "3.x", NULL);
+    size_t count = lex_all(&lexer);
+    printf("Tokens in \"3.x\": %zu (expected: 3)\n", count);
+    printf("First token: '%s' %d (expected: '3.' %d)\n", token_text(0), tokens[0].token_type,
+           LXL_PRESET_FLOAT);
+    printf("Second token: '%s' (expected: 'x')\n", token_text(1));
+
+    // An integer with a prefix but no digits keeps its prefix.
+    lexer = lxl_lexer_preset(LXL_LANG_C, "0x;", NULL);
+    count = lex_all(&lexer);
+    printf("Tokens in \"0x;\": %zu (expected: 3)\n", count);
+    printf("First token: '%s' %d (expected: '0x' %d)\n", token_text(0), tokens[0].token_type,
+           LXL_LERR_INVALID_INTEGER);
+
+    // A lexer made from a padded configuration is not padded.
+    lexer = lxl_lexer_new_padded(padded, padded);
+    struct lxl_lexer from_config = lxl_lexer_from_config(&lexer, "x", NULL);
+    printf("Padded input inherited: %d (expected: 0)\n", from_config.padded_input);
+}
@@ -0,0 +1,203 @@
+#define LEXEL_IMPLEMENTATION
+#include "../lexel.h"
+
+#include <stdio.h>
+
+// A conformance corpus for the presets: a sample of each language with its expected tokens, written as
+// kind:value, where the kind is W (word), I (int), F (float), S (string), C (char), Q (quoted name),
+// P (punct), K (keyword), E (error) or LF (line ending, without a value).
+struct sample {
+    enum lxl_language language;
+    const char *name;
+    const char *source;
+    const char *expected;
+};
+
+static const struct sample corpus[] = {
+    {
+        LXL_LANG_C, "C",
+        "#include <stdio.h>\n"
+        "static int f(const char *s, unsigned long n) { /* block */\n"
+        "    return s[0] == '\\'' ? x->y >>= 0x1Fu : n + 1.5e3f - 07 + 1e5; // line\n"
+        "}\n"
+        "char *t = \"a\\\"b\"; int u = 10UL, v = 0b101; a...b;\n",
+        "P:# W:include P:< W:stdio P:. W:h P:> K:static K:int W:f P:( K:const K:char P:* W:s P:, K:unsigned "
+        "K:long W:n P:) P:{ K:return W:s P:[ I:0 P:] P:== C:'\\'' P:? W:x P:-> W:y P:>>= I:0x1Fu P:: W:n "
+        "P:+ F:1.5e3f P:- I:07 P:+ F:1e5 P:; P:} K:char P:* W:t P:= S:\"a\\\"b\" P:; K:int W:u P:= I:10UL "
+        "P:, W:v P:= I:0b101 P:; W:a P:... W:b P:;",
+    },
+    {
+        LXL_LANG_JSON, "JSON",
+        "{\"a\": [1, -2.5e-3, 1e5, true, null], \"b\\\"\": {}, \"c\": false}\n",
+        "P:{ S:\"a\" P:: P:[ I:1 P:, F:-2.5e-3 P:, F:1e5 P:, K:true P:, K:null P:] P:, S:\"b\\\"\" P:: P:{ "
+        "P:} P:, S:\"c\" P:: K:false P:}",
+    },
+    {
+        LXL_LANG_SQL, "SQL",
+        "SELECT a.b, \"Quoted\", 'it''s' FROM t -- comment\n"
+        "WHERE x <> 1.5 AND y::int >= :p; /* block */ select count(*) from t;\n",
+        "K:SELECT W:a P:. W:b P:, Q:\"Quoted\" P:, S:'it' S:'s' K:FROM W:t K:WHERE W:x P:<> F:1.5 K:AND W:y "
+        "P::: W:int P:>= P:: W:p P:; K:select W:count P:( P:* P:) K:from W:t P:;",
+    },
+    {
+        LXL_LANG_INI, "INI",
+        "# comment\n"
+        "[server]\n"
+        "host = \"example.com\" ; trailing\n"
+        "port = 8_080\n"
+        "mask = 0xFF\n"
+        "ratio = -0.5e2\n"
+        "enabled = true\n",
+        "LF P:[ W:server P:] LF W:host P:= S:\"example.com\" LF W:port P:= I:8_080 LF W:mask P:= I:0xFF LF "
+        "W:ratio P:= F:-0.5e2 LF W:enabled P:= K:true LF",
+    },
+    {
+        LXL_LANG_SHELL, "Shell",
+        "if [ -f \"$f\" ]; then\n"
+        "    cat x 2>&1 | grep 'y z' && echo `date`; fi # comment\n"
+        "case $x in a) ;; esac\n",
+        "K:if W:[ W:-f S:\"$f\" W:] P:; K:then LF W:cat W:x W:2 P:>& W:1 P:| W:grep S:'y z' P:&& W:echo "
+        "S:`date` P:; K:fi LF K:case W:$x K:in W:a P:) P:;; K:esac LF",
+    },
+    // Edge cases.
+    {
+        LXL_LANG_C, "C numbers",
+        "0x 0xg 1e 1e+x 7e+2x 10e5f 1.e5 .5 3. 0b2 08 1.5L 1u 0x1p3 1.2.3\n",
+        "E:0x E:0x W:g I:1 W:e I:1 W:e P:+ W:x F:7e+2 W:x F:10e5f F:1.e5 P:. I:5 F:3. E:0b I:2 I:08 "
+        "F:1.5L I:1u I:0x1 W:p3 F:1.2 P:. I:3",
+    },
+    {
+        LXL_LANG_C, "C escapes and unclosed literals",
+        "'\\\\' \"\\\\\\\"\" '' x = \"abc\ny = 'c\nz = \"a\\\\\" w /* open",
+        "C:'\\\\' S:\"\\\\\\\"\" C:'' W:x P:= E:\"abc\n W:y P:= E:'c\n W:z P:= S:\"a\\\\\" W:w E:",
+    },
+    {
+        LXL_LANG_JSON, "JSON edge cases",
+        "[-1, 1., 1E5, 0.0e-0, \"\\\\\", \"\\u00e9\", \"unclosed]",
+        "P:[ I:-1 P:, F:1. P:, I:1 W:E5 P:, F:0.0e-0 P:, S:\"\\\\\" P:, S:\"\\u00e9\" P:, "
+        "E:\"unclosed]",
+    },
+    {
+        LXL_LANG_SQL, "SQL unclosed literals",
+        "SELECT 'abc\ndef' FROM \"Name",
+        "K:SELECT S:'abc\ndef' K:FROM E:\"Name",
+    },
+    {
+        LXL_LANG_INI, "INI edge cases",
+        "a = +1_0\nb = 0o17\nc = 0b\nd = -0x1F\ne = 1e5\nf = \"unclosed\ng = 'x'\n",
+        "W:a P:= I:+1_0 LF W:b P:= I:0o17 LF W:c P:= E:0b LF W:d P:= I:-0x1F LF W:e P:= F:1e5 LF "
+        "W:f P:= E:\"unclosed\n W:g P:= S:'x' LF",
+    },
+    {
+        LXL_LANG_SHELL, "Shell unclosed literals",
+        "echo \"a\\\"b\" x#y 12\necho 'unclosed\nfoo",
+        "W:echo S:\"a\\\"b\" W:x LF W:echo E:'unclosed\nfoo",
+    },
+};
+
+#define SAMPLE_COUNT (sizeof corpus / sizeof corpus[0])
+
+// Append a description of the token to `out` (as in the corpus), separated by a space.
+static void describe(struct lxl_token token, char *out) {
+    const char *kind = "W";
+    if (LXL_TOKEN_IS_ERROR(token)) kind = "E";
+    else if (token.token_type == LXL_TOKEN_LINE_ENDING) kind = "LF";
+    else if (token.token_type >= LXL_PRESET_KEYWORD) kind = "K";
+    else if (token.token_type >= LXL_PRESET_PUNCT) kind = "P";
+    else if (token.token_type == LXL_PRESET_INT) kind = "I";
+    else if (token.token_type == LXL_PRESET_FLOAT) kind = "F";
+    else if (token.token_type == LXL_PRESET_STRING) kind = "S";
+    else if (token.token_type == LXL_PRESET_CHAR) kind = "C";
+    else if (token.token_type == LXL_PRESET_QUOTED_NAME) kind = "Q";
+    size_t length = strlen(out);
+    if (length > 0) out[length++] = ' ';
+    if (token.token_type == LXL_TOKEN_LINE_ENDING) {
+        strcpy(out + length, kind);
+    }
+    else {
+        sprintf(out + length, "%s:%.*s", kind, (int)(token.end - token.start), token.start);
+    }
+}
+
+// Return whether two token streams are identical.
+static bool same_tokens(struct lxl_lexer *a, struct lxl_lexer *b) {
+    for (;;) {
+        struct lxl_token token_a = lxl_lexer_next_token(a);
+        struct lxl_token token_b = lxl_lexer_next_token(b);
+        if (token_a.start != token_b.start || token_a.end != token_b.end
+            || token_a.token_type != token_b.token_type) {
+            return false;
+        }
+        if (LXL_TOKEN_IS_END(token_a)) return true;
+    }
+}
+
+int main(void) {
+    static char listing[4096];
+    int index_matches = 0;
+    int index_differences = 0;
+    for (size_t i = 0; i < SAMPLE_COUNT; ++i) {
+        const struct sample *sample = &corpus[i];
+        struct lxl_lexer lexer = lxl_lexer_preset(sample->language, sample->source, NULL);
+        listing[0] = '\0';
+        for (;;) {
+            struct lxl_token token = lxl_lexer_next_token(&lexer);
+            if (LXL_TOKEN_IS_END(token)) break;
+            describe(token, listing);
+        }
+        bool matches = strcmp(listing, sample->expected) == 0;
+        printf("%s tokens match the corpus: %d (expected: 1)\n", sample->name, matches);
+        if (!matches) printf("    Tokens: %s\n", listing);
+
+        // The static rule index should be exactly what would be built at runtime.
+        struct lxl_lexer config = lxl_lexer_preset(sample->language, "", NULL);
+        struct lxl_rule_index index;
+        if (lxl_rule_index_init(&index, &config) && memcmp(&index, config.rule_index, sizeof index) == 0) {
+            ++index_matches;
+        }
+        // The index should not change the tokens lexed.
+        struct lxl_lexer indexed = lxl_lexer_preset(sample->language, sample->source, NULL);
+        struct lxl_lexer unindexed = lxl_lexer_preset(sample->language, sample->source, NULL);
+        unindexed.rule_index = NULL;
+        if (!same_tokens(&indexed, &unindexed)) ++index_differences;
+    }
+    printf("Static rule indexes matching lxl_rule_index_init(): %d (expected: %d)\n",
+           index_matches, (int)SAMPLE_COUNT);
+    printf("Samples lexed differently without the rule index: %d (expected: 0)\n", index_differences);
+
+    // Every punct and keyword of every preset is lexed as a single token of its own type.
+    int rule_count = 0;
+    int rule_mismatches = 0;
+    for (int language = LXL_LANG_C; language <= LXL_LANG_SHELL; ++language) {
+        struct lxl_lexer config = lxl_lexer_preset(language, "", NULL);
+        const char *const *lists[] = {config.puncts, config.keywords};
+        const int *types[] = {config.punct_types, config.keyword_types};
+        for (int list = 0; list < 2; ++list) {
+            for (int i = 0; lists[list] != NULL && lists[list][i] != NULL; ++i) {
+                char source[64];
+                snprintf(source, sizeof source, "%s x", lists[list][i]);
+                struct lxl_lexer lexer = lxl_lexer_preset(language, source, NULL);
+                struct lxl_token token = lxl_lexer_next_token(&lexer);
+                ++rule_count;
+                if (token.token_type != types[list][i] || token.start != source
+                    || (size_t)(token.end - token.start) != strlen(lists[list][i])) {
+                    ++rule_mismatches;
+                }
+            }
+        }
+    }
+    printf("Puncts and keywords: %d (expected: 292)\n", rule_count);
+    printf("Puncts and keywords not lexed as themselves: %d (expected: 0)\n", rule_mismatches);
+
+    // Without `.extended_floats`, exponents need a radix separator and float suffixes are not matched.
+    struct lxl_lexer lexer = lxl_lexer_preset(LXL_LANG_C, "1e5 7e+2x 10e5f 1.5f 1.5e3", NULL);
+    lexer.extended_floats = false;
+    listing[0] = '\0';
+    for (;;) {
+        struct lxl_token token = lxl_lexer_next_token(&lexer);
+        if (LXL_TOKEN_IS_END(token)) break;
+        describe(token, listing);
+    }
+    printf("Tokens without extended floats: %s (expected: I:1 W:e5 I:7 W:e P:+ I:2 W:x I:10 W:e5f F:1.5 W:f "
+           "F:1.5e3)\n", listing);
+}
@@ -0,0 +1,39 @@
+// Random inputs for the tests which compare lexing paths on many random sources. Each test includes this
+// after lexel.h, so that it still builds on its own.
+#ifndef TEST_RANDOM_H
+#define TEST_RANDOM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+// The state of the generator. Tests may set it to repeat a sequence.
+static unsigned random_state = 1;
+
+// Return a pseudo-random number from 0 to 32767. This is the C standard's example `rand()`, so every platform
+// gives the same inputs.
+static inline unsigned next_random(void) {
+    random_state = random_state * 1103515245 + 12345;
+    return (random_state >> 16) & 0x7fff;
+}
+
+// Fill `source` (of `capacity` bytes) with fewer than `max_count` pieces chosen at random from `pieces`,
+// mostly without spaces between them, and NUL-terminate it. An empty piece stands for a NUL byte, which is
+// only written if `with_nul` is set. Return the size of the source.
+static inline size_t build_random_source(char *source, size_t capacity, const char *const *pieces,
+                                         size_t piece_count, size_t max_count, bool with_nul) {
+    size_t size = 0;
+    size_t count = next_random() % max_count;
+    for (size_t i = 0; i < count; ++i) {
+        const char *piece = pieces[next_random() % piece_count];
+        size_t length = (piece[0] == '\0') ? 1 : strlen(piece);
+        if (piece[0] == '\0' && !with_nul) continue;
+        if (size + length >= capacity) break;
+        memcpy(&source[size], piece, length);
+        size += length;
+    }
+    source[size] = '\0';
+    return size;
+}
+
+#endif  // TEST_RANDOM_H
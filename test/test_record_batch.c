@@ -0,0 +1,233 @@
+#define LEXEL_IMPLEMENTATION
+#include "../lexel.h"
+#include "test_random.h"
+
+#include <stdio.h>
+
+#define MAX_TOKENS 4096
+#define MAX_RECORDS 512
+
+// A Python-like language using the offside rule, so that records may have more tokens than bytes.
+static const char *const line_comments[] = {"#", NULL};
+static const char *const puncts[] = {":", "(", ")", ",", "=", NULL};
+static const int punct_types[] = {1, 2, 3, 4, 5};
+static const char *const keywords[] = {"if", "pass", NULL};
+static const int keyword_types[] = {6, 7};
+static const struct lxl_delim_pair strings[] = {{"\"", "\""}, {NULL, NULL}};
+static const int string_types[] = {8};
+static const char *const integer_prefixes[] = {"0x", NULL};
+static const int integer_bases[] = {16};
+static const struct lxl_delim_pair brackets[] = {{"(", ")"}, {NULL, NULL}};
+static int indent_stack[16];
+
+static const char *const pieces[] = {
+    "x", "if", "pass", "1", "2.5", "0x1F", "(", ")", ",", "=", ":", " ", "  ", "\"s\"", "\"unclosed",
+    "# c", "\t", "\\", "@",
+};
+#define PIECE_COUNT (sizeof pieces / sizeof pieces[0])
+
+static char source[1 << 16];
+static size_t lengths[MAX_RECORDS];
+static struct lxl_token reference[MAX_TOKENS];
+static struct lxl_record_range reference_records[MAX_RECORDS];
+static struct lxl_token tokens[MAX_TOKENS];
+static struct lxl_record_range records[MAX_RECORDS];
+static int hook_calls;
+
+static void count_hook_call(struct lxl_lexer *lexer, struct lxl_token *token) {
+    (void)lexer;
+    (void)token;
+    ++hook_calls;
+}
+
+static struct lxl_lexer new_config(bool offside_rule) {
+    struct lxl_lexer lexer = lxl_lexer_new("", NULL);
+    lexer.line_comment_openers = line_comments;
+    lexer.line_string_delims = strings;
+    lexer.line_string_types = string_types;
+    lexer.string_escape_chars = "\\";
+    lexer.default_int_base = 10;
+    lexer.default_int_type = 9;
+    lexer.default_float_base = 10;
+    lexer.default_float_type = 10;
+    lexer.integer_prefixes = integer_prefixes;
+    lexer.integer_bases = integer_bases;
+    lexer.puncts = puncts;
+    lexer.punct_types = punct_types;
+    lexer.keywords = keywords;
+    lexer.keyword_types = keyword_types;
+    lexer.default_word_type = 0;
+    lexer.word_lexing_rule = LXL_LEX_WORD;
+    lexer.bracket_delims = brackets;
+    lexer.offside_rule = offside_rule;
+    lexer.indent_stack = indent_stack;
+    lexer.indent_capacity = sizeof indent_stack / sizeof indent_stack[0];
+    return lexer;
+}
+
+// Fill `source` with `record_count` random records (some of them long and some empty), separated by line
+// feeds, and set `lengths`. Return the size of the source.
+static size_t build_source(size_t record_count) {
+    size_t size = 0;
+    for (size_t i = 0; i < record_count; ++i) {
+        size_t start = size;
+        size_t piece_count = next_random() % 8 == 0 ? next_random() % 60 : next_random() % 6;
+        if (next_random() % 3 == 0) source[size++] = ' ';  // Indented, for the offside rule.
+        for (size_t j = 0; j < piece_count; ++j) {
+            const char *piece = pieces[next_random() % PIECE_COUNT];
+            size_t length = strlen(piece);
+            memcpy(&source[size], piece, length);
+            size += length;
+        }
+        lengths[i] = size - start;
+        source[size++] = '\n';
+    }
+    source[size] = '\0';
+    return size;
+}
+
+// Lex each record separately into `reference` as `lxl_lexer_from_config()` and `lxl_lexer_next_token()`
+// would, keeping at most `token_capacity` tokens of each. Records are `separator_length` bytes apart.
+static void lex_reference(const struct lxl_lexer *config, size_t record_count, size_t token_capacity,
+                          size_t separator_length) {
+    const char *record = source;
+    size_t count = 0;
+    hook_calls = 0;
+    for (size_t i = 0; i < record_count; ++i) {
+        struct lxl_lexer lexer = lxl_lexer_from_config(config, record, record + lengths[i]);
+        static int reference_indent_stack[16];
+        lexer.indent_stack = reference_indent_stack;
+        lexer.indent_capacity = config->indent_capacity;
+        reference_records[i] = (struct lxl_record_range) {count, count, false};
+        size_t record_tokens = 0;
+        for (;;) {
+            if (record_tokens == token_capacity) {
+                // Stop before lexing a token which is not stored, as the batch does.
+                struct lxl_lexer rest = lexer;
+                rest.after_token_hook = NULL;
+                struct lxl_token token = lxl_lexer_next_token(&rest);
+                if (LXL_TOKEN_IS_END(token)) {
+                    lxl_lexer_next_token(&lexer);
+                }
+                else {
+                    reference_records[i].truncated = true;
+                }
+                break;
+            }
+            struct lxl_token token = lxl_lexer_next_token(&lexer);
+            if (LXL_TOKEN_IS_END(token)) break;
+            reference[count++] = token;
+            ++record_tokens;
+        }
+        reference_records[i].end = count;
+        record += lengths[i] + separator_length;
+    }
+}
+
+// Return whether the records `records[0..count)` hold the same tokens as the reference records from
+// `first_record`.
+static bool records_match(size_t first_record, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        struct lxl_record_range expected = reference_records[first_record + i];
+        struct lxl_record_range got = records[i];
+        if (got.end - got.begin != expected.end - expected.begin || got.truncated != expected.truncated) {
+            return false;
+        }
+        for (size_t j = 0; j < got.end - got.begin; ++j) {
+            struct lxl_token a = tokens[got.begin + j];
+            struct lxl_token b = reference[expected.begin + j];
+            if (a.start != b.start || a.end != b.end || a.token_type != b.token_type
+                || a.loc.line != b.loc.line || a.loc.column != b.loc.column) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Lex all the records in batches of the given capacities, emptying the batch whenever lexing stops, and
+// return whether the tokens, ranges and hook calls match the reference.
+static bool batches_match(const struct lxl_lexer *config, size_t record_count, size_t size,
+                          size_t token_capacity, size_t record_capacity, bool by_lengths) {
+    lex_reference(config, record_count, token_capacity, by_lengths ? 0 : 1);
+    int reference_hook_calls = hook_calls;
+    hook_calls = 0;
+    struct lxl_record_batch batch = {
+        .tokens = tokens, .token_capacity = token_capacity,
+        .records = records, .record_capacity = record_capacity,
+    };
+    const char *start = source;
+    const char *end = source + size;
+    size_t record_index = 0;
+    for (int calls = 0; record_index < record_count; ++calls) {
+        if (calls > 10000) return false;  // No progress.
+        batch.token_count = 0;
+        batch.record_count = 0;
+        if (by_lengths) {
+            size_t lexed = lxl_lexer_tokenize_records(config, start, &lengths[record_index],
+                                                      record_count - record_index, &batch);
+            for (size_t i = 0; i < lexed; ++i) start += lengths[record_index + i];
+        }
+        else {
+            start = lxl_lexer_tokenize_lines(config, start, end, &batch);
+        }
+        if (!records_match(record_index, batch.record_count)) return false;
+        record_index += batch.record_count;
+    }
+    return hook_calls == reference_hook_calls;
+}
+
+int main(void) {
+    static const size_t token_capacities[] = {0, 1, 3, 16, 100, MAX_TOKENS};
+    static const size_t record_capacities[] = {1, 7, MAX_RECORDS};
+    int runs = 0;
+    int matches = 0;
+    for (int offside_rule = 0; offside_rule < 2; ++offside_rule) {
+        for (int with_hook = 0; with_hook < 2; ++with_hook) {
+            struct lxl_lexer config = new_config(offside_rule);
+            if (with_hook) config.after_token_hook = count_hook_call;
+            for (int by_lengths = 0; by_lengths < 2; ++by_lengths) {
+                for (size_t i = 0; i < sizeof token_capacities / sizeof token_capacities[0]; ++i) {
+                    for (size_t j = 0; j < sizeof record_capacities / sizeof record_capacities[0]; ++j) {
+                        random_state = (unsigned)(i + 1);
+                        size_t record_count = 200;
+                        size_t size = build_source(record_count);
+                        if (by_lengths) {
+                            // Records stored one after another, without line feeds.
+                            size_t from = 0;
+                            size = 0;
+                            for (size_t r = 0; r < record_count; ++r) {
+                                memmove(&source[size], &source[from], lengths[r]);
+                                size += lengths[r];
+                                from += lengths[r] + 1;
+                            }
+                        }
+                        ++runs;
+                        if (batches_match(&config, record_count, size, token_capacities[i],
+                                          record_capacities[j], by_lengths)) {
+                            ++matches;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    printf("Batched runs matching lxl_lexer_next_token(): %d (expected: %d)\n", matches, runs);
+
+    // A record which can never fit is cut off in an empty batch, and left for the next batch otherwise.
+    struct lxl_lexer config = new_config(false);
+    struct lxl_record_batch batch = {
+        .tokens = tokens, .token_capacity = 4, .records = records, .record_capacity = MAX_RECORDS,
+    };
+    const char *input = "a\nb c d e f g\nh";
+    const char *input_end = input + strlen(input);
+    const char *rest = lxl_lexer_tokenize_lines(&config, input, input_end, &batch);
+    printf("Records stored: %zu (expected: 1)\n", batch.record_count);
+    printf("Resume offset: %d (expected: 2)\n", (int)(rest - input));
+    batch.token_count = 0;
+    batch.record_count = 0;
+    rest = lxl_lexer_tokenize_lines(&config, rest, input_end, &batch);
+    printf("Tokens of the long record: %zu (expected: 4)\n", batch.token_count);
+    printf("Long record truncated: %d (expected: 1)\n", records[0].truncated);
+    printf("Resume offset: %d (expected: 14)\n", (int)(rest - input));
+}
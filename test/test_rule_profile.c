@@ -0,0 +1,142 @@
+#define LEXEL_IMPLEMENTATION
+#include "../lexel.h"
+#include "test_random.h"
+
+#include <stdio.h>
+
+#define MAX_SOURCE 1024
+
+// Puncts where one is a prefix of another, in either order ("=" hides "=="), and a duplicate keyword.
+static const char *const puncts[] = {
+    "<<=", "<<", "<=", "<", "=", "==", "=>", "!", "!=", "+", "++", "+=", NULL,
+};
+static const int punct_types[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+static const char *const keywords[] = {"if", "in", "int", "if", "while", NULL};
+static const int keyword_types[] = {13, 14, 15, 16, 17};
+#define PUNCT_COUNT 12
+#define KEYWORD_COUNT 5
+
+static const char *const pieces[] = {
+    "<<=", "<<", "<=", "<", "=", "==", "=>", "!", "!=", "+", "++", "+=", "if", "in", "int", "while", "x", "1",
+    " ", " ", "ifx", "\n",
+};
+#define PIECE_COUNT (sizeof pieces / sizeof pieces[0])
+
+static char source[MAX_SOURCE];
+static char region_buffer[1 << 16];
+
+static struct lxl_lexer new_lexer(bool c_preset) {
+    if (c_preset) return lxl_lexer_preset(LXL_LANG_C, source, NULL);
+    struct lxl_lexer lexer = lxl_lexer_new(source, NULL);
+    lexer.puncts = puncts;
+    lexer.punct_types = punct_types;
+    lexer.keywords = keywords;
+    lexer.keyword_types = keyword_types;
+    lexer.default_int_base = 10;
+    lexer.default_int_type = 18;
+    lexer.default_word_type = 0;
+    lexer.word_lexing_rule = LXL_LEX_WORD;
+    return lexer;
+}
+
+// Return whether lexing with a profile re-ordering every `interval` tokens gives the same tokens as without.
+static bool profile_matches(bool c_preset, uint32_t interval) {
+    struct lxl_lexer plain = new_lexer(c_preset);
+    struct lxl_lexer profiled = new_lexer(c_preset);
+    struct lxl_region region = REGION_FROM_ARRAY(region_buffer);
+    struct lxl_rule_profile profile;
+    if (!lxl_rule_profile_init(&profile, &profiled, interval, &region)) return false;
+    for (;;) {
+        struct lxl_token a = lxl_lexer_next_token(&plain);
+        struct lxl_token b = lxl_lexer_next_token(&profiled);
+        if (a.start != b.start || a.end != b.end || a.token_type != b.token_type) return false;
+        if (LXL_TOKEN_IS_END(a)) return true;
+    }
+}
+
+// Return the punct tried at `position` among those starting with `c`.
+static const char *tried_punct(const struct lxl_rule_profile *profile, unsigned char c, int position) {
+    return puncts[profile->punct_order[profile->punct_groups[c] + position]];
+}
+
+int main(void) {
+    // Re-ordering at any interval, including every token, does not change the tokens.
+    static const uint32_t intervals[] = {0, 1, 3, 64};
+    int runs = 0;
+    int matches = 0;
+    for (int c_preset = 0; c_preset < 2; ++c_preset) {
+        for (size_t i = 0; i < sizeof intervals / sizeof intervals[0]; ++i) {
+            for (int sample = 0; sample < 300; ++sample) {
+                build_random_source(source, MAX_SOURCE, pieces, PIECE_COUNT, 100, false);
+                ++runs;
+                matches += profile_matches(c_preset, intervals[i]);
+            }
+        }
+    }
+    printf("Random samples lexed as without the profile: %d (expected: %d)\n", matches, runs);
+
+    // Frequent puncts move to the front of their group, but never past a punct they overlap.
+    strcpy(source, "a <= b <= c <= d << e");
+    struct lxl_lexer lexer = new_lexer(false);
+    struct lxl_region region = REGION_FROM_ARRAY(region_buffer);
+    struct lxl_rule_profile profile;
+    lxl_rule_profile_init(&profile, &lexer, 0, &region);
+    printf("Profile size: %zu (expected: %d)\n", lxl_rule_profile_size(&profile),
+           PUNCT_COUNT + KEYWORD_COUNT);
+    printf("First '<' punct tried before training: %s (expected: <<=)\n", tried_punct(&profile, '<', 0));
+    for (;;) {
+        struct lxl_token token = lxl_lexer_next_token(&lexer);
+        if (LXL_TOKEN_IS_END(token)) break;
+    }
+    printf("Hits of <= and <<: %u and %u (expected: 3 and 1)\n",
+           profile.punct_hits[2], profile.punct_hits[1]);
+    lxl_rule_profile_reorder(&profile);
+    printf("'<' puncts tried after training: %s %s %s %s (expected: <= <<= << <)\n",
+           tried_punct(&profile, '<', 0), tried_punct(&profile, '<', 1), tried_punct(&profile, '<', 2),
+           tried_punct(&profile, '<', 3));
+    printf("Hits of <= after ageing: %u (expected: 1)\n", profile.punct_hits[2]);
+
+    // Exported counts give the same order in a new profile; counts of the wrong size are rejected.
+    uint32_t counts[PUNCT_COUNT + KEYWORD_COUNT];
+    profile.punct_hits[2] = 5;
+    lxl_rule_profile_export(&profile, counts);
+    struct lxl_lexer imported_lexer = new_lexer(false);
+    struct lxl_rule_profile imported;
+    lxl_rule_profile_init(&imported, &imported_lexer, 0, &region);
+    printf("Import of the wrong size: %d (expected: 0)\n", lxl_rule_profile_import(&imported, counts, 3));
+    printf("First '<' punct tried after the failed import: %s (expected: <<=)\n",
+           tried_punct(&imported, '<', 0));
+    printf("Import: %d (expected: 1)\n",
+           lxl_rule_profile_import(&imported, counts, PUNCT_COUNT + KEYWORD_COUNT));
+    printf("First '<' punct tried after the import: %s (expected: <=)\n", tried_punct(&imported, '<', 0));
+
+    // A duplicate keyword stays behind the first, however often it is counted.
+    memset(counts, 0, sizeof counts);
+    counts[PUNCT_COUNT + 3] = 1000;
+    lxl_rule_profile_import(&imported, counts, PUNCT_COUNT + KEYWORD_COUNT);
+    strcpy(source, "if");
+    imported_lexer = new_lexer(false);
+    imported_lexer.rule_profile = &imported;
+    struct lxl_token token = lxl_lexer_next_token(&imported_lexer);
+    printf("Type of a duplicate keyword: %d (expected: 13)\n", token.token_type);
+
+    // Counting before lexing (as `lxl_lexer_tokenize_exact()` does) does not count hits, and lexers created
+    // from a configuration do not share its profile.
+    strcpy(source, "a <= b <= c <= d << e");
+    lexer = new_lexer(false);
+    region = REGION_FROM_ARRAY(region_buffer);
+    lxl_rule_profile_init(&profile, &lexer, 0, &region);
+    struct lxl_token_columns columns;
+    lxl_lexer_tokenize_exact(&lexer, &columns, false, &region);
+    printf("Hits of <= after tokenizing exactly: %u (expected: 3)\n", profile.punct_hits[2]);
+    struct lxl_lexer from_config = lxl_lexer_from_config(&lexer, source, NULL);
+    printf("Profile of a lexer from the configuration: %d (expected: 0)\n", from_config.rule_profile != NULL);
+
+    // Initialization fails cleanly in a region which is too small.
+    char small_buffer[16];
+    region = REGION_FROM_ARRAY(small_buffer);
+    lexer = new_lexer(false);
+    printf("Profile created in a small region: %d (expected: 0)\n",
+           lxl_rule_profile_init(&profile, &lexer, 0, &region));
+    printf("Profile attached: %d (expected: 0)\n", lexer.rule_profile != NULL);
+}
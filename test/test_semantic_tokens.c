@@ -0,0 +1,124 @@
+#define LEXEL_IMPLEMENTATION
+#include "../lexel.h"
+
+#include <stdio.h>
+
+#define MAX_DATA 1024
+
+struct sample {
+    enum lxl_language language;
+    const char *source;
+};
+
+static const struct sample samples[] = {
+    {LXL_LANG_C, "int main(void) {\n    /* comment\n spanning lines */ return x + 1.5e3;  // comment\n}\n"},
+    {LXL_LANG_C, "s = \"caf\xc3\xa9 \xf0\x9f\x98\x80\" + t; // \xe2\x82\xac\n\xc3\xa9t\xc3\xa9 = 'c';"},
+    {LXL_LANG_SQL, "SELECT 'multi\nline\n\nstring' FROM \"Quoted\nName\" WHERE x = 1;"},
+    {LXL_LANG_C, "x = \"unclosed\n y"},
+    {LXL_LANG_C, ""},
+};
+
+#define SAMPLE_COUNT (sizeof samples / sizeof samples[0])
+
+// Legend indices for the preset token types (puncts are not encoded).
+static int legend_types[LXL_TOKEN_SET_SIZE];
+static uint32_t legend_modifiers[LXL_TOKEN_SET_SIZE];
+
+static uint32_t data[MAX_DATA];
+static uint32_t expected[MAX_DATA];
+
+// Return the UTF-16 column of `point` by scanning its line from the start.
+static uint32_t utf16_column(const char *source, const char *point) {
+    const char *line_start = point;
+    while (line_start > source && line_start[-1] != '\n') --line_start;
+    uint32_t column = 0;
+    for (const unsigned char *p = (const unsigned char *)line_start; p < (const unsigned char *)point; ++p) {
+        if ((*p & 0xc0) != 0x80) column += (*p >= 0xf0) ? 2 : 1;
+    }
+    return column;
+}
+
+// Return the line of `point`.
+static uint32_t line_of(const char *source, const char *point) {
+    uint32_t line = 0;
+    for (const char *p = source; p < point; ++p) {
+        if (*p == '\n') ++line;
+    }
+    return line;
+}
+
+// Encode the sample's tokens by computing the absolute position of each line of each token, and return
+// the number of elements written to `expected`.
+static size_t encode_naively(const struct sample *sample) {
+    struct lxl_lexer lexer = lxl_lexer_preset(sample->language, sample->source, NULL);
+    size_t size = 0;
+    uint32_t prev_line = 0;
+    uint32_t prev_column = 0;
+    for (;;) {
+        struct lxl_token token = lxl_lexer_next_token(&lexer);
+        if (LXL_TOKEN_IS_END(token)) break;
+        if (token.token_type < 0 || legend_types[token.token_type] < 0) continue;
+        const char *piece = token.start;
+        while (piece < token.end) {
+            const char *piece_end = memchr(piece, '\n', token.end - piece);
+            if (piece_end == NULL) piece_end = token.end;
+            uint32_t line = line_of(sample->source, piece);
+            uint32_t column = utf16_column(sample->source, piece);
+            uint32_t length = utf16_column(sample->source, piece_end) - column;
+            if (length > 0) {
+                expected[size++] = line - prev_line;
+                expected[size++] = (line == prev_line) ? column - prev_column : column;
+                expected[size++] = length;
+                expected[size++] = (uint32_t)legend_types[token.token_type];
+                expected[size++] = legend_modifiers[token.token_type];
+                prev_line = line;
+                prev_column = column;
+            }
+            piece = piece_end + 1;
+        }
+    }
+    return size;
+}
+
+int main(void) {
+    for (int i = 0; i < LXL_TOKEN_SET_SIZE; ++i) {
+        legend_types[i] = (i >= LXL_PRESET_KEYWORD) ? 3 : (i >= LXL_PRESET_PUNCT) ? -1 : i % 3;
+        legend_modifiers[i] = (i == LXL_PRESET_STRING) ? 1 : 0;
+    }
+
+    int matches = 0;
+    for (size_t i = 0; i < SAMPLE_COUNT; ++i) {
+        struct lxl_lexer lexer = lxl_lexer_preset(samples[i].language, samples[i].source, NULL);
+        struct lxl_semantic_encoder encoder = lxl_semantic_encoder_new(samples[i].source, data, MAX_DATA,
+                                                                       legend_types, LXL_TOKEN_SET_SIZE,
+                                                                       legend_modifiers);
+        lxl_semantic_encoder_encode_lexer(&encoder, &lexer);
+        size_t size = encode_naively(&samples[i]);
+        if (!encoder.overflowed && encoder.size == size && memcmp(data, expected, size * sizeof *data) == 0) {
+            ++matches;
+        }
+    }
+    printf("Samples encoded as by absolute positions: %d (expected: %d)\n", matches, (int)SAMPLE_COUNT);
+
+    // Characters outside the BMP take two UTF-16 code units.
+    struct lxl_lexer lexer = lxl_lexer_preset(LXL_LANG_C, "x = \"\xc3\xa9\xf0\x9f\x98\x80\" y", NULL);
+    struct lxl_semantic_encoder encoder = lxl_semantic_encoder_new(lexer.start, data, MAX_DATA, legend_types,
+                                                                   LXL_TOKEN_SET_SIZE, legend_modifiers);
+    lxl_semantic_encoder_encode_lexer(&encoder, &lexer);
+    printf("String: delta %u, length %u (expected: delta 4, length 5)\n", data[6], data[7]);
+    printf("Word after the string: delta %u (expected: delta 6)\n", data[11]);
+
+    // A multiline string is split into one entry per line.
+    lexer = lxl_lexer_preset(LXL_LANG_SQL, "SELECT 'a\nbc' FROM t", NULL);
+    encoder = lxl_semantic_encoder_new(lexer.start, data, MAX_DATA, legend_types, LXL_TOKEN_SET_SIZE, NULL);
+    lxl_semantic_encoder_encode_lexer(&encoder, &lexer);
+    printf("String lines: %u %u %u, %u %u %u (expected: 0 7 2, 1 0 3)\n",
+           data[5], data[6], data[7], data[10], data[11], data[12]);
+
+    // Encoding fails cleanly when the output is full.
+    lexer = lxl_lexer_preset(LXL_LANG_C, samples[0].source, NULL);
+    encoder = lxl_semantic_encoder_new(lexer.start, data, 7, legend_types, LXL_TOKEN_SET_SIZE, NULL);
+    printf("Elements written to a full output: %zu (expected: 0)\n",
+           lxl_semantic_encoder_encode_lexer(&encoder, &lexer));
+    printf("Elements kept: %zu (expected: 5)\n", encoder.size);
+}
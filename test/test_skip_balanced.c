@@ -0,0 +1,105 @@
+#define LEXEL_IMPLEMENTATION
+#include "../lexel.h"
+
+#include <stdio.h>
+
+#define MAX_TOKENS 1024
+
+// A Python-like language using the offside rule.
+static const char *const puncts[] = {":", "(", ")", ",", NULL};
+static const int punct_types[] = {1, 2, 3, 4};
+static const struct lxl_delim_pair brackets[] = {{"(", ")"}, {NULL, NULL}};
+static int indent_stack[16];
+
+static const char *const c_source =
+    "static int f(const char *s) {\n"
+    "    if (s[0] == '}') { return 1; } /* } { */\n"
+    "    // { unbalanced in a comment\n"
+    "    const char *t = \"}}} {\\\" }\"; { { {\n"
+    "        x = 1.5e3 + 0x1F; /* multi\n line { comment */\n"
+    "    } } }\n"
+    "    return g(\"}\") + '{';\n"
+    "}\n"
+    "int main(void) { { } { { } } return f(\"{\"); }\n"
+    "struct s { int a; char *b; };\n";
+
+static struct lxl_token tokens[MAX_TOKENS];
+
+static bool is_punct(struct lxl_token token, char c) {
+    return token.token_type >= LXL_PRESET_PUNCT && token.end - token.start == 1 && token.start[0] == c;
+}
+
+// Return whether the lexers are at the same position with the same state.
+static bool same_position(const struct lxl_lexer *a, const struct lxl_lexer *b) {
+    return a->current == b->current && a->pos.line == b->pos.line && a->pos.column == b->pos.column
+        && a->bracket_depth == b->bracket_depth && a->indent_depth == b->indent_depth
+        && a->pending_dedents == b->pending_dedents;
+}
+
+int main(void) {
+    struct lxl_lexer lexer = lxl_lexer_preset(LXL_LANG_C, c_source, NULL);
+    size_t count = 0;
+    for (;;) {
+        struct lxl_token token = lxl_lexer_next_token(&lexer);
+        tokens[count++] = token;
+        if (LXL_TOKEN_IS_END(token)) break;
+    }
+
+    // Skip every block and compare with lexing its tokens.
+    int blocks = 0;
+    int mismatches = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (!is_punct(tokens[i], '{')) continue;
+        ++blocks;
+        struct lxl_lexer lexed = lxl_lexer_preset(LXL_LANG_C, c_source, NULL);
+        for (size_t j = 0; j <= i; ++j) lxl_lexer_next_token(&lexed);
+        struct lxl_lexer skipped = lexed;
+        int depth = 1;
+        while (depth > 0) {
+            struct lxl_token token = lxl_lexer_next_token(&lexed);
+            if (is_punct(token, '{')) ++depth;
+            if (is_punct(token, '}')) --depth;
+        }
+        if (!lxl_lexer_skip_balanced(&skipped, "{", "}") || !same_position(&skipped, &lexed)) ++mismatches;
+    }
+    printf("Blocks: %d (expected: 10)\n", blocks);
+    printf("Blocks skipped differently from lexing: %d (expected: 0)\n", mismatches);
+
+    // An unclosed block leaves the lexer unchanged.
+    lexer = lxl_lexer_preset(LXL_LANG_C, "{ a { b } \"}\" /* } */", NULL);
+    lxl_lexer_next_token(&lexer);
+    struct lxl_lexer before = lexer;
+    printf("Unclosed block skipped: %d (expected: 0)\n", lxl_lexer_skip_balanced(&lexer, "{", "}"));
+    printf("Lexer unchanged: %d (expected: 1)\n", same_position(&lexer, &before));
+    lexer = lxl_lexer_preset(LXL_LANG_C, "{ a /* } unclosed", NULL);
+    lxl_lexer_next_token(&lexer);
+    before = lexer;
+    printf("Block ending in an unclosed comment skipped: %d (expected: 0)\n",
+           lxl_lexer_skip_balanced(&lexer, "{", "}"));
+    printf("Lexer unchanged: %d (expected: 1)\n", same_position(&lexer, &before));
+
+    // A failed skip inside indented blocks keeps the indentation state.
+    lexer = lxl_lexer_new("a:\n    b:\n        c (\n", NULL);
+    lexer.puncts = puncts;
+    lexer.punct_types = punct_types;
+    lexer.word_lexing_rule = LXL_LEX_WORD;
+    lexer.bracket_delims = brackets;
+    lexer.offside_rule = true;
+    lexer.indent_stack = indent_stack;
+    lexer.indent_capacity = sizeof indent_stack / sizeof indent_stack[0];
+    struct lxl_token token;
+    do {
+        token = lxl_lexer_next_token(&lexer);
+    } while (token.token_type != 2 && !LXL_TOKEN_IS_END(token));
+    before = lexer;
+    printf("Unclosed offside block skipped: %d (expected: 0)\n", lxl_lexer_skip_balanced(&lexer, "(", ")"));
+    printf("Indent depth: %d (expected: 2)\n", lexer.indent_depth);
+    printf("Lexer unchanged: %d (expected: 1)\n", same_position(&lexer, &before));
+    int dedents = 0;
+    for (;;) {
+        token = lxl_lexer_next_token(&lexer);
+        if (LXL_TOKEN_IS_END(token)) break;
+        if (token.token_type == LXL_TOKEN_DEDENT) ++dedents;
+    }
+    printf("Dedents after the failed skip: %d (expected: 2)\n", dedents);
+}
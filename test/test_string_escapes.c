@@ -0,0 +1,52 @@
+#define LEXEL_IMPLEMENTATION
+#include "../lexel.h"
+
+#include <stdio.h>
+
+enum {
+    T_STRING,
+    T_LONG_STRING,
+    T_WORD,
+};
+
+static const struct lxl_delim_pair line_strings[] = {{"\"", "\""}, {NULL, NULL}};
+static const int line_string_types[] = {T_STRING};
+static const struct lxl_delim_pair multiline_strings[] = {{"'''", "'''"}, {NULL, NULL}};
+static const int multiline_string_types[] = {T_LONG_STRING};
+
+struct sample {
+    const char *source;
+    int length;      // The length of the first token.
+    int token_type;  // The type of the first token.
+};
+
+static const struct sample samples[] = {
+    {"\"a \\\"b\\\"\" x", 9, T_STRING},      // Escaped closers.
+    {"\"\\\"\" x", 4, T_STRING},             // Only an escaped closer.
+    {"\"\\\\\" x", 4, T_STRING},             // An escaped escape before the closer.
+    {"\"\\\\\\\"\" x", 6, T_STRING},         // An escaped escape, then an escaped closer.
+    {"\"a\\\"", 4, LXL_LERR_UNCLOSED_STRING},  // An escaped closer at the end of the input.
+    {"\"a\\", 3, LXL_LERR_UNCLOSED_STRING},    // An escape at the end of the input.
+    {"'''a\\''''' x", 9, T_LONG_STRING},     // An escaped quote does not escape the whole closer.
+    {"'''\\'''' x", 8, T_LONG_STRING},
+};
+
+#define SAMPLE_COUNT (sizeof samples / sizeof samples[0])
+
+int main(void) {
+    int matches = 0;
+    for (size_t i = 0; i < SAMPLE_COUNT; ++i) {
+        struct lxl_lexer lexer = lxl_lexer_new(samples[i].source, NULL);
+        lexer.line_string_delims = line_strings;
+        lexer.line_string_types = line_string_types;
+        lexer.multiline_string_delims = multiline_strings;
+        lexer.multiline_string_types = multiline_string_types;
+        lexer.string_escape_chars = "\\";
+        lexer.default_word_type = T_WORD;
+        struct lxl_token token = lxl_lexer_next_token(&lexer);
+        if (token.end - token.start == samples[i].length && token.token_type == samples[i].token_type) {
+            ++matches;
+        }
+    }
+    printf("Strings lexed to their closer: %d (expected: %d)\n", matches, (int)SAMPLE_COUNT);
+}
@@ -0,0 +1,120 @@
+#define LEXEL_IMPLEMENTATION
+#include "../lexel.h"
+#include "test_random.h"
+
+#include <stdio.h>
+
+#define MAX_SOURCE 4096
+
+// A language with comments, escapes and multiline strings, so that quotes and escapes occur outside strings.
+static const char *const line_comments[] = {"#", NULL};
+static const struct lxl_delim_pair strings[] = {{"'", "'"}, {NULL, NULL}};
+static const int string_types[] = {1};
+static const char *const puncts[] = {",", ":", "{", "}", NULL};
+static const int punct_types[] = {2, 3, 4, 5};
+
+static const char *const json_pieces[] = {
+    "\"", "\"abc\"", "\"a\\\"b\"", "\"\\\\\"", "\\", "\\\"", "\n", " ", "    ", "\t", "x", "1", "-2.5", ",",
+    ":", "{", "}", "\"\\u00e9\"", "\"                                                                    \"",
+    "                                                                       ", "\0",
+};
+static const char *const comment_pieces[] = {
+    "'", "'abc'", "'a\\'b'", "'\\\\'", "\\", "\\'", "\n", " ", "    ", "x", "1", ",", "# it's\n", "#\\",
+    "'line\nline'", "'                                                                    '", "\0",
+};
+
+static char source[MAX_SOURCE];
+static size_t source_size;
+static char region_buffer[1 << 16];
+
+static struct lxl_lexer new_lexer(bool json, const char *end) {
+    if (json) return lxl_lexer_preset(LXL_LANG_JSON, source, end);
+    struct lxl_lexer lexer = lxl_lexer_new(source, end);
+    lexer.line_comment_openers = line_comments;
+    lexer.multiline_string_delims = strings;
+    lexer.multiline_string_types = string_types;
+    lexer.string_escape_chars = "\\";
+    lexer.default_int_base = 10;
+    lexer.default_int_type = 6;
+    lexer.puncts = puncts;
+    lexer.punct_types = punct_types;
+    lexer.default_word_type = 0;
+    lexer.word_lexing_rule = LXL_LEX_WORD;
+    return lexer;
+}
+
+// Return whether lexing up to `end` with an index of the whole source gives the same tokens as without it.
+static bool index_matches(bool json, const char *end) {
+    struct lxl_lexer plain = new_lexer(json, end);
+    struct lxl_lexer indexed = new_lexer(json, source + source_size);
+    struct lxl_region region = REGION_FROM_ARRAY(region_buffer);
+    struct lxl_structural_index index;
+    if (!lxl_structural_index_build(&index, &indexed, &region)) return false;
+    indexed.end = plain.end;
+    for (;;) {
+        struct lxl_token a = lxl_lexer_next_token(&plain);
+        struct lxl_token b = lxl_lexer_next_token(&indexed);
+        if (a.start != b.start || a.end != b.end || a.token_type != b.token_type
+            || a.loc.line != b.loc.line || a.loc.column != b.loc.column) {
+            return false;
+        }
+        if (LXL_TOKEN_IS_END(a)) return true;
+    }
+}
+
+int main(void) {
+    int runs = 0;
+    int matches = 0;
+    for (int json = 0; json < 2; ++json) {
+        const char *const *pieces = json ? json_pieces : comment_pieces;
+        size_t piece_count = json ? sizeof json_pieces / sizeof json_pieces[0]
+                                  : sizeof comment_pieces / sizeof comment_pieces[0];
+        for (int with_nul = 0; with_nul < 2; ++with_nul) {
+            for (int sample = 0; sample < 500; ++sample) {
+                source_size = build_random_source(source, MAX_SOURCE, pieces, piece_count, 80, with_nul);
+                // The whole source, and a lexer ending partway through the indexed input.
+                runs += 2;
+                matches += index_matches(json, source + source_size);
+                matches += index_matches(json, source + next_random() % (source_size + 1));
+            }
+        }
+    }
+    printf("Random samples lexed as without the index: %d (expected: %d)\n", matches, runs);
+
+    // A string of a few blocks is skipped to its closer, and line strings end at a line feed.
+    strcpy(source, "[\"");
+    memset(source + 2, 'a', 200);
+    strcpy(source + 202, "\", \"b\\\"\n\"]");
+    source_size = strlen(source);
+    struct lxl_lexer lexer = lxl_lexer_preset(LXL_LANG_JSON, source, NULL);
+    struct lxl_region region = REGION_FROM_ARRAY(region_buffer);
+    static struct lxl_structural_index index;
+    lxl_structural_index_build(&index, &lexer, &region);
+    lxl_lexer_next_token(&lexer);
+    struct lxl_token token = lxl_lexer_next_token(&lexer);
+    printf("Long string: %d bytes, ending at column %d (expected: 202 bytes, ending at column 203)\n",
+           (int)(token.end - token.start), lexer.pos.column);
+    lxl_lexer_next_token(&lexer);
+    token = lxl_lexer_next_token(&lexer);
+    printf("String cut off by a line feed is unclosed: %d (expected: 1)\n",
+           token.token_type == LXL_LERR_UNCLOSED_STRING);
+    printf("Indexed lexing of a long string matches: %d (expected: 1)\n", index_matches(true, NULL));
+
+    // After the input is modified, a rebuilt index gives the tokens of the new bytes.
+    source[100] = '"';
+    lexer = lxl_lexer_preset(LXL_LANG_JSON, source, NULL);
+    region = REGION_FROM_ARRAY(region_buffer);
+    lxl_structural_index_build(&index, &lexer, &region);
+    lxl_lexer_next_token(&lexer);
+    token = lxl_lexer_next_token(&lexer);
+    printf("String in the modified input: %d bytes (expected: 100 bytes)\n", (int)(token.end - token.start));
+    printf("Indexed lexing of the modified input matches: %d (expected: 1)\n", index_matches(true, NULL));
+
+    // Building fails cleanly in a region which is too small.
+    char small_buffer[16];
+    region = REGION_FROM_ARRAY(small_buffer);
+    lexer = lxl_lexer_preset(LXL_LANG_JSON, source, NULL);
+    printf("Index built in a small region: %d (expected: 0)\n",
+           lxl_structural_index_build(&index, &lexer, &region));
+    printf("Index attached: %d (expected: 0)\n", lexer.structural_index != NULL);
+}
@@ -0,0 +1,263 @@
+#define LEXEL_IMPLEMENTATION
+#include "../lexel.h"
+#include "test_random.h"
+
+#include <stdio.h>
+
+#define MAX_TOKENS 512
+
+struct sample {
+    enum lxl_language language;
+    const char *source;
+};
+
+static const struct sample samples[] = {
+    {LXL_LANG_C, "int main(void) {\n    return x->y[0] + 1.5e3f - 'c' + 0x1Fu; // comment\n}\n"
+                 "/* block */ s = \"a\\\"b\" + 0x + \"unclosed\n t = 1; /* unclosed"},
+    {LXL_LANG_JSON, "{\"a\": [1, -2.5e-3, true, null], \"b\": \"\\u00e9\", \"c\": \"unclosed}"},
+    {LXL_LANG_SQL, "SELECT 'it''s', \"Quoted\nName\" FROM t -- comment\n"
+                   "WHERE x <> 1.5 /* c */ AND 'unclosed"},
+    {LXL_LANG_INI, "[section]\nkey = \"value\" ; comment\n\nn = 0x1F_FF\nx = 0b\ns = \"unclosed\n"},
+    {LXL_LANG_SHELL, "if [ \"$x\" ]; then echo 'a' >> f 2>&1; fi # comment\n\n`cmd"},
+    {LXL_LANG_C, ""},
+};
+
+#define SAMPLE_COUNT (sizeof samples / sizeof samples[0])
+
+// A Python-like language using the offside rule.
+static const char *const puncts[] = {":", "(", ")", NULL};
+static const int punct_types[] = {1, 2, 3};
+static const struct lxl_delim_pair brackets[] = {{"(", ")"}, {NULL, NULL}};
+static int indent_stack[16];
+
+// Blocks are closed and reopened at different widths, so counting the rest of the input from inside a
+// block rewrites the indent stack entries which are live at that point.
+static const char *const offside_source =
+    "a:\n"
+    "    b:\n"
+    "        c\n"
+    "    d:\n"
+    "      e\n"
+    "f:\n"
+    "  g(\n"
+    "1)\n"
+    "  h\n"
+    "i  j\n"
+    "   k\n";
+
+// A language with signed, prefixed, suffixed and separated numbers next to puncts, comments and strings, so
+// that tokens found from their first byte meet those which need the full rules.
+static const char *const random_puncts[] = {"-", "->", "+", "(", ")", ".", NULL};
+static const int random_punct_types[] = {1, 2, 3, 4, 5, 6};
+static const char *const random_comments[] = {"#", NULL};
+static const struct lxl_delim_pair random_strings[] = {{"\"", "\""}, {NULL, NULL}};
+static const int random_string_types[] = {7};
+static const char *const random_signs[] = {"-", NULL};
+static const char *const random_int_prefixes[] = {"0x", NULL};
+static const int random_int_bases[] = {16};
+static const char *const random_int_suffixes[] = {"u", NULL};
+static const char *const random_float_suffixes[] = {"f", NULL};
+
+static const char *const random_pieces[] = {
+    "a", "ab1", "if", "u", "f", "e", "0", "12", "1_0", "1.5", "1e5", "1e", "1.", ".5", "1.5e-3f", "0x1F", "0x",
+    "-", "->", "+", "(", ")", ".", "#c\n", "/", "//c\n", "/*c*/", "/*\n*/", "/*", "\"s\"", "\"", "'c'", "'",
+    " ", "  ", "\n", "\n", "\t", "$",
+};
+#define RANDOM_PIECE_COUNT (sizeof random_pieces / sizeof random_pieces[0])
+#define MAX_SOURCE 1024
+
+static char random_source[MAX_SOURCE];
+
+static struct lxl_token tokens[MAX_TOKENS];
+static char region_buffer[1 << 16];
+
+// Lex the rest of the input into `tokens` (without the end token) and return the number of tokens.
+static size_t lex_all(struct lxl_lexer *lexer) {
+    size_t count = 0;
+    for (;;) {
+        struct lxl_token token = lxl_lexer_next_token(lexer);
+        if (LXL_TOKEN_IS_END(token)) return count;
+        tokens[count++] = token;
+    }
+}
+
+// Return whether the columns hold `tokens[0..count)`.
+static bool columns_match(const struct lxl_token_columns *columns, size_t count) {
+    if (columns->count != count || columns->capacity != count) return false;
+    for (size_t i = 0; i < count; ++i) {
+        if (columns->starts[i] != tokens[i].start || columns->ends[i] != tokens[i].end
+            || columns->token_types[i] != tokens[i].token_type || columns->locs[i].line != tokens[i].loc.line
+            || columns->locs[i].column != tokens[i].loc.column) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static struct lxl_lexer offside_lexer(void) {
+    struct lxl_lexer lexer = lxl_lexer_new(offside_source, NULL);
+    lexer.puncts = puncts;
+    lexer.punct_types = punct_types;
+    lexer.word_lexing_rule = LXL_LEX_WORD;
+    lexer.bracket_delims = brackets;
+    lexer.offside_rule = true;
+    lexer.indent_stack = indent_stack;
+    lexer.indent_capacity = sizeof indent_stack / sizeof indent_stack[0];
+    return lexer;
+}
+
+// Return a lexer for `random_source`: the C preset for variant 0, otherwise the language above, emitting
+// line endings for variant 2.
+static struct lxl_lexer random_lexer(int variant) {
+    if (variant == 0) return lxl_lexer_preset(LXL_LANG_C, random_source, NULL);
+    struct lxl_lexer lexer = lxl_lexer_new(random_source, NULL);
+    lexer.puncts = random_puncts;
+    lexer.punct_types = random_punct_types;
+    lexer.bracket_delims = brackets;
+    lexer.line_comment_openers = random_comments;
+    lexer.line_string_delims = random_strings;
+    lexer.line_string_types = random_string_types;
+    lexer.number_signs = random_signs;
+    lexer.integer_prefixes = random_int_prefixes;
+    lexer.integer_bases = random_int_bases;
+    lexer.integer_suffixes = random_int_suffixes;
+    lexer.float_suffixes = random_float_suffixes;
+    lexer.digit_separators = "_";
+    lexer.default_int_base = 10;
+    lexer.default_int_type = 8;
+    lexer.default_float_base = 10;
+    lexer.default_float_type = 9;
+    lexer.extended_floats = true;
+    lexer.default_word_type = 0;
+    lexer.word_lexing_rule = LXL_LEX_WORD;
+    lexer.emit_line_endings = variant == 2;
+    return lexer;
+}
+
+// Return whether counting and validating `random_source` agree with lexing it, and leave the lexer in the
+// same state.
+static bool random_counts_match(int variant) {
+    struct lxl_lexer lexed = random_lexer(variant);
+    size_t count = 0;
+    size_t trivia_count = 0;
+    size_t error_count = 0;
+    struct lxl_location first_error_loc = {0, 0};
+    for (;;) {
+        struct lxl_token token = lxl_lexer_next_token(&lexed);
+        if (LXL_TOKEN_IS_END(token)) break;
+        ++count;
+        trivia_count += token.token_type == lexed.line_ending_type;
+        if (LXL_TOKEN_IS_ERROR(token) && error_count++ == 0) first_error_loc = token.loc;
+    }
+    struct lxl_lexer counted = random_lexer(variant);
+    size_t counted_trivia;
+    size_t counted_errors;
+    if (lxl_lexer_count_tokens(&counted, &counted_trivia, &counted_errors) != count
+        || counted_trivia != trivia_count || counted_errors != error_count || !lxl_lexer_is_finished(&counted)
+        || counted.pos.line != lexed.pos.line || counted.pos.column != lexed.pos.column
+        || counted.bracket_depth != lexed.bracket_depth) {
+        return false;
+    }
+    struct lxl_lexer validated = random_lexer(variant);
+    struct lxl_validation validation = lxl_lexer_validate(&validated, false);
+    if (validation.error_count != error_count || validation.first_error_loc.line != first_error_loc.line
+        || validation.first_error_loc.column != first_error_loc.column) {
+        return false;
+    }
+    validated = random_lexer(variant);
+    size_t resumed_count = 0;
+    while (lxl_lexer_validate(&validated, true).error_count > 0) ++resumed_count;
+    return resumed_count == error_count;
+}
+
+int main(void) {
+    // Counts, validation and exact tokenizing agree with `lxl_lexer_next_token()`.
+    int count_matches = 0;
+    int validation_matches = 0;
+    int exact_matches = 0;
+    for (size_t i = 0; i < SAMPLE_COUNT; ++i) {
+        struct lxl_lexer lexer = lxl_lexer_preset(samples[i].language, samples[i].source, NULL);
+        size_t count = lex_all(&lexer);
+        size_t trivia_count = 0;
+        size_t error_count = 0;
+        struct lxl_location first_error_loc = {0, 0};
+        for (size_t j = 0; j < count; ++j) {
+            trivia_count += tokens[j].token_type == LXL_TOKEN_LINE_ENDING;
+            if (LXL_TOKEN_IS_ERROR(tokens[j]) && error_count++ == 0) first_error_loc = tokens[j].loc;
+        }
+
+        lexer = lxl_lexer_preset(samples[i].language, samples[i].source, NULL);
+        size_t counted_trivia;
+        size_t counted_errors;
+        if (lxl_lexer_count_tokens(&lexer, &counted_trivia, &counted_errors) == count
+            && counted_trivia == trivia_count && counted_errors == error_count
+            && lxl_lexer_is_finished(&lexer)) {
+            ++count_matches;
+        }
+
+        // Validation finds the same errors at once or one at a time.
+        lexer = lxl_lexer_preset(samples[i].language, samples[i].source, NULL);
+        struct lxl_validation validation = lxl_lexer_validate(&lexer, false);
+        bool valid = validation.error_count == error_count && lxl_lexer_is_finished(&lexer)
+                     && validation.first_error_loc.line == first_error_loc.line
+                     && validation.first_error_loc.column == first_error_loc.column;
+        lexer = lxl_lexer_preset(samples[i].language, samples[i].source, NULL);
+        size_t resumed_count = 0;
+        while (lxl_lexer_validate(&lexer, true).error_count > 0) ++resumed_count;
+        if (valid && resumed_count == error_count) ++validation_matches;
+
+        lexer = lxl_lexer_preset(samples[i].language, samples[i].source, NULL);
+        struct lxl_region region = REGION_FROM_ARRAY(region_buffer);
+        struct lxl_token_columns columns;
+        if (lxl_lexer_tokenize_exact(&lexer, &columns, true, &region) && columns_match(&columns, count)) {
+            ++exact_matches;
+        }
+    }
+    printf("Samples counted as lexed: %d (expected: %d)\n", count_matches, (int)SAMPLE_COUNT);
+    printf("Samples validated as lexed: %d (expected: %d)\n", validation_matches, (int)SAMPLE_COUNT);
+    printf("Samples tokenized exactly as lexed: %d (expected: %d)\n", exact_matches, (int)SAMPLE_COUNT);
+
+    // Tokens found from their first byte are counted as lexed, next to those which need the full rules.
+    int runs = 0;
+    int random_matches = 0;
+    for (int variant = 0; variant < 3; ++variant) {
+        for (int sample = 0; sample < 500; ++sample) {
+            build_random_source(random_source, MAX_SOURCE, random_pieces, RANDOM_PIECE_COUNT, 100, false);
+            ++runs;
+            random_matches += random_counts_match(variant);
+        }
+    }
+    printf("Random samples counted and validated as lexed: %d (expected: %d)\n", random_matches, runs);
+
+    // Tokenizing exactly from inside indented blocks leaves the indent stack intact.
+    struct lxl_lexer lexer = offside_lexer();
+    size_t total_count = lex_all(&lexer);
+    static struct lxl_token reference[MAX_TOKENS];
+    memcpy(reference, tokens, total_count * sizeof *tokens);
+    int mismatches = 0;
+    for (size_t i = 0; i <= total_count; ++i) {
+        lexer = offside_lexer();
+        for (size_t j = 0; j < i; ++j) lxl_lexer_next_token(&lexer);
+        memcpy(tokens, reference + i, (total_count - i) * sizeof *tokens);
+        struct lxl_region region = REGION_FROM_ARRAY(region_buffer);
+        struct lxl_token_columns columns;
+        if (!lxl_lexer_tokenize_exact(&lexer, &columns, true, &region)
+            || !columns_match(&columns, total_count - i)) {
+            ++mismatches;
+        }
+    }
+    printf("Offside suffixes tokenized differently: %d (expected: 0)\n", mismatches);
+    lexer = offside_lexer();
+    printf("Offside tokens counted: %d (expected: 1)\n",
+           lxl_lexer_count_tokens(&lexer, NULL, NULL) == total_count);
+
+    // Tokenizing exactly fails cleanly in a region which is too small.
+    char small_buffer[64];
+    struct lxl_region region = REGION_FROM_ARRAY(small_buffer);
+    lexer = lxl_lexer_preset(samples[0].language, samples[0].source, NULL);
+    struct lxl_token_columns columns;
+    printf("Tokenized in a small region: %d (expected: 0)\n",
+           lxl_lexer_tokenize_exact(&lexer, &columns, true, &region));
+    printf("Bytes allocated: %zu (expected: 0)\n", region.alloc_count);
+    printf("Lexer unchanged: %d (expected: 1)\n", lexer.current == samples[0].source);
+}
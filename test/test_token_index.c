@@ -0,0 +1,79 @@
+#define LEXEL_IMPLEMENTATION
+#include "../lexel.h"
+
+#include <stdio.h>
+
+#define MAX_TOKENS 256
+
+static const char *const source =
+    "int main(void) {\n"
+    "    /* comment */ return x->y[0] + 1.5e3 - 'c';  // comment\n"
+    "    char *s = \"a\\\"b\", *t = \"unclosed\n"
+    "}\n";
+
+static struct lxl_token tokens[MAX_TOKENS];
+static char region_buffer[1 << 16];
+
+// Return the index of the token covering `offset` by linear search, or LXL_NO_TOKEN_INDEX.
+static ptrdiff_t find_linear(size_t count, size_t offset) {
+    for (size_t i = 0; i < count; ++i) {
+        size_t start = tokens[i].start - source;
+        size_t end = tokens[i].end - source;
+        if (start <= offset && offset < end) return (ptrdiff_t)i;
+    }
+    return LXL_NO_TOKEN_INDEX;
+}
+
+int main(void) {
+    struct lxl_lexer lexer = lxl_lexer_preset(LXL_LANG_C, source, NULL);
+    size_t token_count = 0;
+    for (;;) {
+        struct lxl_token token = lxl_lexer_next_token(&lexer);
+        tokens[token_count++] = token;
+        if (LXL_TOKEN_IS_END(token)) break;
+    }
+    size_t source_length = strlen(source);
+
+    // Index every prefix of the token array (so that every tree shape is covered) and look up every offset,
+    // one at a time and in batches.
+    int single_mismatches = 0;
+    int batch_mismatches = 0;
+    size_t offsets[256];
+    ptrdiff_t batch_results[256];
+    for (size_t i = 0; i < source_length + 8; ++i) {
+        offsets[i] = i;
+    }
+    for (size_t count = 0; count <= token_count; ++count) {
+        struct lxl_region region = REGION_FROM_ARRAY(region_buffer);
+        struct lxl_token_index index;
+        if (!lxl_token_index_build(&index, tokens, count, source, &region)) {
+            printf("Could not build an index of %zu tokens.\n", count);
+            return 1;
+        }
+        lxl_token_index_find_batch(&index, offsets, source_length + 8, batch_results);
+        for (size_t offset = 0; offset < source_length + 8; ++offset) {
+            ptrdiff_t expected = find_linear(count, offset);
+            if (lxl_token_index_find(&index, offset) != expected) ++single_mismatches;
+            if (batch_results[offset] != expected) ++batch_mismatches;
+        }
+    }
+    printf("Lookups differing from a linear search: %d (expected: 0)\n", single_mismatches);
+    printf("Batch lookups differing from a linear search: %d (expected: 0)\n", batch_mismatches);
+
+    // Offsets in whitespace and comments lie between tokens.
+    struct lxl_region region = REGION_FROM_ARRAY(region_buffer);
+    struct lxl_token_index index;
+    lxl_token_index_build(&index, tokens, token_count, source, &region);
+    size_t comment_offset = strstr(source, "comment") - source;
+    printf("Token at a comment: %td (expected: %td)\n", lxl_token_index_find(&index, comment_offset),
+           LXL_NO_TOKEN_INDEX);
+    ptrdiff_t found = lxl_token_index_find(&index, strstr(source, "main") - source + 2);
+    printf("Token at 'main': '%.*s' (expected: 'main')\n",
+           (int)(tokens[found].end - tokens[found].start), tokens[found].start);
+
+    // Building fails cleanly in a region which is too small.
+    char small_buffer[16];
+    region = REGION_FROM_ARRAY(small_buffer);
+    printf("Index built in a small region: %d (expected: 0)\n",
+           lxl_token_index_build(&index, tokens, token_count, source, &region));
+}
@@ -0,0 +1,162 @@
+#define LEXEL_IMPLEMENTATION
+#include "../lexel.h"
+
+#include <limits.h>
+#include <stdio.h>
+
+#define MAX_TOKENS 256
+
+enum {
+    T_LINE_ENDING = 1,
+    T_SEMICOLON,
+    T_LBRACE,
+    T_RBRACE,
+    T_EQUALS,
+    T_STRING,
+    T_INT,
+};
+
+static const char *const puncts[] = {";", "{", "}", "=", NULL};
+static const int punct_types[] = {T_SEMICOLON, T_LBRACE, T_RBRACE, T_EQUALS};
+static const struct lxl_delim_pair strings[] = {{"\"", "\""}, {NULL, NULL}};
+static const int string_types[] = {T_STRING};
+
+static const char *const source = "a = 1;\nb = {\n  c = 2 ;\n}\n\"unclosed\nd = 3;\n";
+
+static const struct lxl_token_set statement_ends = LXL_TOKEN_SET(T_SEMICOLON, T_RBRACE);
+static const struct lxl_token_set boundaries = LXL_TOKEN_SET(0, 63, 64, 127, 128, 191, 192, 255);
+static const struct lxl_token_set full = LXL_TOKEN_SET(
+    0, 8, 16, 24, 32, 40, 48, 56, 64, 72, 80, 88, 96, 104, 112, 120,
+    128, 136, 144, 152, 160, 168, 176, 184, 192, 200, 208, 216, 224, 232, 240, 248);
+
+static struct lxl_token tokens[MAX_TOKENS];
+
+static struct lxl_lexer new_lexer(void) {
+    struct lxl_lexer lexer = lxl_lexer_new(source, NULL);
+    lexer.puncts = puncts;
+    lexer.punct_types = punct_types;
+    lexer.default_int_base = 10;
+    lexer.default_int_type = T_INT;
+    lexer.line_string_delims = strings;
+    lexer.line_string_types = string_types;
+    lexer.default_word_type = 0;
+    lexer.emit_line_endings = true;
+    return lexer;
+}
+
+// Return the number of types from -300 to 299 which are members of the set.
+static int count_members(const struct lxl_token_set *set) {
+    int count = 0;
+    for (int t = -300; t < 300; ++t) count += lxl_token_set_contains(set, t);
+    return count;
+}
+
+// Lex the rest of the input into `tokens` (without the end token) and return the number of tokens.
+static size_t lex_all(struct lxl_lexer *lexer) {
+    size_t count = 0;
+    for (;;) {
+        struct lxl_token token = lxl_lexer_next_token(lexer);
+        if (LXL_TOKEN_IS_END(token)) return count;
+        tokens[count++] = token;
+    }
+}
+
+int main(void) {
+    // Membership of statically initialised sets.
+    printf("Members of statement_ends: %d (expected: 2)\n", count_members(&statement_ends));
+    printf("Semicolon is a member: %d (expected: 1)\n", lxl_token_set_contains(&statement_ends, T_SEMICOLON));
+    printf("Equals is a member: %d (expected: 0)\n", lxl_token_set_contains(&statement_ends, T_EQUALS));
+    int boundary_members = 0;
+    static const int boundary_types[] = {0, 63, 64, 127, 128, 191, 192, 255};
+    for (int i = 0; i < 8; ++i) boundary_members += lxl_token_set_contains(&boundaries, boundary_types[i]);
+    printf("Word boundary types which are members: %d (expected: 8)\n", boundary_members);
+    printf("Members of the boundary set: %d (expected: 8)\n", count_members(&boundaries));
+    printf("Members of a set of 32 types: %d (expected: 32)\n", count_members(&full));
+
+    // Out-of-range types are never members, and adding or removing them leaves the set unchanged.
+    static const int out_of_range[] = {
+        -1, LXL_TOKEN_UNINIT, LXL_TOKENS_END, LXL_TOKEN_LINE_ENDING, LXL_TOKEN_INDENT, LXL_TOKEN_DEDENT,
+        LXL_LERR_UNCLOSED_STRING, LXL_TOKEN_SET_SIZE, LXL_TOKEN_SET_SIZE + 1, 64 * 5, INT_MAX, INT_MIN,
+    };
+    size_t out_of_range_count = sizeof out_of_range / sizeof out_of_range[0];
+    struct lxl_token_set set = LXL_TOKEN_SET_EMPTY;
+    struct lxl_token_set all = LXL_TOKEN_SET_EMPTY;
+    for (int t = 0; t < LXL_TOKEN_SET_SIZE; ++t) lxl_token_set_add(&all, t);
+    struct lxl_token_set all_before = all;
+    int out_of_range_members = 0;
+    for (size_t i = 0; i < out_of_range_count; ++i) {
+        lxl_token_set_add(&set, out_of_range[i]);
+        lxl_token_set_remove(&all, out_of_range[i]);
+        out_of_range_members += lxl_token_set_contains(&all, out_of_range[i]);
+    }
+    printf("Out-of-range types which are members of the full set: %d (expected: 0)\n", out_of_range_members);
+    printf("Empty set unchanged by adding out-of-range types: %d (expected: 1)\n",
+           lxl_token_set_is_empty(&set));
+    printf("Full set unchanged by removing out-of-range types: %d (expected: 1)\n",
+           memcmp(&all, &all_before, sizeof all) == 0);
+    printf("Members of the full set: %d (expected: %d)\n", count_members(&all), LXL_TOKEN_SET_SIZE);
+
+    // Adding and removing agree with the static initialiser, and the set operations with membership.
+    for (int i = 0; i < 8; ++i) lxl_token_set_add(&set, boundary_types[i]);
+    printf("Added set equals the initialised set: %d (expected: 1)\n",
+           memcmp(&set, &boundaries, sizeof set) == 0);
+    lxl_token_set_remove(&set, 64);
+    printf("64 is a member after removing it: %d (expected: 0)\n", lxl_token_set_contains(&set, 64));
+    printf("63 is a member after removing 64: %d (expected: 1)\n", lxl_token_set_contains(&set, 63));
+    struct lxl_token_set both = lxl_token_set_intersection(boundaries, full);
+    printf("Members of the intersection: %d (expected: 4)\n", count_members(&both));
+    struct lxl_token_set either = lxl_token_set_union(boundaries, full);
+    printf("Members of the union: %d (expected: 36)\n", count_members(&either));
+    struct lxl_token_set only = lxl_token_set_difference(boundaries, full);
+    printf("Members of the difference: %d (expected: 4)\n", count_members(&only));
+    struct lxl_token_set none = lxl_token_set_difference(full, full);
+    printf("Difference with itself is empty: %d (expected: 1)\n", lxl_token_set_is_empty(&none));
+
+    // Filtering line endings needs a non-negative line ending type.
+    struct lxl_lexer lexer = new_lexer();
+    size_t count = lex_all(&lexer);
+    size_t line_endings = 0;
+    for (size_t i = 0; i < count; ++i) line_endings += tokens[i].token_type == LXL_TOKEN_LINE_ENDING;
+    static const struct lxl_token_set special = LXL_TOKEN_SET(LXL_TOKEN_LINE_ENDING);
+    printf("Members of a set of a special type: %d (expected: 0)\n", count_members(&special));
+    lexer = new_lexer();
+    size_t unfiltered_count = 0;
+    for (;;) {
+        struct lxl_token token = lxl_lexer_next_token_not_in(&lexer, &special);
+        if (LXL_TOKEN_IS_END(token)) break;
+        ++unfiltered_count;
+    }
+    printf("Tokens kept when filtering a special type: %d (expected: 1)\n", unfiltered_count == count);
+
+    lexer = new_lexer();
+    lexer.line_ending_type = T_LINE_ENDING;
+    static const struct lxl_token_set line_ending = LXL_TOKEN_SET(T_LINE_ENDING);
+    size_t filtered_count = 0;
+    int mismatches = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (tokens[i].token_type == LXL_TOKEN_LINE_ENDING) continue;
+        struct lxl_token token = lxl_lexer_next_token_not_in(&lexer, &line_ending);
+        mismatches += token.start != tokens[i].start || token.token_type != tokens[i].token_type;
+        ++filtered_count;
+    }
+    printf("Filtered tokens differing from lexed ones: %d (expected: 0)\n", mismatches);
+    printf("Tokens returned: %zu (expected: %zu)\n", filtered_count, count - line_endings);
+    printf("Line endings filtered: %zu (expected: 5)\n", line_endings);
+    struct lxl_token token = lxl_lexer_next_token_not_in(&lexer, &line_ending);
+    printf("End token returned: %d (expected: 1)\n", LXL_TOKEN_IS_END(token));
+
+    // Syncing skips to the next statement end, including past errors.
+    lexer = new_lexer();
+    size_t skipped_count;
+    token = lxl_lexer_sync_to(&lexer, &statement_ends, &skipped_count);
+    printf("First statement end: %d after %zu tokens (expected: %d after 3 tokens)\n",
+           token.token_type, skipped_count, T_SEMICOLON);
+    lxl_lexer_sync_to(&lexer, &statement_ends, NULL);
+    lxl_lexer_sync_to(&lexer, &statement_ends, NULL);
+    token = lxl_lexer_sync_to(&lexer, &statement_ends, &skipped_count);
+    printf("Statement end after the unclosed string: %d after %zu tokens (expected: %d after 5 tokens)\n",
+           token.token_type, skipped_count, T_SEMICOLON);
+    token = lxl_lexer_sync_to(&lexer, &statement_ends, &skipped_count);
+    printf("End token returned: %d (expected: 1)\n", LXL_TOKEN_IS_END(token));
+    printf("Tokens skipped before the end: %zu (expected: 1)\n", skipped_count);
+}
@@ -0,0 +1,121 @@
+#define LEXEL_IMPLEMENTATION
+#include "../lexel.h"
+
+#include <stdio.h>
+
+struct sample {
+    enum lxl_language language;
+    const char *source;
+};
+
+static const struct sample samples[] = {
+    {LXL_LANG_C, "int main(void) { return x->y[0] + 1.5e3 - 'c'; } // comment\n"
+                 "/* block */ s = \"a\\\"b\";\n"},
+    {LXL_LANG_C, "unclosed = \"string\n x = 'c"},
+    {LXL_LANG_C, "/* unclosed comment"},
+    {LXL_LANG_C, ""},
+    {LXL_LANG_JSON, "{\"a\": [1, -2.5e-3, true, null], \"b\": {}}"},
+    {LXL_LANG_INI, "[section]\nkey = \"value\" ; comment\nn = 0x1F\n\n"},
+};
+
+#define SAMPLE_COUNT (sizeof samples / sizeof samples[0])
+
+static char buffer[1 << 14];
+
+// Return whether a token read from a stream matches the token lexed.
+static bool same_token(struct lxl_token read, struct lxl_token lexed, bool with_locations) {
+    if (read.start != lexed.start || read.end != lexed.end || read.token_type != lexed.token_type) {
+        return false;
+    }
+    if (with_locations) return read.loc.line == lexed.loc.line && read.loc.column == lexed.loc.column;
+    return read.loc.line == -1 && read.loc.column == -1;
+}
+
+// Write the sample's tokens to a stream in `buffer` and return the size of the stream.
+static size_t write_sample(const struct sample *sample, unsigned flags) {
+    struct lxl_string_view source = lxl_sv_from_string(sample->source);
+    struct lxl_token_stream_writer writer = lxl_token_stream_writer_new(buffer, sizeof buffer, source, flags);
+    struct lxl_lexer lexer = lxl_lexer_preset(sample->language, sample->source, NULL);
+    lxl_token_stream_write_lexer(&writer, &lexer);
+    return lxl_token_stream_finish(&writer);
+}
+
+// Return whether the stream in `buffer` holds exactly the tokens lexed from the sample.
+static bool stream_matches(const struct sample *sample, size_t size, unsigned flags) {
+    struct lxl_string_view source = lxl_sv_from_string(sample->source);
+    struct lxl_token_stream_reader reader;
+    if (!lxl_token_stream_reader_init(&reader, buffer, size, source)) return false;
+    struct lxl_lexer lexer = lxl_lexer_preset(sample->language, sample->source, NULL);
+    for (;;) {
+        struct lxl_token lexed = lxl_lexer_next_token(&lexer);
+        if (!same_token(lxl_token_stream_reader_next_token(&reader), lexed, flags & LXL_TSF_LOCATIONS)) {
+            return false;
+        }
+        if (LXL_TOKEN_IS_END(lexed)) break;
+    }
+    return lxl_token_stream_reader_is_finished(&reader);
+}
+
+int main(void) {
+    int matches = 0;
+    for (size_t i = 0; i < SAMPLE_COUNT; ++i) {
+        for (unsigned flags = LXL_TSF_NONE; flags <= LXL_TSF_LOCATIONS; ++flags) {
+            size_t size = write_sample(&samples[i], flags);
+            if (size > 0 && stream_matches(&samples[i], size, flags)) ++matches;
+        }
+    }
+    printf("Streams matching the lexer: %d (expected: %d)\n", matches, 2 * (int)SAMPLE_COUNT);
+
+    // Corrupt or stale streams are rejected.
+    const struct sample *sample = &samples[0];
+    struct lxl_string_view source = lxl_sv_from_string(sample->source);
+    struct lxl_token_stream_reader reader;
+    size_t size = write_sample(sample, LXL_TSF_LOCATIONS);
+    printf("Valid stream accepted: %d (expected: 1)\n",
+           lxl_token_stream_reader_init(&reader, buffer, size, source));
+    printf("Truncated stream accepted: %d (expected: 0)\n",
+           lxl_token_stream_reader_init(&reader, buffer, size - 1, source));
+    struct lxl_string_view shorter = {source.start, source.length - 1};
+    printf("Stream for another source accepted: %d (expected: 0)\n",
+           lxl_token_stream_reader_init(&reader, buffer, size, shorter));
+
+    struct lxl_token_stream_header header;
+    memcpy(&header, buffer, sizeof header);
+    header.flags |= 1 << 7;
+    memcpy(buffer, &header, sizeof header);
+    printf("Unknown flags accepted: %d (expected: 0)\n",
+           lxl_token_stream_reader_init(&reader, buffer, size, source));
+
+    // Make the value of the last record run past the end of the source.
+    size = write_sample(sample, LXL_TSF_LOCATIONS);
+    size_t record_size = lxl_token_stream_record_size(LXL_TSF_LOCATIONS);
+    uint32_t offset = (uint32_t)source.length;
+    uint32_t length = 1;
+    memcpy(&buffer[size - record_size + 4], &offset, sizeof offset);
+    memcpy(&buffer[size - record_size + 8], &length, sizeof length);
+    printf("Out-of-bounds record accepted: %d (expected: 0)\n",
+           lxl_token_stream_reader_init(&reader, buffer, size, source));
+
+    // A full stream leaves the lexer after the last token written, so writing can continue elsewhere.
+    struct lxl_lexer lexer = lxl_lexer_preset(sample->language, sample->source, NULL);
+    size_t small_capacity = sizeof(struct lxl_token_stream_header) + 5 * record_size + 3;
+    struct lxl_token_stream_writer small = lxl_token_stream_writer_new(buffer, small_capacity, source,
+                                                                       LXL_TSF_LOCATIONS);
+    size_t first_count = lxl_token_stream_write_lexer(&small, &lexer);
+    printf("Tokens written to a full stream: %zu (expected: 5)\n", first_count);
+    printf("Full stream size: %zu (expected: 0)\n", lxl_token_stream_finish(&small));
+    struct lxl_token_stream_writer rest = lxl_token_stream_writer_new(buffer, sizeof buffer, source,
+                                                                      LXL_TSF_LOCATIONS);
+    size_t rest_count = lxl_token_stream_write_lexer(&rest, &lexer);
+    size = lxl_token_stream_finish(&rest);
+    struct lxl_lexer check = lxl_lexer_preset(sample->language, sample->source, NULL);
+    for (size_t i = 0; i < first_count; ++i) {
+        lxl_lexer_next_token(&check);
+    }
+    bool rest_matches = lxl_token_stream_reader_init(&reader, buffer, size, source);
+    for (size_t i = 0; rest_matches && i < rest_count; ++i) {
+        struct lxl_token read = lxl_token_stream_reader_next_token(&reader);
+        rest_matches = same_token(read, lxl_lexer_next_token(&check), true);
+    }
+    printf("Remaining tokens written after a full stream: %d (expected: 1)\n", rest_matches);
+}
@@ -0,0 +1,61 @@
+#include "../lexel.hpp"
+
+#include <stdio.h>
+
+#include <ranges>
+
+static_assert(std::ranges::input_range<lxl::token_view>);
+static_assert(std::ranges::view<lxl::token_view>);
+
+enum { T_INT, T_WORD, T_PLUS };
+
+static const char *const puncts[] = {"+", NULL};
+static const int punct_types[] = {T_PLUS};
+
+static struct lxl_lexer make_lexer(const char *source) {
+    struct lxl_lexer lexer = lxl_lexer_new(source, NULL);
+    lexer.default_int_base = 10;
+    lexer.default_int_type = T_INT;
+    lexer.default_word_type = T_WORD;
+    lexer.word_lexing_rule = LXL_LEX_WORD;
+    lexer.puncts = puncts;
+    lexer.punct_types = punct_types;
+    return lexer;
+}
+
+int main(void) {
+    // 100 copies of "1 + x " gives 300 tokens, which spans several batches.
+    static char source[601];
+    for (int i = 0; i < 100; ++i) {
+        memcpy(&source[6*i], "1 + x ", 6);
+    }
+
+    struct lxl_lexer lexer = make_lexer(source);
+    int token_count = 0;
+    for (const lxl_token &token : lxl::token_view(lexer)) {
+        (void)token;
+        ++token_count;
+    }
+    printf("Token count: %d (expected: 300)\n", token_count);
+
+    lexer = make_lexer(source);
+    auto lengths = lxl::token_view(lexer)
+        | std::views::filter([](const lxl_token &token) { return token.token_type != T_PLUS; })
+        | std::views::transform([](const lxl_token &token) { return token.end - token.start; });
+    long total_length = 0;
+    for (long length : lengths) {
+        total_length += length;
+    }
+    printf("Total length of non-punct tokens: %ld (expected: 200)\n", total_length);
+
+    static char buffer[65536];
+    struct lxl_region region = {sizeof buffer, 0, buffer};
+    lxl::region_resource resource(region);
+    lexer = make_lexer(source);
+    std::pmr::vector<lxl_token> tokens = lxl::collect_tokens(lexer, &resource);
+    printf("Collected: %zu (expected: 300)\n", tokens.size());
+    printf("Allocated from region: %d (expected: 1)\n",
+           (const char *)tokens.data() >= buffer && (const char *)tokens.data() < buffer + sizeof buffer);
+    printf("Last token: '%.*s' (expected: 'x')\n",
+           (int)(tokens.back().end - tokens.back().start), tokens.back().start);
+}